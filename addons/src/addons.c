@@ -101,12 +101,15 @@ static AddonsInfo *ao_info = NULL;
 static void ao_update_editor_menu_cb(GObject *obj, const gchar *word, gint pos,
 									 GeanyDocument *doc, gpointer data);
 static void ao_document_activate_cb(GObject *obj, GeanyDocument *doc, gpointer data);
+static void ao_document_new_cb(GObject *obj, GeanyDocument *doc, gpointer data);
 static void ao_document_open_cb(GObject *obj, GeanyDocument *doc, gpointer data);
 static void ao_document_save_cb(GObject *obj, GeanyDocument *doc, gpointer data);
 static void ao_document_before_save_cb(GObject *obj, GeanyDocument *doc, gpointer data);
 static void ao_document_close_cb(GObject *obj, GeanyDocument *doc, gpointer data);
 static void ao_document_reload_cb(GObject *obj, GeanyDocument *doc, gpointer data);
 static void ao_startup_complete_cb(GObject *obj, gpointer data);
+static void ao_project_open_cb(GObject *obj, GKeyFile *config, gpointer data);
+static void ao_project_close_cb(GObject *obj, gpointer data);
 
 gboolean ao_editor_notify_cb(GObject *object, GeanyEditor *editor,
 	SCNotification *nt, gpointer data);
@@ -117,6 +120,7 @@ PluginCallback plugin_callbacks[] =
 	{ "update-editor-menu", (GCallback) &ao_update_editor_menu_cb, FALSE, NULL },
 	{ "editor-notify", (GCallback) &ao_editor_notify_cb, TRUE, NULL },
 
+	{ "document-new", (GCallback) &ao_document_new_cb, TRUE, NULL },
 	{ "document-open", (GCallback) &ao_document_open_cb, TRUE, NULL },
 	{ "document-save", (GCallback) &ao_document_save_cb, TRUE, NULL },
 	{ "document-close", (GCallback) &ao_document_close_cb, TRUE, NULL },
@@ -126,6 +130,10 @@ PluginCallback plugin_callbacks[] =
 
 	{ "geany-startup-complete", (GCallback) &ao_startup_complete_cb, TRUE, NULL },
 
+	{ "project-open", (GCallback) &ao_project_open_cb, TRUE, NULL },
+	{ "project-save", (GCallback) &ao_project_open_cb, TRUE, NULL },
+	{ "project-close", (GCallback) &ao_project_close_cb, TRUE, NULL },
+
 	{ NULL, NULL, FALSE, NULL }
 };
 
@@ -189,10 +197,19 @@ static void ao_document_activate_cb(GObject *obj, GeanyDocument *doc, gpointer d
 }
 
 
+static void ao_document_new_cb(GObject *obj, GeanyDocument *doc, gpointer data)
+{
+	g_return_if_fail(doc != NULL && doc->is_valid);
+
+	ao_doc_list_update_document(ao_info->doclist, doc);
+}
+
+
 static void ao_document_open_cb(GObject *obj, GeanyDocument *doc, gpointer data)
 {
 	g_return_if_fail(doc != NULL && doc->is_valid);
 
+	ao_doc_list_update_document(ao_info->doclist, doc);
 	ao_tasks_update(ao_info->tasks, doc);
 }
 
@@ -201,6 +218,8 @@ static void ao_document_close_cb(GObject *obj, GeanyDocument *doc, gpointer data
 {
 	g_return_if_fail(doc != NULL && doc->is_valid);
 
+	ao_bookmark_list_remove(ao_info->bookmarklist, doc);
+	ao_doc_list_remove_document(ao_info->doclist, doc);
 	ao_tasks_remove(ao_info->tasks, doc);
 }
 
@@ -209,6 +228,8 @@ static void ao_document_save_cb(GObject *obj, GeanyDocument *doc, gpointer data)
 {
 	g_return_if_fail(doc != NULL && doc->is_valid);
 
+	/* the file name may have changed by "Save As" */
+	ao_doc_list_update_document(ao_info->doclist, doc);
 	ao_tasks_update(ao_info->tasks, doc);
 }
 
@@ -221,6 +242,19 @@ static void ao_document_before_save_cb(GObject *obj, GeanyDocument *doc, gpointe
 }
 
 
+/* "project-save" also passes the project file with the current settings */
+static void ao_project_open_cb(GObject *obj, GKeyFile *config, gpointer data)
+{
+	ao_blanklines_on_project_open(obj, config, data);
+}
+
+
+static void ao_project_close_cb(GObject *obj, gpointer data)
+{
+	ao_blanklines_on_project_close(obj, data);
+}
+
+
 static void ao_document_reload_cb(GObject *obj, GeanyDocument *doc, gpointer data)
 {
 	g_return_if_fail(doc != NULL && doc->is_valid);
@@ -289,6 +323,16 @@ void plugin_init(GeanyData *data)
 						ao_info->tasks_token_list, ao_info->tasks_scan_all_documents);
 
 	ao_blanklines_set_enable(ao_info->strip_trailing_blank_lines);
+	/* a project may already be open when the plugin is loaded */
+	if (geany_data->app->project != NULL)
+	{
+		GKeyFile *project_config = g_key_file_new();
+
+		if (g_key_file_load_from_file(project_config, geany_data->app->project->file_name,
+				G_KEY_FILE_NONE, NULL))
+			ao_blanklines_on_project_open(NULL, project_config, NULL);
+		g_key_file_free(project_config);
+	}
 
 	/* setup keybindings */
 	key_group = plugin_set_key_group(geany_plugin, "addons", KB_COUNT+8, NULL);
@@ -26,65 +26,149 @@
 
 static gboolean enabled = FALSE;
 
-static void editor_strip_trailing_newlines(GeanyEditor *editor)
+/* an open project overrides the file preferences of the global ones */
+static gboolean project_open = FALSE;
+static gboolean project_strip_trailing_spaces;
+static gboolean project_final_new_line;
+
+typedef struct
 {
-	const gint maxline = sci_get_line_count(editor->sci) - 1;
-	const gint maxpos = sci_get_line_end_position(editor->sci, maxline);
+	gint start;
+	gint end;
+} BlankRange;
 
-	gint line, start, end, pos = 0;
-	gchar ch;
 
-	/*
-	 * Store index of the last non-empty line in `line' and position of the first
-	 * of its trailing spaces in `pos'. If all lines are empty, `line' will
-	 * contain -1, and `pos' will be undefined. If `line' does not contain
-	 * trailing spaces, `pos' will be its end position.
-	 */
-	for (line = maxline; line >= 0; line--)
+/*
+ * Scans the text once and collects the ranges to be removed in ascending order:
+ * trailing spaces of each line if `strip_spaces' is set, and the trailing blank
+ * lines (including trailing spaces of the last non-empty line unless one newline
+ * is to be kept after it).
+ */
+static GArray *collect_blank_ranges(const gchar *text, gint len, gboolean strip_spaces,
+									gboolean final_new_line)
+{
+	GArray *ranges = g_array_new(FALSE, FALSE, sizeof(BlankRange));
+	BlankRange range;
+	gint pos, ws_start = 0, content_end = -1;
+
+	for (pos = 0; pos < len; pos++)
 	{
-		start = sci_get_position_from_line(editor->sci, line);
-		end = sci_get_line_end_position(editor->sci, line);
-
-		/*
-		 * We can't be sure that `geany_data->file_prefs->strip_trailing_spaces'
-		 * setting is set, so we should check for trailing spaces manually.
-		 * Performance overhead of the for loop below is very small anyway,
-		 * so it does not worth checking the setting manually and writing
-		 * additional code.
-		 */
-
-		for (pos = end-1; pos >= start; pos--)
+		gchar ch = text[pos];
+
+		if (ch == '\r' || ch == '\n')
 		{
-			ch = sci_get_char_at(editor->sci, pos);
-			if (ch != ' ' && ch != '\t')
-				break;
+			if (strip_spaces && ws_start < pos)
+			{
+				range.start = ws_start;
+				range.end = pos;
+				g_array_append_val(ranges, range);
+			}
+			if (ch == '\r' && pos + 1 < len && text[pos + 1] == '\n')
+				pos++;
+			ws_start = pos + 1;
+		}
+		else if (ch != ' ' && ch != '\t')
+		{
+			ws_start = pos + 1;
+			content_end = pos + 1;
 		}
-		++pos;
-		if (pos > start)
-			break;
 	}
 
-	if (line == -1 || geany_data->file_prefs->final_new_line)
+	/* ranges after the last non-empty line are covered by the tail removal below */
+	while (ranges->len > 0 && g_array_index(ranges, BlankRange, ranges->len - 1).start >= content_end)
+		g_array_set_size(ranges, ranges->len - 1);
+
+	if (content_end == -1)
+		pos = 0;
+	else if (final_new_line)
 	{
 		/* leave one newline */
-		line++;
-		pos = sci_get_position_from_line(editor->sci, line);
+		pos = content_end;
+		while (pos < len && (text[pos] == ' ' || text[pos] == '\t'))
+			pos++;
+		if (strip_spaces && pos > content_end)
+		{
+			range.start = content_end;
+			range.end = pos;
+			g_array_append_val(ranges, range);
+		}
+		if (pos < len && text[pos] == '\r')
+			pos++;
+		if (pos < len && text[pos] == '\n')
+			pos++;
 	}
+	else
+		pos = content_end;
 
-	if (pos < maxpos)
+	if (pos < len)
 	{
 		/* there are some lines to be removed */
-		sci_set_target_start(editor->sci, pos);
-		sci_set_target_end(editor->sci, maxpos);
-		sci_replace_target(editor->sci, "", FALSE);
+		range.start = pos;
+		range.end = len;
+		g_array_append_val(ranges, range);
 	}
+	return ranges;
 }
 
+
+static void editor_strip_trailing_newlines(GeanyEditor *editor)
+{
+	ScintillaObject *sci = editor->sci;
+	const gchar *text = (const gchar *) scintilla_send_message(sci, SCI_GETCHARACTERPOINTER, 0, 0);
+	GArray *ranges;
+	gint i;
+
+	/*
+	 * If Geany is going to strip trailing spaces after us, do it in the same pass
+	 * so that the whole cleanup is a single undo action and Geany's own pass
+	 * finds nothing left to change.
+	 */
+	if (project_open)
+		ranges = collect_blank_ranges(text, sci_get_length(sci),
+			project_strip_trailing_spaces, project_final_new_line);
+	else
+		ranges = collect_blank_ranges(text, sci_get_length(sci),
+			geany_data->file_prefs->strip_trailing_spaces, geany_data->file_prefs->final_new_line);
+
+	if (ranges->len > 0)
+	{
+		/* apply from the end, so that earlier positions stay valid */
+		sci_start_undo_action(sci);
+		for (i = ranges->len - 1; i >= 0; i--)
+		{
+			BlankRange *range = &g_array_index(ranges, BlankRange, i);
+
+			sci_set_target_start(sci, range->start);
+			sci_set_target_end(sci, range->end);
+			sci_replace_target(sci, "", FALSE);
+		}
+		sci_end_undo_action(sci);
+	}
+	g_array_free(ranges, TRUE);
+}
+
+
 void ao_blanklines_set_enable(gboolean enabled_)
 {
 	enabled = enabled_;
 }
 
+/* Geany keeps the project's file preferences in the "file_prefs" group of the
+ * project file, the global ones are the defaults */
+void ao_blanklines_on_project_open(GObject *object, GKeyFile *config, gpointer data)
+{
+	project_open = TRUE;
+	project_strip_trailing_spaces = utils_get_setting_boolean(config, "file_prefs",
+		"strip_trailing_spaces", geany_data->file_prefs->strip_trailing_spaces);
+	project_final_new_line = utils_get_setting_boolean(config, "file_prefs",
+		"final_new_line", geany_data->file_prefs->final_new_line);
+}
+
+void ao_blanklines_on_project_close(GObject *object, gpointer data)
+{
+	project_open = FALSE;
+}
+
 void ao_blanklines_on_document_before_save(GObject *object, GeanyDocument *doc, gpointer data)
 {
 	if (enabled)
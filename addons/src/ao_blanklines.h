@@ -25,6 +25,10 @@
 
 void ao_blanklines_set_enable(gboolean enabled_);
 
+void ao_blanklines_on_project_open(GObject *object, GKeyFile *config, gpointer data);
+
+void ao_blanklines_on_project_close(GObject *object, gpointer data);
+
 void ao_blanklines_on_document_before_save(GObject *object, GeanyDocument *doc, gpointer data);
 
 #endif
@@ -59,9 +59,15 @@ struct _AoBookmarkListPrivate
 
 	GtkListStore *store;
 	GtkWidget *tree;
+	GtkTreeViewColumn *number_column;
+	gint number_digits;
 
-	gint		 search_line;
-	GtkTreeIter	*search_iter;
+	/* sorted bookmarked line numbers per document (GeanyDocument* -> GArray of gint) */
+	GHashTable *docs;
+
+	/* the displayed document and its lines, the n-th row of the store shows the n-th line */
+	GeanyDocument *doc;
+	GArray *lines;
 };
 
 enum
@@ -70,11 +76,10 @@ enum
 	PROP_ENABLE_BOOKMARKLIST
 };
 
+/* rows carry no data, line numbers and contents are looked up when a row is drawn */
 enum
 {
-	BMLIST_COL_LINE,
-	BMLIST_COL_NAME,
-	BMLIST_COL_TOOLTIP,
+	BMLIST_COL_UNUSED,
 	BMLIST_COL_MAX
 };
 
@@ -141,73 +146,321 @@ static void ao_bookmark_list_finalize(GObject *object)
 }
 
 
-static gboolean tree_model_foreach(GtkTreeModel *model, GtkTreePath *path,
-								   GtkTreeIter *iter, gpointer data)
+static void lines_free(gpointer data)
 {
-	gint x;
-	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(data);
+	g_array_free(data, TRUE);
+}
 
-	gtk_tree_model_get(model, iter, BMLIST_COL_LINE, &x, -1);
-	if (x == priv->search_line)
+
+/* Binary search in the sorted lines array. Returns TRUE if line_nr is bookmarked,
+ * pos is set to its index or to the index it would be inserted at. */
+static gboolean find_line(GArray *lines, gint line_nr, guint *pos)
+{
+	guint lo = 0, hi = lines->len;
+
+	while (lo < hi)
 	{
-		priv->search_iter = gtk_tree_iter_copy(iter);
-		return TRUE;
+		guint mid = (lo + hi) / 2;
+		gint x = g_array_index(lines, gint, mid);
+
+		if (x < line_nr)
+			lo = mid + 1;
+		else if (x > line_nr)
+			hi = mid;
+		else
+		{
+			*pos = mid;
+			return TRUE;
+		}
 	}
+	*pos = lo;
 	return FALSE;
 }
 
 
-static void delete_line(AoBookmarkList *bm, gint line_nr)
+static void read_lines(GArray *lines, ScintillaObject *sci)
 {
-	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(bm);
+	gint line_nr = 0;
+	gint mask = 1 << 1;
 
-	priv->search_line = line_nr + 1;
-	priv->search_iter = NULL;
-	gtk_tree_model_foreach(GTK_TREE_MODEL(priv->store), tree_model_foreach, bm);
-	if (priv->search_iter != NULL)
+	g_array_set_size(lines, 0);
+	while ((line_nr = scintilla_send_message(sci, SCI_MARKERNEXT, line_nr, mask)) != -1)
 	{
-		gtk_list_store_remove(priv->store, priv->search_iter);
-		gtk_tree_iter_free(priv->search_iter);
+		g_array_append_val(lines, line_nr);
+		line_nr++;
 	}
 }
 
 
-static void add_line(AoBookmarkList *bm, ScintillaObject *sci, gint line_nr)
+static GArray *get_lines(AoBookmarkListPrivate *priv, GeanyDocument *doc)
 {
-	gchar *line, *tooltip;
-	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(bm);
+	GArray *lines = g_hash_table_lookup(priv->docs, doc);
+
+	if (lines == NULL)
+	{
+		lines = g_array_new(FALSE, FALSE, sizeof(gint));
+		read_lines(lines, doc->editor->sci);
+		g_hash_table_insert(priv->docs, doc, lines);
+	}
+	return lines;
+}
+
+
+static gint get_row_line(AoBookmarkListPrivate *priv, GtkTreeModel *model, GtkTreeIter *iter)
+{
+	GtkTreePath *path = gtk_tree_model_get_path(model, iter);
+	gint idx = gtk_tree_path_get_indices(path)[0];
+
+	gtk_tree_path_free(path);
+	if (priv->lines == NULL || idx < 0 || (guint) idx >= priv->lines->len)
+		return -1;
+	return g_array_index(priv->lines, gint, idx);
+}
+
+
+static gchar *get_line_text(AoBookmarkListPrivate *priv, gint line_nr)
+{
+	gchar *line = g_strstrip(sci_get_line(priv->doc->editor->sci, line_nr));
 
-	line = g_strstrip(sci_get_line(sci, line_nr));
 	if (EMPTY(line))
+	{
+		g_free(line);
 		line = g_strdup(_("(Empty Line)"));
-	tooltip = g_markup_escape_text(line, -1);
+	}
+	return line;
+}
+
+
+static void update_number_column_width(AoBookmarkListPrivate *priv)
+{
+	gint digits = 1;
+	gint count = (priv->doc != NULL) ? sci_get_line_count(priv->doc->editor->sci) : 1;
+
+	while (count >= 10)
+	{
+		count /= 10;
+		digits++;
+	}
+	if (digits != priv->number_digits)
+	{
+		gchar *text = g_strnfill(MAX(digits, 3), '0');
+		PangoLayout *layout = gtk_widget_create_pango_layout(priv->tree, text);
+		gint width;
 
-	gtk_list_store_insert_with_values(priv->store, NULL, -1,
-		BMLIST_COL_LINE, line_nr + 1,
-		BMLIST_COL_NAME, line,
-		BMLIST_COL_TOOLTIP, tooltip,
-		-1);
+		pango_layout_get_pixel_size(layout, &width, NULL);
+		gtk_tree_view_column_set_fixed_width(priv->number_column, width + 12);
+		priv->number_digits = digits;
+
+		g_object_unref(layout);
+		g_free(text);
+	}
+}
+
+
+/* make the store have one row per line of the displayed document */
+static void sync_rows(AoBookmarkListPrivate *priv)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL(priv->store);
+	GtkTreeIter iter;
+	gint len = (priv->lines != NULL) ? (gint) priv->lines->len : 0;
+	gint rows = gtk_tree_model_iter_n_children(model, NULL);
+
+	for (; rows < len; rows++)
+		gtk_list_store_append(priv->store, &iter);
+	while (rows > len && gtk_tree_model_iter_nth_child(model, &iter, NULL, --rows))
+		gtk_list_store_remove(priv->store, &iter);
+
+	gtk_widget_queue_draw(priv->tree);
+}
+
+
+static void delete_rows(AoBookmarkListPrivate *priv, GArray *lines, guint pos, guint count)
+{
+	GtkTreeIter iter;
+
+	g_array_remove_range(lines, pos, count);
+	if (lines != priv->lines)
+		return;
+
+	while (count-- > 0 && gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(priv->store), &iter, NULL, pos))
+		gtk_list_store_remove(priv->store, &iter);
+}
+
+
+static void delete_line(AoBookmarkListPrivate *priv, GArray *lines, gint line_nr)
+{
+	guint pos;
+
+	if (find_line(lines, line_nr, &pos))
+		delete_rows(priv, lines, pos, 1);
+}
+
+
+static void add_line(AoBookmarkListPrivate *priv, GArray *lines, gint line_nr)
+{
+	guint pos;
+
+	if (find_line(lines, line_nr, &pos))
+		return;
+
+	g_array_insert_val(lines, pos, line_nr);
+	if (lines == priv->lines)
+	{
+		GtkTreeIter iter;
+		gtk_list_store_insert(priv->store, &iter, pos);
+	}
+}
+
+
+/* move the bookmarks after line_nr the way Scintilla moves its markers */
+static void shift_lines(AoBookmarkListPrivate *priv, GArray *lines, ScintillaObject *sci,
+						gint line_nr, gint lines_added)
+{
+	guint pos, end, i;
+
+	if (lines_added > 0)
+	{
+		gboolean found = find_line(lines, line_nr, &pos);
+
+		for (i = found ? pos + 1 : pos; i < lines->len; i++)
+			g_array_index(lines, gint, i) += lines_added;
+
+		/* text inserted at the start of a bookmarked line moves the marker down */
+		if (found && ! sci_is_marker_set_at_line(sci, line_nr, 1))
+			g_array_index(lines, gint, pos) += lines_added;
+	}
+	else
+	{
+		find_line(lines, line_nr + 1, &pos);
+		find_line(lines, line_nr - lines_added + 1, &end);
+
+		for (i = end; i < lines->len; i++)
+			g_array_index(lines, gint, i) += lines_added;
+
+		/* markers of deleted lines are merged into line_nr */
+		if (end > pos)
+		{
+			delete_rows(priv, lines, pos, end - pos);
+			if (sci_is_marker_set_at_line(sci, line_nr, 1))
+				add_line(priv, lines, line_nr);
+		}
+	}
+
+	if (lines == priv->lines)
+	{
+		update_number_column_width(priv);
+		gtk_widget_queue_draw(priv->tree);
+	}
+}
+
+
+static void set_document(AoBookmarkListPrivate *priv, GeanyDocument *doc)
+{
+	priv->doc = doc;
+	priv->lines = (doc != NULL) ? get_lines(priv, doc) : NULL;
+
+	gtk_tree_selection_unselect_all(gtk_tree_view_get_selection(GTK_TREE_VIEW(priv->tree)));
+	update_number_column_width(priv);
+	sync_rows(priv);
+}
+
+
+static void number_cell_data_func(GtkTreeViewColumn *column, GtkCellRenderer *cell,
+								  GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
+{
+	gchar text[16];
+	gint line_nr = get_row_line(AO_BOOKMARK_LIST_GET_PRIVATE(data), model, iter);
+
+	g_snprintf(text, sizeof(text), "%d", line_nr + 1);
+	g_object_set(cell, "text", (line_nr >= 0) ? text : NULL, NULL);
+}
+
+
+static void contents_cell_data_func(GtkTreeViewColumn *column, GtkCellRenderer *cell,
+									GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
+{
+	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(data);
+	gint line_nr = get_row_line(priv, model, iter);
+	gchar *line = (line_nr >= 0) ? get_line_text(priv, line_nr) : NULL;
+
+	g_object_set(cell, "text", line, NULL);
 	g_free(line);
-	g_free(tooltip);
 }
 
 
-static gboolean ao_selection_changed_cb(gpointer widget)
+static gboolean ao_query_tooltip_cb(GtkWidget *widget, gint x, gint y, gboolean keyboard_mode,
+									GtkTooltip *tooltip, gpointer data)
 {
-	GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
+	GtkTreeModel *model;
+	GtkTreePath *path;
+	GtkTreeIter iter;
+	gint line_nr;
+	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(data);
+
+	if (! gtk_tree_view_get_tooltip_context(GTK_TREE_VIEW(widget), &x, &y, keyboard_mode,
+			&model, &path, &iter))
+		return FALSE;
+
+	line_nr = get_row_line(priv, model, &iter);
+	if (line_nr >= 0)
+	{
+		gchar *line = get_line_text(priv, line_nr);
+
+		gtk_tooltip_set_text(tooltip, line);
+		gtk_tree_view_set_tooltip_row(GTK_TREE_VIEW(widget), tooltip, path);
+		g_free(line);
+	}
+	gtk_tree_path_free(path);
+
+	return line_nr >= 0;
+}
+
+
+static gboolean ao_search_equal_cb(GtkTreeModel *model, gint column, const gchar *key,
+								   GtkTreeIter *iter, gpointer data)
+{
+	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(data);
+	gint line_nr = get_row_line(priv, model, iter);
+	gchar *line, *line_folded, *key_folded;
+	gboolean match;
+
+	if (line_nr < 0)
+		return TRUE;
+
+	line = get_line_text(priv, line_nr);
+	line_folded = g_utf8_casefold(line, -1);
+	key_folded = g_utf8_casefold(key, -1);
+	match = g_str_has_prefix(line_folded, key_folded);
+
+	g_free(key_folded);
+	g_free(line_folded);
+	g_free(line);
+
+	/* FALSE means the row matches */
+	return ! match;
+}
+
+
+static gboolean ao_selection_changed_cb(gpointer data)
+{
+	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(data);
+	GtkTreeSelection *selection;
 	GtkTreeIter iter;
 	GtkTreeModel *model;
 
+	if (priv->tree == NULL)
+		return FALSE;
+
+	selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(priv->tree));
 	if (gtk_tree_selection_get_selected(selection, &model, &iter))
 	{
-		gint line;
+		gint line = get_row_line(priv, model, &iter);
 		GeanyDocument *doc = document_get_current();
-		if (DOC_VALID(doc))
+		if (DOC_VALID(doc) && line >= 0)
 		{
 			gint pos;
 
-			gtk_tree_model_get(model, &iter, BMLIST_COL_LINE, &line, -1);
-			pos = sci_get_position_from_line(doc->editor->sci, line - 1);
+			pos = sci_get_position_from_line(doc->editor->sci, line);
 
 			editor_goto_pos(doc->editor, pos, FALSE);
 			gtk_widget_grab_focus(GTK_WIDGET(doc->editor->sci));
@@ -221,7 +474,7 @@ static gboolean ao_button_press_cb(GtkWidget *widget, GdkEventButton *event, gpo
 {
 	if (event->button == 1)
 	{	/* allow reclicking of a treeview item */
-		g_idle_add(ao_selection_changed_cb, widget);
+		g_idle_add(ao_selection_changed_cb, data);
 	}
 	else if (event->button == 3)
 	{
@@ -245,7 +498,7 @@ static gboolean ao_key_press_cb(GtkWidget *widget, GdkEventKey *event, gpointer
 		event->keyval == GDK_KP_Enter ||
 		event->keyval == GDK_space)
 	{
-		g_idle_add(ao_selection_changed_cb, widget);
+		g_idle_add(ao_selection_changed_cb, data);
 	}
 
 	if ((event->keyval == GDK_F10 && event->state & GDK_SHIFT_MASK) || event->keyval == GDK_Menu)
@@ -276,6 +529,14 @@ static void ao_bookmark_list_hide(AoBookmarkList *bm)
 		gtk_widget_destroy(priv->popup_menu);
 		priv->popup_menu = NULL;
 	}
+	if (priv->docs)
+	{
+		g_hash_table_destroy(priv->docs);
+		priv->docs = NULL;
+	}
+	priv->tree = NULL;
+	priv->doc = NULL;
+	priv->lines = NULL;
 }
 
 
@@ -290,10 +551,9 @@ static void popup_item_click_cb(GtkWidget *button, gpointer data)
 
 	if (gtk_tree_selection_get_selected(treesel, &model, &iter))
 	{
-		GeanyDocument *doc = document_get_current();
-		gint line_nr;
-		gtk_tree_model_get(model, &iter, BMLIST_COL_LINE, &line_nr, -1);
-		sci_delete_marker_at_line(doc->editor->sci, line_nr - 1, 1);
+		gint line_nr = get_row_line(priv, model, &iter);
+		if (line_nr >= 0)
+			sci_delete_marker_at_line(priv->doc->editor->sci, line_nr, 1);
 	}
 }
 
@@ -320,42 +580,46 @@ static void ao_bookmark_list_show(AoBookmarkList *bm)
 	GtkTreeView *tree;
 	GtkListStore *store;
 	GtkWidget *scrollwin;
-	GtkTreeSortable *sortable;
-	GeanyDocument *doc;
 	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(bm);
 
 	tree = GTK_TREE_VIEW(gtk_tree_view_new());
-	store = gtk_list_store_new(BMLIST_COL_MAX, G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING);
+	store = gtk_list_store_new(BMLIST_COL_MAX, G_TYPE_INT);
 	gtk_tree_view_set_model(tree, GTK_TREE_MODEL(store));
 
+	/* fixed sizes, so that only visible rows are ever drawn and their lines read */
 	text_renderer = gtk_cell_renderer_text_new();
 	column = gtk_tree_view_column_new();
 	// Translators: Number is meant at this point.
 	gtk_tree_view_column_set_title(column, _("No."));
 	gtk_tree_view_column_pack_start(column, text_renderer, TRUE);
-	gtk_tree_view_column_set_attributes(column, text_renderer, "text", BMLIST_COL_LINE, NULL);
+	gtk_tree_view_column_set_cell_data_func(column, text_renderer, number_cell_data_func, bm, NULL);
+	gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
 	gtk_tree_view_append_column(tree, column);
+	priv->number_column = column;
 
 	text_renderer = gtk_cell_renderer_text_new();
 	g_object_set(text_renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
 	column = gtk_tree_view_column_new();
 	gtk_tree_view_column_set_title(column, _("Contents"));
 	gtk_tree_view_column_pack_start(column, text_renderer, TRUE);
-	gtk_tree_view_column_set_attributes(column, text_renderer, "text", BMLIST_COL_NAME, NULL);
+	gtk_tree_view_column_set_cell_data_func(column, text_renderer, contents_cell_data_func, bm, NULL);
+	gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_expand(column, TRUE);
 	gtk_tree_view_append_column(tree, column);
 	gtk_tree_view_set_headers_visible(tree, TRUE);
+	gtk_tree_view_set_fixed_height_mode(tree, TRUE);
 
-	gtk_tree_view_set_search_column(tree, BMLIST_COL_NAME);
-
-	/* sorting */
-	sortable = GTK_TREE_SORTABLE(GTK_TREE_MODEL(store));
-	gtk_tree_sortable_set_sort_column_id(sortable, BMLIST_COL_LINE, GTK_SORT_ASCENDING);
+	gtk_tree_view_set_search_column(tree, BMLIST_COL_UNUSED);
+	gtk_tree_view_set_search_equal_func(tree, ao_search_equal_cb, bm, NULL);
 
 	ui_widget_modify_font_from_string(GTK_WIDGET(tree), geany->interface_prefs->tagbar_font);
 
 	/* GTK 2.12 tooltips */
 	if (gtk_check_version(2, 12, 0) == NULL)
-		g_object_set(tree, "has-tooltip", TRUE, "tooltip-column", BMLIST_COL_TOOLTIP, NULL);
+	{
+		g_object_set(tree, "has-tooltip", TRUE, NULL);
+		g_signal_connect(tree, "query-tooltip", G_CALLBACK(ao_query_tooltip_cb), bm);
+	}
 
 	/* selection handling */
 	g_signal_connect(tree, "button-press-event", G_CALLBACK(ao_button_press_cb), bm);
@@ -378,11 +642,11 @@ static void ao_bookmark_list_show(AoBookmarkList *bm)
 	priv->store = store;
 	priv->tree = GTK_WIDGET(tree);
 	priv->page = scrollwin;
+	priv->number_digits = 0;
+	priv->docs = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, lines_free);
 
 	/* initial update */
-	doc = document_get_current();
-	if (doc != NULL)
-		ao_bookmark_list_update(bm, doc);
+	set_document(priv, document_get_current());
 }
 
 
@@ -403,38 +667,61 @@ void ao_bookmark_list_activate(AoBookmarkList *bm)
 
 void ao_bookmark_list_update(AoBookmarkList *bm, GeanyDocument *doc)
 {
-	gint line_nr = 0;
-	gint mask = 1 << 1;
-	ScintillaObject *sci = doc->editor->sci;
+	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(bm);
+
+	if (priv->enable_bookmarklist)
+		set_document(priv, doc);
+}
+
+
+void ao_bookmark_list_remove(AoBookmarkList *bm, GeanyDocument *doc)
+{
 	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(bm);
 
 	if (priv->enable_bookmarklist)
 	{
-		gtk_list_store_clear(priv->store);
-		while ((line_nr = scintilla_send_message(sci, SCI_MARKERNEXT, line_nr, mask)) != -1)
-		{
-			add_line(bm, sci, line_nr);
-			line_nr++;
-		}
+		if (priv->doc == doc)
+			set_document(priv, NULL);
+		g_hash_table_remove(priv->docs, doc);
 	}
 }
 
 
 void ao_bookmark_list_update_marker(AoBookmarkList *bm, GeanyEditor *editor, SCNotification *nt)
 {
+	GArray *lines;
+	guint pos;
 	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(bm);
 
-	if (priv->enable_bookmarklist &&
-		nt->nmhdr.code == SCN_MODIFIED && nt->modificationType == SC_MOD_CHANGEMARKER)
+	if (! priv->enable_bookmarklist || nt->nmhdr.code != SCN_MODIFIED)
+		return;
+
+	/* documents which were not displayed yet are read when they get activated */
+	lines = g_hash_table_lookup(priv->docs, editor->document);
+	if (lines == NULL)
+		return;
+
+	if (nt->modificationType & SC_MOD_CHANGEMARKER)
 	{
-		if (sci_is_marker_set_at_line(editor->sci, nt->line, 1))
-		{
-			add_line(bm, editor->sci, nt->line);
+		if (nt->line < 0)
+		{	/* all markers were deleted */
+			read_lines(lines, editor->sci);
+			if (lines == priv->lines)
+				sync_rows(priv);
 		}
+		else if (sci_is_marker_set_at_line(editor->sci, nt->line, 1))
+			add_line(priv, lines, nt->line);
 		else
-		{
-			delete_line(bm, nt->line);
-		}
+			delete_line(priv, lines, nt->line);
+	}
+	else if (nt->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))
+	{
+		gint line_nr = sci_get_line_from_position(editor->sci, nt->position);
+
+		if (nt->linesAdded != 0)
+			shift_lines(priv, lines, editor->sci, line_nr, nt->linesAdded);
+		else if (lines == priv->lines && find_line(lines, line_nr, &pos))
+			gtk_widget_queue_draw(priv->tree);	/* contents of a listed line changed */
 	}
 }
 
@@ -444,6 +731,10 @@ static void ao_bookmark_list_init(AoBookmarkList *self)
 	AoBookmarkListPrivate *priv = AO_BOOKMARK_LIST_GET_PRIVATE(self);
 
 	priv->page = NULL;
+	priv->tree = NULL;
+	priv->docs = NULL;
+	priv->doc = NULL;
+	priv->lines = NULL;
 }
 
 
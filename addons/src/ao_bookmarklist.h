@@ -42,6 +42,7 @@ typedef struct _AoBookmarkListClass		AoBookmarkListClass;
 GType			ao_bookmark_list_get_type		(void);
 AoBookmarkList*	ao_bookmark_list_new			(gboolean enable);
 void			ao_bookmark_list_update			(AoBookmarkList *bm, GeanyDocument *doc);
+void			ao_bookmark_list_remove			(AoBookmarkList *bm, GeanyDocument *doc);
 void 			ao_bookmark_list_update_marker	(AoBookmarkList *bm, GeanyEditor *editor,
 												 SCNotification *nt);
 void			ao_bookmark_list_activate		(AoBookmarkList *bm);
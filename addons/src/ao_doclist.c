@@ -21,6 +21,8 @@
  */
 
 
+#include <string.h>
+
 #include <gtk/gtk.h>
 #include <glib-object.h>
 
@@ -32,6 +34,8 @@
 #include "addons.h"
 #include "ao_doclist.h"
 
+#include <gdk/gdkkeysyms.h>
+
 
 typedef struct _AoDocListPrivate			AoDocListPrivate;
 
@@ -53,6 +57,20 @@ struct _AoDocListPrivate
 	gboolean enable_doclist;
 	DocListSortMode sort_mode;
 	GtkToolItem *toolbar_doclist_button;
+
+	/* all open documents, kept up to date from document signals */
+	GtkListStore *store;
+	GHashTable *rows;		/* GeanyDocument* -> GtkTreeIter* in store */
+	gboolean positions_dirty;
+
+	/* store -> filter -> sort, shown in the popup */
+	GtkTreeModel *filter;
+	GtkTreeModel *sort;
+	gchar *filter_key;
+
+	GtkWidget *popup;
+	GtkWidget *entry;
+	GtkWidget *tree;
 };
 
 enum
@@ -67,6 +85,16 @@ enum
 	ACTION_CLOSE_ALL
 };
 
+enum
+{
+	DOCLIST_COL_DOC,
+	DOCLIST_COL_NAME,
+	DOCLIST_COL_KEY,
+	DOCLIST_COL_TOOLTIP,
+	DOCLIST_COL_POSITION,
+	DOCLIST_COL_MAX
+};
+
 static void ao_doc_list_finalize  			(GObject *object);
 static void ao_doclist_set_property(GObject *object, guint prop_id,
 									const GValue *value, GParamSpec *pspec);
@@ -106,26 +134,44 @@ static void ao_doc_list_class_init(AoDocListClass *klass)
 }
 
 
+static void ao_doc_list_positions_changed_cb(AoDocList *self)
+{
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(self);
+
+	priv->positions_dirty = TRUE;
+}
+
+
 static void ao_doc_list_finalize(GObject *object)
 {
 	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(object);
 
+	g_signal_handlers_disconnect_by_func(geany->main_widgets->notebook,
+		ao_doc_list_positions_changed_cb, object);
+
 	if (priv->toolbar_doclist_button != NULL)
 		gtk_widget_destroy(GTK_WIDGET(priv->toolbar_doclist_button));
+	if (priv->popup != NULL)
+		gtk_widget_destroy(priv->popup);
+
+	g_object_unref(priv->sort);
+	g_object_unref(priv->filter);
+	g_object_unref(priv->store);
+	g_hash_table_destroy(priv->rows);
+	g_free(priv->filter_key);
 
 	G_OBJECT_CLASS(ao_doc_list_parent_class)->finalize(object);
 }
 
 
 /* This function is taken from Midori's katze-utils.c, thanks to Christian. */
-static void ao_popup_position_menu(GtkMenu *menu, gint *x, gint *y, gboolean *push_in, gpointer data)
+static void ao_popup_get_position(GtkWidget *widget, gint *x, gint *y)
 {
 	gint wx, wy;
 	GtkRequisition widget_req;
-	GtkWidget *widget = data;
 	gint widget_height;
 
-	/* Retrieve size and position of both widget and menu */
+	/* Retrieve size and position of widget */
 	if (GTK_WIDGET_NO_WINDOW(widget))
 	{
 		gdk_window_get_position(widget->window, &wx, &wy);
@@ -137,86 +183,422 @@ static void ao_popup_position_menu(GtkMenu *menu, gint *x, gint *y, gboolean *pu
 	gtk_widget_size_request(widget, &widget_req);
 	widget_height = widget_req.height; /* Better than allocation.height */
 
-	/* Calculate menu position */
+	/* Calculate popup position */
 	*x = wx;
 	*y = wy + widget_height;
-
-	*push_in = TRUE;
 }
 
 
-static void ao_doclist_menu_item_activate_cb(GtkMenuItem *menuitem, gpointer data)
+static void ao_doclist_action_cb(GtkWidget *widget, gpointer data)
 {
-	GeanyDocument *doc = data;
+	GtkWidget *w;
 
 	if (GPOINTER_TO_INT(data) == ACTION_CLOSE_OTHER)
+		w = ui_lookup_widget(geany->main_widgets->window, "close_other_documents1");
+	else
+		w = ui_lookup_widget(geany->main_widgets->window, "menu_close_all1");
+
+	g_signal_emit_by_name(w, "activate");
+}
+
+
+static void set_row(AoDocListPrivate *priv, GtkTreeIter *iter, GeanyDocument *doc)
+{
+	gchar *name = document_get_basename_for_display(doc, -1);
+	gchar *key = g_utf8_casefold(name, -1);
+	gchar *tooltip = g_markup_escape_text(DOC_FILENAME(doc), -1);
+
+	gtk_list_store_set(priv->store, iter,
+		DOCLIST_COL_DOC, doc,
+		DOCLIST_COL_NAME, name,
+		DOCLIST_COL_KEY, key,
+		DOCLIST_COL_TOOLTIP, tooltip,
+		-1);
+
+	g_free(name);
+	g_free(key);
+	g_free(tooltip);
+}
+
+
+/* Adds the document to the list or updates its name, e.g. after "Save As". */
+void ao_doc_list_update_document(AoDocList *self, GeanyDocument *doc)
+{
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(self);
+	GtkTreeIter *iter;
+
+	if (! priv->enable_doclist)
+		return;
+
+	iter = g_hash_table_lookup(priv->rows, doc);
+	if (iter == NULL)
 	{
-		GtkWidget *w = ui_lookup_widget(geany->main_widgets->window, "close_other_documents1");
-		g_signal_emit_by_name(w, "activate");
+		iter = g_new(GtkTreeIter, 1);
+		gtk_list_store_insert_with_values(priv->store, iter, -1,
+			DOCLIST_COL_POSITION, G_MAXINT, -1);
+		g_hash_table_insert(priv->rows, doc, iter);
+		priv->positions_dirty = TRUE;
+	}
+	set_row(priv, iter, doc);
+}
+
+
+void ao_doc_list_remove_document(AoDocList *self, GeanyDocument *doc)
+{
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(self);
+	GtkTreeIter *iter = g_hash_table_lookup(priv->rows, doc);
+
+	if (iter != NULL)
+	{
+		gtk_list_store_remove(priv->store, iter);
+		g_hash_table_remove(priv->rows, doc);
+	}
+}
+
+
+static GtkWidget *get_page_child(GeanyDocument *doc)
+{
+	GtkWidget *notebook = geany->main_widgets->notebook;
+	GtkWidget *widget = GTK_WIDGET(doc->editor->sci);
+
+	while (widget != NULL && gtk_widget_get_parent(widget) != notebook)
+		widget = gtk_widget_get_parent(widget);
+
+	return widget;
+}
+
+
+/* Updates the tab positions of the documents, if tabs were added, removed or moved. */
+static void update_positions(AoDocListPrivate *priv)
+{
+	GHashTable *positions;
+	GHashTableIter iter;
+	GList *children, *node;
+	gpointer doc, row;
+	gint pos = 0;
+
+	if (! priv->positions_dirty)
 		return;
+
+	positions = g_hash_table_new(g_direct_hash, g_direct_equal);
+	children = gtk_container_get_children(GTK_CONTAINER(geany->main_widgets->notebook));
+	for (node = children; node != NULL; node = node->next)
+		g_hash_table_insert(positions, node->data, GINT_TO_POINTER(++pos));
+	g_list_free(children);
+
+	g_hash_table_iter_init(&iter, priv->rows);
+	while (g_hash_table_iter_next(&iter, &doc, &row))
+	{
+		gint old_pos;
+
+		pos = GPOINTER_TO_INT(g_hash_table_lookup(positions, get_page_child(doc)));
+		gtk_tree_model_get(GTK_TREE_MODEL(priv->store), row, DOCLIST_COL_POSITION, &old_pos, -1);
+		if (pos != old_pos)
+			gtk_list_store_set(priv->store, row, DOCLIST_COL_POSITION, pos, -1);
+	}
+	g_hash_table_destroy(positions);
+	priv->positions_dirty = FALSE;
+}
+
+
+static gint ao_doclist_sort_func(GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer data)
+{
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(data);
+	gint result;
+
+	if (priv->sort_mode == DOCLIST_SORT_BY_NAME)
+	{
+		gchar *key_a, *key_b;
+
+		gtk_tree_model_get(model, a, DOCLIST_COL_KEY, &key_a, -1);
+		gtk_tree_model_get(model, b, DOCLIST_COL_KEY, &key_b, -1);
+		result = g_strcmp0(key_a, key_b);
+		g_free(key_a);
+		g_free(key_b);
 	}
-	else if (GPOINTER_TO_INT(data) == ACTION_CLOSE_ALL)
+	else
 	{
-		GtkWidget *w = ui_lookup_widget(geany->main_widgets->window, "menu_close_all1");
-		g_signal_emit_by_name(w, "activate");
+		gint pos_a, pos_b;
+
+		gtk_tree_model_get(model, a, DOCLIST_COL_POSITION, &pos_a, -1);
+		gtk_tree_model_get(model, b, DOCLIST_COL_POSITION, &pos_b, -1);
+		result = pos_a - pos_b;
+		if (priv->sort_mode == DOCLIST_SORT_BY_TAB_ORDER_REVERSE)
+			result = -result;
+	}
+	return result;
+}
+
+
+static gboolean ao_doclist_visible_func(GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
+{
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(data);
+	gchar *key;
+	gboolean visible;
+
+	if (EMPTY(priv->filter_key))
+		return TRUE;
+
+	gtk_tree_model_get(model, iter, DOCLIST_COL_KEY, &key, -1);
+	visible = key != NULL && strstr(key, priv->filter_key) != NULL;
+	g_free(key);
+
+	return visible;
+}
+
+
+static void name_cell_data_func(GtkTreeViewColumn *column, GtkCellRenderer *cell,
+								GtkTreeModel *model, GtkTreeIter *iter, gpointer data)
+{
+	GeanyDocument *doc;
+	gchar *name;
+
+	gtk_tree_model_get(model, iter, DOCLIST_COL_DOC, &doc, DOCLIST_COL_NAME, &name, -1);
+	g_object_set(cell,
+		"text", name,
+		"weight", (doc == document_get_current()) ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL,
+		"style", (DOC_VALID(doc) && doc->changed) ? PANGO_STYLE_ITALIC : PANGO_STYLE_NORMAL,
+		NULL);
+	g_free(name);
+}
+
+
+static void ao_doclist_popup_hide(AoDocListPrivate *priv)
+{
+	gtk_widget_hide(priv->popup);
+}
+
+
+static void activate_cursor_row(AoDocListPrivate *priv)
+{
+	GtkTreePath *path;
+	GtkTreeIter iter;
+	GeanyDocument *doc = NULL;
+
+	gtk_tree_view_get_cursor(GTK_TREE_VIEW(priv->tree), &path, NULL);
+	if (path == NULL)
 		return;
+
+	if (gtk_tree_model_get_iter(priv->sort, &iter, path))
+		gtk_tree_model_get(priv->sort, &iter, DOCLIST_COL_DOC, &doc, -1);
+	gtk_tree_path_free(path);
+
+	ao_doclist_popup_hide(priv);
+	if (DOC_VALID(doc))
+	{
+		gtk_notebook_set_current_page(GTK_NOTEBOOK(geany->main_widgets->notebook),
+			document_get_notebook_page(doc));
 	}
+}
+
+
+static void move_cursor(AoDocListPrivate *priv, gint delta)
+{
+	GtkTreePath *path;
+	gint n = gtk_tree_model_iter_n_children(priv->sort, NULL);
+	gint idx = 0;
 
-	if (! DOC_VALID(doc))
+	if (n == 0)
 		return;
 
-	gtk_notebook_set_current_page(GTK_NOTEBOOK(geany->main_widgets->notebook),
-		document_get_notebook_page(doc));
+	gtk_tree_view_get_cursor(GTK_TREE_VIEW(priv->tree), &path, NULL);
+	if (path != NULL)
+	{
+		idx = CLAMP(gtk_tree_path_get_indices(path)[0] + delta, 0, n - 1);
+		gtk_tree_path_free(path);
+	}
+	path = gtk_tree_path_new_from_indices(idx, -1);
+	gtk_tree_view_set_cursor(GTK_TREE_VIEW(priv->tree), path, NULL, FALSE);
+	gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(priv->tree), path, NULL, FALSE, 0, 0);
+	gtk_tree_path_free(path);
 }
 
 
-static void ao_toolbar_item_doclist_clicked_cb(GtkWidget *button, gpointer data)
+/* Puts the cursor on the current document, or on the first row if it is filtered out. */
+static void select_current_document(AoDocListPrivate *priv)
+{
+	GeanyDocument *doc = document_get_current();
+	GtkTreeIter *row = (doc != NULL) ? g_hash_table_lookup(priv->rows, doc) : NULL;
+	GtkTreeIter filter_iter, sort_iter;
+	GtkTreePath *path;
+
+	if (row != NULL &&
+		gtk_tree_model_filter_convert_child_iter_to_iter(GTK_TREE_MODEL_FILTER(priv->filter),
+			&filter_iter, row))
+	{
+		gtk_tree_model_sort_convert_child_iter_to_iter(GTK_TREE_MODEL_SORT(priv->sort),
+			&sort_iter, &filter_iter);
+		path = gtk_tree_model_get_path(priv->sort, &sort_iter);
+		gtk_tree_view_set_cursor(GTK_TREE_VIEW(priv->tree), path, NULL, FALSE);
+		gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(priv->tree), path, NULL, TRUE, 0.5, 0);
+		gtk_tree_path_free(path);
+	}
+	else if (gtk_tree_model_iter_n_children(priv->sort, NULL) > 0)
+	{
+		path = gtk_tree_path_new_first();
+		gtk_tree_view_set_cursor(GTK_TREE_VIEW(priv->tree), path, NULL, FALSE);
+		gtk_tree_path_free(path);
+	}
+}
+
+
+static void ao_doclist_entry_changed_cb(GtkEditable *editable, gpointer data)
 {
-	static GtkWidget *menu = NULL;
-	GtkWidget *menu_item;
-	GeanyDocument *current_doc = document_get_current();
-	GCompareFunc compare_func;
 	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(data);
 
-	if (menu != NULL)
-		gtk_widget_destroy(menu);
+	g_free(priv->filter_key);
+	priv->filter_key = g_utf8_casefold(gtk_entry_get_text(GTK_ENTRY(editable)), -1);
+	gtk_tree_model_filter_refilter(GTK_TREE_MODEL_FILTER(priv->filter));
+
+	select_current_document(priv);
+}
 
-	menu = gtk_menu_new();
 
-	switch (priv->sort_mode)
+static void ao_doclist_entry_activate_cb(GtkEntry *entry, gpointer data)
+{
+	activate_cursor_row(AO_DOC_LIST_GET_PRIVATE(data));
+}
+
+
+static gboolean ao_doclist_key_press_cb(GtkWidget *widget, GdkEventKey *event, gpointer data)
+{
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(data);
+
+	switch (event->keyval)
 	{
-		case DOCLIST_SORT_BY_NAME:
-			compare_func = document_compare_by_display_name;
-			break;
-		case DOCLIST_SORT_BY_TAB_ORDER_REVERSE:
-			compare_func = document_compare_by_tab_order_reverse;
-			break;
-		case DOCLIST_SORT_BY_TAB_ORDER:
-		default:
-			compare_func = document_compare_by_tab_order;
-			break;
+		case GDK_Escape:
+			ao_doclist_popup_hide(priv);
+			return TRUE;
+		case GDK_Up:
+		case GDK_KP_Up:
+			move_cursor(priv, -1);
+			return TRUE;
+		case GDK_Down:
+		case GDK_KP_Down:
+			move_cursor(priv, 1);
+			return TRUE;
+		case GDK_Page_Up:
+		case GDK_KP_Page_Up:
+			move_cursor(priv, -10);
+			return TRUE;
+		case GDK_Page_Down:
+		case GDK_KP_Page_Down:
+			move_cursor(priv, 10);
+			return TRUE;
 	}
+	return FALSE;
+}
+
+
+static gboolean ao_doclist_button_release_cb(GtkWidget *widget, GdkEventButton *event, gpointer data)
+{
+	if (event->button == 1)
+		activate_cursor_row(AO_DOC_LIST_GET_PRIVATE(data));
+
+	return FALSE;
+}
+
+
+static gboolean ao_doclist_focus_out_cb(GtkWidget *widget, GdkEventFocus *event, gpointer data)
+{
+	ao_doclist_popup_hide(AO_DOC_LIST_GET_PRIVATE(data));
+
+	return FALSE;
+}
+
+
+static GtkWidget *create_action_button(const gchar *label, gint action, AoDocListPrivate *priv)
+{
+	GtkWidget *button = gtk_button_new_with_mnemonic(label);
 
-	ui_menu_add_document_items_sorted(GTK_MENU(menu), current_doc,
-		G_CALLBACK(ao_doclist_menu_item_activate_cb), compare_func);
-
-	menu_item = gtk_separator_menu_item_new();
-	gtk_widget_show(menu_item);
-	gtk_container_add(GTK_CONTAINER(menu), menu_item);
-
-	menu_item = ui_image_menu_item_new(GTK_STOCK_CLOSE, _("Close Ot_her Documents"));
-	gtk_widget_show(menu_item);
-	gtk_container_add(GTK_CONTAINER(menu), menu_item);
-	g_signal_connect(menu_item, "activate", G_CALLBACK(ao_doclist_menu_item_activate_cb),
-		GINT_TO_POINTER(ACTION_CLOSE_OTHER));
-	menu_item = ui_image_menu_item_new(GTK_STOCK_CLOSE, _("C_lose All"));
-	gtk_widget_show(menu_item);
-	gtk_container_add(GTK_CONTAINER(menu), menu_item);
-	g_signal_connect(menu_item, "activate", G_CALLBACK(ao_doclist_menu_item_activate_cb),
-		GINT_TO_POINTER(ACTION_CLOSE_ALL));
-
-	gtk_menu_popup(GTK_MENU(menu), NULL, NULL,
-		ao_popup_position_menu, button, 0, gtk_get_current_event_time());
+	gtk_button_set_image(GTK_BUTTON(button),
+		gtk_image_new_from_stock(GTK_STOCK_CLOSE, GTK_ICON_SIZE_BUTTON));
+	gtk_button_set_relief(GTK_BUTTON(button), GTK_RELIEF_NONE);
+	g_signal_connect_swapped(button, "clicked", G_CALLBACK(ao_doclist_popup_hide), priv);
+	g_signal_connect(button, "clicked", G_CALLBACK(ao_doclist_action_cb), GINT_TO_POINTER(action));
+
+	return button;
+}
+
+
+static void create_popup(AoDocList *self)
+{
+	GtkWidget *vbox, *hbox, *scrollwin;
+	GtkCellRenderer *renderer;
+	GtkTreeViewColumn *column;
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(self);
+
+	priv->popup = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+	gtk_window_set_decorated(GTK_WINDOW(priv->popup), FALSE);
+	gtk_window_set_skip_taskbar_hint(GTK_WINDOW(priv->popup), TRUE);
+	gtk_window_set_skip_pager_hint(GTK_WINDOW(priv->popup), TRUE);
+	gtk_window_set_type_hint(GTK_WINDOW(priv->popup), GDK_WINDOW_TYPE_HINT_POPUP_MENU);
+	gtk_window_set_transient_for(GTK_WINDOW(priv->popup), GTK_WINDOW(geany->main_widgets->window));
+	gtk_window_set_default_size(GTK_WINDOW(priv->popup), 300, 400);
+	g_signal_connect(priv->popup, "delete-event", G_CALLBACK(gtk_widget_hide_on_delete), NULL);
+	g_signal_connect(priv->popup, "focus-out-event", G_CALLBACK(ao_doclist_focus_out_cb), self);
+	g_signal_connect(priv->popup, "key-press-event", G_CALLBACK(ao_doclist_key_press_cb), self);
+
+	priv->entry = gtk_entry_new();
+	g_signal_connect(priv->entry, "changed", G_CALLBACK(ao_doclist_entry_changed_cb), self);
+	g_signal_connect(priv->entry, "activate", G_CALLBACK(ao_doclist_entry_activate_cb), self);
+
+	/* fixed row heights, so that only the visible rows are measured and drawn */
+	priv->tree = gtk_tree_view_new_with_model(priv->sort);
+	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(priv->tree), FALSE);
+	gtk_tree_view_set_enable_search(GTK_TREE_VIEW(priv->tree), FALSE);
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+	column = gtk_tree_view_column_new();
+	gtk_tree_view_column_pack_start(column, renderer, TRUE);
+	gtk_tree_view_column_set_cell_data_func(column, renderer, name_cell_data_func, NULL, NULL);
+	gtk_tree_view_column_set_sizing(column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(priv->tree), column);
+	gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(priv->tree), TRUE);
+	g_object_set(priv->tree, "has-tooltip", TRUE, "tooltip-column", DOCLIST_COL_TOOLTIP, NULL);
+	g_signal_connect(priv->tree, "button-release-event",
+		G_CALLBACK(ao_doclist_button_release_cb), self);
+
+	scrollwin = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scrollwin),
+		GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+	gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(scrollwin), GTK_SHADOW_IN);
+	gtk_container_add(GTK_CONTAINER(scrollwin), priv->tree);
+
+	hbox = gtk_hbox_new(FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(hbox),
+		create_action_button(_("Close Ot_her Documents"), ACTION_CLOSE_OTHER, priv), FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(hbox),
+		create_action_button(_("C_lose All"), ACTION_CLOSE_ALL, priv), FALSE, FALSE, 0);
+
+	vbox = gtk_vbox_new(FALSE, 3);
+	gtk_container_set_border_width(GTK_CONTAINER(vbox), 3);
+	gtk_box_pack_start(GTK_BOX(vbox), priv->entry, FALSE, FALSE, 0);
+	gtk_box_pack_start(GTK_BOX(vbox), scrollwin, TRUE, TRUE, 0);
+	gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+	gtk_container_add(GTK_CONTAINER(priv->popup), vbox);
+	gtk_widget_show_all(vbox);
+}
+
+
+static void ao_toolbar_item_doclist_clicked_cb(GtkWidget *button, gpointer data)
+{
+	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(data);
+	gint x, y;
+
+	if (priv->popup == NULL)
+		create_popup(AO_DOC_LIST(data));
+
+	update_positions(priv);
+
+	/* resets the filter and selects the current document */
+	gtk_entry_set_text(GTK_ENTRY(priv->entry), "");
+	ao_doclist_entry_changed_cb(GTK_EDITABLE(priv->entry), data);
+
+	ao_popup_get_position(button, &x, &y);
+	gtk_window_move(GTK_WINDOW(priv->popup), x, y);
+	gtk_window_present(GTK_WINDOW(priv->popup));
+	gtk_widget_grab_focus(priv->entry);
 }
 
 
@@ -260,11 +642,33 @@ static void ao_doclist_set_property(GObject *object, guint prop_id,
 	switch (prop_id)
 	{
 		case PROP_ENABLE_DOCLIST:
-			priv->enable_doclist = g_value_get_boolean(value);
+		{
+			gboolean new_val = g_value_get_boolean(value);
+
+			if (new_val && ! priv->enable_doclist)
+			{
+				guint i;
+
+				priv->enable_doclist = TRUE;
+				foreach_document(i)
+				{
+					ao_doc_list_update_document(AO_DOC_LIST(object), documents[i]);
+				}
+			}
+			else if (! new_val && priv->enable_doclist)
+			{
+				gtk_list_store_clear(priv->store);
+				g_hash_table_remove_all(priv->rows);
+			}
+			priv->enable_doclist = new_val;
 			ao_toolbar_update(AO_DOC_LIST(object));
 			break;
+		}
 		case PROP_SORT_MODE:
 			priv->sort_mode = g_value_get_int(value);
+			/* setting the sort function again resorts the list */
+			gtk_tree_sortable_set_default_sort_func(GTK_TREE_SORTABLE(priv->sort),
+				ao_doclist_sort_func, object, NULL);
 			break;
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -276,8 +680,31 @@ static void ao_doclist_set_property(GObject *object, guint prop_id,
 static void ao_doc_list_init(AoDocList *self)
 {
 	AoDocListPrivate *priv = AO_DOC_LIST_GET_PRIVATE(self);
+	GtkWidget *notebook = geany->main_widgets->notebook;
 
 	priv->toolbar_doclist_button = NULL;
+	priv->popup = NULL;
+	priv->filter_key = NULL;
+	priv->positions_dirty = TRUE;
+
+	priv->store = gtk_list_store_new(DOCLIST_COL_MAX,
+		G_TYPE_POINTER, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT);
+	priv->rows = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+	priv->filter = gtk_tree_model_filter_new(GTK_TREE_MODEL(priv->store), NULL);
+	gtk_tree_model_filter_set_visible_func(GTK_TREE_MODEL_FILTER(priv->filter),
+		ao_doclist_visible_func, self, NULL);
+	priv->sort = gtk_tree_model_sort_new_with_model(priv->filter);
+	gtk_tree_sortable_set_default_sort_func(GTK_TREE_SORTABLE(priv->sort),
+		ao_doclist_sort_func, self, NULL);
+
+	/* tab positions are refreshed lazily when the list is shown */
+	g_signal_connect_swapped(notebook, "page-added",
+		G_CALLBACK(ao_doc_list_positions_changed_cb), self);
+	g_signal_connect_swapped(notebook, "page-removed",
+		G_CALLBACK(ao_doc_list_positions_changed_cb), self);
+	g_signal_connect_swapped(notebook, "page-reordered",
+		G_CALLBACK(ao_doc_list_positions_changed_cb), self);
 }
 
 
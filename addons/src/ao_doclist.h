@@ -51,6 +51,8 @@ typedef enum
 
 GType		ao_doc_list_get_type		(void);
 AoDocList*	ao_doc_list_new				(gboolean enable, DocListSortMode sort_mode);
+void		ao_doc_list_update_document	(AoDocList *self, GeanyDocument *doc);
+void		ao_doc_list_remove_document	(AoDocList *self, GeanyDocument *doc);
 
 G_END_DECLS
 
@@ -21,6 +21,8 @@
  */
 
 
+#include <string.h>
+
 #include <gtk/gtk.h>
 #include <glib-object.h>
 
@@ -48,8 +50,26 @@ struct _AoMarkWordClass
 struct _AoMarkWordPrivate
 {
 	gboolean enable_markword;
+
+	/* state of the marking in progress, if source_id is set */
+	guint source_id;
+	GeanyDocument *doc;
+	ScintillaObject *sci;
+	gchar *word;
+	gsize word_len;
+	gint vis_start;		/* the visible range is marked first */
+	gint vis_end;
+	gint pos;			/* where to continue outside of the visible range */
+	gint count;
+
+	gboolean word_chars[256];
 };
 
+/* amount of text scanned between checks of the time slice */
+#define MARKWORD_CHUNK_SIZE		(256 * 1024)
+/* time slice of the idle marking, in seconds */
+#define MARKWORD_SLICE			0.01
+
 enum
 {
 	PROP_0,
@@ -58,6 +78,7 @@ enum
 
 
 static void ao_mark_word_finalize  			(GObject *object);
+static void mark_word_cancel				(AoMarkWordPrivate *priv);
 
 G_DEFINE_TYPE(AoMarkWord, ao_mark_word, G_TYPE_OBJECT)
 
@@ -71,6 +92,8 @@ static void ao_mark_word_set_property(GObject *object, guint prop_id,
 	{
 		case PROP_ENABLE_MARKWORD:
 			priv->enable_markword = g_value_get_boolean(value);
+			if (! priv->enable_markword)
+				mark_word_cancel(priv);
 			break;
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -99,15 +122,202 @@ static void ao_mark_word_class_init(AoMarkWordClass *klass)
 }
 
 
+static void mark_word_cancel(AoMarkWordPrivate *priv)
+{
+	if (priv->source_id != 0)
+	{
+		g_source_remove(priv->source_id);
+		priv->source_id = 0;
+	}
+	g_free(priv->word);
+	priv->word = NULL;
+	priv->doc = NULL;
+	priv->sci = NULL;
+}
+
+
 static void ao_mark_word_finalize(GObject *object)
 {
 	g_return_if_fail(object != NULL);
 	g_return_if_fail(IS_AO_MARKWORD(object));
 
+	mark_word_cancel(AO_MARKWORD_GET_PRIVATE(object));
+
 	G_OBJECT_CLASS(ao_mark_word_parent_class)->finalize(object);
 }
 
 
+static gboolean is_word_char(AoMarkWordPrivate *priv, gchar c)
+{
+	return priv->word_chars[(guchar) c];
+}
+
+
+/* like SCFIND_WHOLEWORD: the match must not continue a word on either side.
+ * Unlike Mark All, which follows the options of the search dialog, matching is
+ * always case sensitive and on whole words. */
+static gboolean is_whole_word(AoMarkWordPrivate *priv, const gchar *text, gint len,
+							  gint start, gint end)
+{
+	if (start > 0 && is_word_char(priv, text[start - 1]) && is_word_char(priv, text[start]))
+		return FALSE;
+	if (end < len && is_word_char(priv, text[end - 1]) && is_word_char(priv, text[end]))
+		return FALSE;
+	return TRUE;
+}
+
+
+/* Marks the occurrences of the word starting in [start, end). */
+static void mark_range(AoMarkWordPrivate *priv, const gchar *text, gint len, gint start, gint end)
+{
+	gint word_len = (gint) priv->word_len;
+	gint pos = start;
+
+	scintilla_send_message(priv->sci, SCI_SETINDICATORCURRENT, GEANY_INDICATOR_SEARCH, 0);
+	while (pos < end)
+	{
+		const gchar *found = memchr(text + pos, priv->word[0], end - pos);
+
+		if (found == NULL)
+			break;
+
+		pos = found - text;
+		if (pos + word_len <= len && memcmp(found, priv->word, word_len) == 0 &&
+			is_whole_word(priv, text, len, pos, pos + word_len))
+		{
+			scintilla_send_message(priv->sci, SCI_INDICATORFILLRANGE, pos, word_len);
+			priv->count++;
+			pos += word_len;
+		}
+		else
+			pos++;
+	}
+}
+
+
+static void mark_word_finish(AoMarkWordPrivate *priv)
+{
+	ui_set_statusbar(FALSE, _("Matches for \"%s\": %d."), priv->word, priv->count);
+
+	priv->source_id = 0;
+	mark_word_cancel(priv);
+}
+
+
+/* Marks the rest of the document outside of the visible range, a time slice at a time. */
+static gboolean mark_word_idle(gpointer data)
+{
+	AoMarkWordPrivate *priv = AO_MARKWORD_GET_PRIVATE(data);
+	const gchar *text;
+	gint len;
+	GTimer *timer;
+
+	/* the document could have been closed meanwhile */
+	if (! DOC_VALID(priv->doc) || priv->doc->editor->sci != priv->sci)
+	{
+		priv->source_id = 0;
+		mark_word_cancel(priv);
+		return FALSE;
+	}
+
+	text = (const gchar *) scintilla_send_message(priv->sci, SCI_GETCHARACTERPOINTER, 0, 0);
+	len = sci_get_length(priv->sci);
+
+	timer = g_timer_new();
+	while (priv->pos < len && g_timer_elapsed(timer, NULL) < MARKWORD_SLICE)
+	{
+		gint limit = (priv->pos < priv->vis_start) ? priv->vis_start : len;
+		gint end = MIN(priv->pos + MARKWORD_CHUNK_SIZE, limit);
+
+		mark_range(priv, text, len, priv->pos, end);
+		priv->pos = (end == priv->vis_start) ? priv->vis_end : end;
+	}
+	g_timer_destroy(timer);
+
+	if (priv->pos < len)
+		return TRUE;
+
+	mark_word_finish(priv);
+	return FALSE;
+}
+
+
+/* The word characters of the document, Scintilla treats all non-ASCII bytes as word characters */
+static void update_word_chars(AoMarkWordPrivate *priv, ScintillaObject *sci)
+{
+	gchar *chars = NULL;
+	const gchar *c;
+	gint i;
+
+	for (i = 0; i < 256; i++)
+		priv->word_chars[i] = (i >= 0x80);
+
+#ifdef SCI_GETWORDCHARS
+	chars = g_malloc0(scintilla_send_message(sci, SCI_GETWORDCHARS, 0, 0) + 1);
+	scintilla_send_message(sci, SCI_GETWORDCHARS, 0, (sptr_t) chars);
+#endif
+	for (c = (chars != NULL) ? chars : GEANY_WORDCHARS; *c != '\0'; c++)
+		priv->word_chars[(guchar) *c] = TRUE;
+	g_free(chars);
+}
+
+
+static gchar *get_word(ScintillaObject *sci, gint pos)
+{
+	gint start, end;
+
+	if (sci_has_selection(sci))
+		return sci_get_selection_contents(sci);
+
+	start = scintilla_send_message(sci, SCI_WORDSTARTPOSITION, pos, TRUE);
+	end = scintilla_send_message(sci, SCI_WORDENDPOSITION, pos, TRUE);
+	return (start < end) ? sci_get_contents_range(sci, start, end) : NULL;
+}
+
+
+static void mark_word(AoMarkWord *mw, GeanyEditor *editor, gint pos)
+{
+	AoMarkWordPrivate *priv = AO_MARKWORD_GET_PRIVATE(mw);
+	ScintillaObject *sci = editor->sci;
+	const gchar *text;
+	gint len, first, last;
+
+	mark_word_cancel(priv);
+	editor_indicator_clear(editor, GEANY_INDICATOR_SEARCH);
+
+	priv->word = get_word(sci, pos);
+	if (EMPTY(priv->word))
+	{
+		mark_word_cancel(priv);
+		return;
+	}
+	priv->word_len = strlen(priv->word);
+	priv->doc = editor->document;
+	priv->sci = sci;
+	priv->count = 0;
+	update_word_chars(priv, sci);
+
+	/* the visible lines first, so that the user sees the result at once */
+	first = scintilla_send_message(sci, SCI_DOCLINEFROMVISIBLE,
+		scintilla_send_message(sci, SCI_GETFIRSTVISIBLELINE, 0, 0), 0);
+	last = scintilla_send_message(sci, SCI_DOCLINEFROMVISIBLE,
+		scintilla_send_message(sci, SCI_GETFIRSTVISIBLELINE, 0, 0) +
+		scintilla_send_message(sci, SCI_LINESONSCREEN, 0, 0), 0);
+	priv->vis_start = sci_get_position_from_line(sci, first);
+	priv->vis_end = sci_get_line_end_position(sci, last);
+
+	text = (const gchar *) scintilla_send_message(sci, SCI_GETCHARACTERPOINTER, 0, 0);
+	len = sci_get_length(sci);
+	mark_range(priv, text, len, priv->vis_start, priv->vis_end);
+
+	priv->pos = (priv->vis_start > 0) ? 0 : priv->vis_end;
+	if (priv->pos < len)
+		priv->source_id = g_idle_add(mark_word_idle, mw);
+	else
+		mark_word_finish(priv);
+}
+
+
 void ao_mark_word_check(AoMarkWord *bm, GeanyEditor *editor, SCNotification *nt)
 {
 	AoMarkWordPrivate *priv = AO_MARKWORD_GET_PRIVATE(bm);
@@ -117,7 +327,15 @@ void ao_mark_word_check(AoMarkWord *bm, GeanyEditor *editor, SCNotification *nt)
 		switch (nt->nmhdr.code)
 		{
 			case SCN_DOUBLECLICK:
-				keybindings_send_command(GEANY_KEY_GROUP_SEARCH, GEANY_KEYS_SEARCH_MARKALL);
+				mark_word(bm, editor, nt->position);
+				break;
+			case SCN_MODIFIED:
+				/* positions are not valid anymore, keep what was marked so far */
+				if (priv->source_id != 0 && editor->sci == priv->sci &&
+					nt->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))
+				{
+					mark_word_cancel(priv);
+				}
 				break;
 		}
 	}
@@ -126,6 +344,12 @@ void ao_mark_word_check(AoMarkWord *bm, GeanyEditor *editor, SCNotification *nt)
 
 static void ao_mark_word_init(AoMarkWord *self)
 {
+	AoMarkWordPrivate *priv = AO_MARKWORD_GET_PRIVATE(self);
+
+	priv->source_id = 0;
+	priv->doc = NULL;
+	priv->sci = NULL;
+	priv->word = NULL;
 }
 
 
@@ -41,6 +41,151 @@ gboolean enclose_enabled = FALSE;
 gchar *config_file;
 GtkListStore *chars_list;
 
+typedef struct
+{
+	gint start;
+	gint end;
+	gint caret;
+	gint anchor;
+	gboolean is_main;
+} EncloseRange;
+
+static gint compare_ranges (gconstpointer a, gconstpointer b)
+{
+	return ((const EncloseRange *) a)->start - ((const EncloseRange *) b)->start;
+}
+
+/*
+ * Returns where a position ends up after the sorted, non-overlapping ranges have been
+ * enclosed: two characters were inserted for each range before it and one more if the
+ * position lies inside a range.
+ */
+
+static gint map_position (GArray *ranges, gint pos)
+{
+	guint lo = 0, hi = ranges->len;
+
+	while (lo < hi)
+	{
+		guint mid = (lo + hi) / 2;
+
+		if (g_array_index (ranges, EncloseRange, mid).end < pos)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < ranges->len && g_array_index (ranges, EncloseRange, lo).start <= pos)
+		return pos + 2 * lo + 1;
+	return pos + 2 * lo;
+}
+
+/*
+ * Encloses every non-empty selection (rectangular selections count as one selection per
+ * line) in the given characters as a single undo action, and selects the enclosed text
+ * again.  Returns FALSE if there was nothing to enclose.
+ */
+
+static gboolean enclose_selections (ScintillaObject *sci_obj, gchar prior_char, gchar end_char)
+{
+	gint count = scintilla_send_message (sci_obj, SCI_GETSELECTIONS, 0, 0);
+	gint main_sel = scintilla_send_message (sci_obj, SCI_GETMAINSELECTION, 0, 0);
+	gboolean rectangle = scintilla_send_message (sci_obj, SCI_GETSELECTIONMODE, 0, 0) ==
+		SC_SEL_RECTANGLE;
+	gint rect_anchor = 0, rect_caret = 0, rect_anchor_space = 0, rect_caret_space = 0;
+	gchar prior_text [2] = {0, 0};
+	gchar end_text [2] = {0, 0};
+	GArray *selections, *ranges;
+	gint i;
+
+	selections = g_array_sized_new (FALSE, FALSE, sizeof (EncloseRange), count);
+	ranges = g_array_new (FALSE, FALSE, sizeof (EncloseRange));
+
+	for (i = 0; i < count; i++)
+	{
+		EncloseRange range;
+
+		range.start = scintilla_send_message (sci_obj, SCI_GETSELECTIONNSTART, i, 0);
+		range.end = scintilla_send_message (sci_obj, SCI_GETSELECTIONNEND, i, 0);
+		range.caret = scintilla_send_message (sci_obj, SCI_GETSELECTIONNCARET, i, 0);
+		range.anchor = scintilla_send_message (sci_obj, SCI_GETSELECTIONNANCHOR, i, 0);
+		range.is_main = (i == main_sel);
+
+		g_array_append_val (selections, range);
+		if (range.end > range.start)
+			g_array_append_val (ranges, range);
+	}
+
+	if (rectangle)
+	{
+		rect_anchor = scintilla_send_message (sci_obj, SCI_GETRECTANGULARSELECTIONANCHOR, 0, 0);
+		rect_caret = scintilla_send_message (sci_obj, SCI_GETRECTANGULARSELECTIONCARET, 0, 0);
+		rect_anchor_space = scintilla_send_message (sci_obj,
+			SCI_GETRECTANGULARSELECTIONANCHORVIRTUALSPACE, 0, 0);
+		rect_caret_space = scintilla_send_message (sci_obj,
+			SCI_GETRECTANGULARSELECTIONCARETVIRTUALSPACE, 0, 0);
+	}
+
+	if (ranges->len > 0)
+	{
+		g_array_sort (selections, compare_ranges);
+		g_array_sort (ranges, compare_ranges);
+
+		prior_text [0] = prior_char;
+		end_text [0] = end_char;
+
+		sci_start_undo_action (sci_obj);
+
+		/* drop the selections, so Scintilla doesn't move all of them on each insertion,
+		 * and insert from the end, so the positions before stay valid */
+		scintilla_send_message (sci_obj, SCI_SETEMPTYSELECTION, 0, 0);
+		for (i = ranges->len - 1; i >= 0; i--)
+		{
+			EncloseRange *range = &g_array_index (ranges, EncloseRange, i);
+
+			scintilla_send_message (sci_obj, SCI_INSERTTEXT, range->end, (sptr_t) end_text);
+			scintilla_send_message (sci_obj, SCI_INSERTTEXT, range->start, (sptr_t) prior_text);
+		}
+
+		if (rectangle)
+		{
+			/* restore it as a rectangle, Scintilla works out the selection of each line */
+			scintilla_send_message (sci_obj, SCI_SETRECTANGULARSELECTIONANCHOR,
+				map_position (ranges, rect_anchor), 0);
+			scintilla_send_message (sci_obj, SCI_SETRECTANGULARSELECTIONCARET,
+				map_position (ranges, rect_caret), 0);
+			scintilla_send_message (sci_obj, SCI_SETRECTANGULARSELECTIONANCHORVIRTUALSPACE,
+				rect_anchor_space, 0);
+			scintilla_send_message (sci_obj, SCI_SETRECTANGULARSELECTIONCARETVIRTUALSPACE,
+				rect_caret_space, 0);
+		}
+		else
+		{
+			for (i = 0; i < (gint) selections->len; i++)
+			{
+				EncloseRange *range = &g_array_index (selections, EncloseRange, i);
+				gint caret = map_position (ranges, range->caret);
+				gint anchor = map_position (ranges, range->anchor);
+
+				scintilla_send_message (sci_obj, i == 0 ? SCI_SETSELECTION : SCI_ADDSELECTION,
+					caret, anchor);
+				if (range->is_main)
+					main_sel = i;
+			}
+			scintilla_send_message (sci_obj, SCI_SETMAINSELECTION, main_sel, 0);
+		}
+		scintilla_send_message (sci_obj, SCI_SCROLLCARET, 0, 0);
+
+		sci_end_undo_action (sci_obj);
+	}
+
+	count = ranges->len;
+	g_array_free (ranges, TRUE);
+	g_array_free (selections, TRUE);
+
+	return count > 0;
+}
+
 /*
  * Called when a keybinding associated with the plugin is pressed.  Encloses the selected text in
  * the characters associated with this keybinding.
@@ -48,8 +193,6 @@ GtkListStore *chars_list;
 
 void enclose_text_action (guint key_id)
 {
-	gint selection_end;
-	gchar insert_chars [2] = {0, 0};
 	ScintillaObject *sci_obj;
 
 	if (!enclose_enabled)
@@ -57,19 +200,8 @@ void enclose_text_action (guint key_id)
 
 	sci_obj = document_get_current ()->editor->sci;
 
-	if (sci_get_selected_text_length (sci_obj) < 2)
-		return;
-
 	key_id -= 4;
-	selection_end = sci_get_selection_end (sci_obj);
-
-	sci_start_undo_action (sci_obj);
-	insert_chars [0] = *enclose_chars [key_id];
-	sci_insert_text (sci_obj, sci_get_selection_start (sci_obj), insert_chars);
-	insert_chars [0] = *(enclose_chars [key_id] + 1);
-	sci_insert_text (sci_obj, selection_end + 1, insert_chars);
-	sci_set_current_position (sci_obj, selection_end + 2, TRUE);
-	sci_end_undo_action (sci_obj);
+	enclose_selections (sci_obj, *enclose_chars [key_id], *(enclose_chars [key_id] + 1));
 }
 
 /*
@@ -79,7 +211,6 @@ void enclose_text_action (guint key_id)
 
 gboolean on_key_press (GtkWidget *widget, GdkEventKey *event, gpointer user_data)
 {
-	gint selection_end;
 	gchar insert_chars [4] = {0, 0, 0, 0};
 	ScintillaObject *sci_obj;
 
@@ -91,9 +222,6 @@ gboolean on_key_press (GtkWidget *widget, GdkEventKey *event, gpointer user_data
 
 	sci_obj = document_get_current ()->editor->sci;
 
-	if (sci_get_selected_text_length (sci_obj) < 2)
-		return FALSE;
-
 	switch (event->keyval)
 	{
 		case '(':
@@ -124,15 +252,7 @@ gboolean on_key_press (GtkWidget *widget, GdkEventKey *event, gpointer user_data
 			return FALSE;
 	}
 
-	selection_end = sci_get_selection_end (sci_obj);
-
-	sci_start_undo_action (sci_obj);
-	sci_insert_text (sci_obj, sci_get_selection_start (sci_obj), insert_chars);
-	sci_insert_text (sci_obj, selection_end + 1, insert_chars+2);
-	sci_set_current_position (sci_obj, selection_end + 2, TRUE);
-	sci_end_undo_action (sci_obj);
-
-	return TRUE;
+	return enclose_selections (sci_obj, insert_chars [0], insert_chars [2]);
 }
 
 /*
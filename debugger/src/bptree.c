@@ -72,7 +72,13 @@ static GtkCellRenderer	*condition_renderer;
 /* tells to checkbox click handler whether page is in readonly mode (debug running) */
 static gboolean readonly = FALSE;
 
-/* hash table to keep file nodes in the tree */
+/* file node in the tree along with a number of its disabled breakpoints */
+typedef struct _file_node {
+	GtkTreeIter iter;
+	int disabled;
+} file_node;
+
+/* hash table to keep file nodes in the tree (tree store iters persist) */
 static GHashTable *files;
 
 /* callback handler */
@@ -121,31 +127,71 @@ static GtkTreeRowReference* get_unselected_sibling(GtkTreePath *path)
 /* 
  * checks file ENABLED column if all childs are enabled and unchecks otherwise
  */
-static void update_file_node(GtkTreeIter *file_iter)
+static void update_file_node(file_node *node)
+{
+	gtk_tree_store_set(store, &node->iter, ENABLED, !node->disabled, -1);
+}
+
+/* 
+ * gets file node for a breakpoint, creating it at the top if it doesn't exist
+ */
+static file_node* get_file_node(const char *file)
 {
-	GtkTreeIter child;
-	gboolean check = TRUE;
-	if(gtk_tree_model_iter_children(model, &child, file_iter))
+	file_node *node = (file_node*)g_hash_table_lookup(files, file);
+	if (!node)
 	{
-		do
-		{
-			gboolean enabled;
-			gtk_tree_model_get (
-				model,
-				&child,
-				ENABLED, &enabled,
-				-1);
-				
-			if (!enabled)
-			{
-				check = FALSE;
-				break;
-			}
-		}
-		while(gtk_tree_model_iter_next(model, &child));
+		node = g_new0(file_node, 1);
+		gtk_tree_store_insert_with_values (store, &node->iter, NULL, 0,
+						FILEPATH, file,
+						ENABLED, TRUE,
+						-1);
+		g_hash_table_insert(files, (gpointer)g_strdup(file), (gpointer)node);
 	}
 
-	gtk_tree_store_set(store, file_iter, ENABLED, check, -1);
+	return node;
+}
+
+/* 
+ * fills breakpoint row
+ */
+static void set_breakpoint_row(breakpoint *bp)
+{
+	gchar *location = g_strdup_printf(_("line %i"), bp->line);
+	
+	gtk_tree_store_set (store, &bp->iter,
+                    ENABLED, bp->enabled,
+                    HITSCOUNT, bp->hitscount,
+                    CONDITION, bp->condition,
+                    FILEPATH, location,
+                    LINE, bp->line,
+                    -1);
+	
+    g_free(location);
+}
+
+/* 
+ * updates file node disabled counter from breakpoint row ENABLED value
+ */
+static void set_breakpoint_enabled(breakpoint *bp, file_node *node)
+{
+	gboolean enabled;
+	gtk_tree_model_get(model, &bp->iter, ENABLED, &enabled, -1);
+
+	if (!enabled != !bp->enabled)
+	{
+		node->disabled += bp->enabled ? -1 : 1;
+		update_file_node(node);
+	}
+}
+
+/* 
+ * compares breakpoints by file and line in descending order
+ */
+static gint compare_breaks_desc(gconstpointer a, gconstpointer b)
+{
+	const breakpoint *bpa = (const breakpoint*)a, *bpb = (const breakpoint*)b;
+	int result = strcmp(bpb->file, bpa->file);
+	return result ? result : bpb->line - bpa->line;
 }
 
 /* 
@@ -617,7 +663,7 @@ gboolean bptree_init(move_to_line_cb cb)
 		g_str_hash,
 		g_str_equal,
 		(GDestroyNotify)g_free,
-		(GDestroyNotify)gtk_tree_row_reference_free
+		(GDestroyNotify)g_free
 	);
 	
 	/* create tree view */
@@ -734,12 +780,8 @@ void bptree_destroy(void)
  */
 void bptree_set_enabled(breakpoint *bp)
 {
-	GtkTreeIter parent;
-
+	set_breakpoint_enabled(bp, (file_node*)g_hash_table_lookup(files, bp->file));
 	gtk_tree_store_set(store, &(bp->iter), ENABLED, bp->enabled, -1);
-
-	gtk_tree_model_iter_parent(model, &parent, &(bp->iter));
-	update_file_node(&parent);
 }
 
 /*
@@ -799,34 +841,11 @@ void bptree_set_readonly(gboolean value)
  */
 void bptree_add_breakpoint(breakpoint* bp)
 {
-	GtkTreeIter file_iter, iter, child, *sibling = NULL;
-	GtkTreeRowReference *file_reference = (GtkTreeRowReference*)g_hash_table_lookup(files, bp->file);
-
-	if (!file_reference)
-	{
-		GtkTreePath *file_path;
-
-		gtk_tree_store_prepend (store, &file_iter, NULL);
-		gtk_tree_store_set (store, &file_iter,
-						FILEPATH, bp->file,
-						ENABLED, TRUE,
-						-1);
-
-		file_path = gtk_tree_model_get_path(model, &file_iter);
-		file_reference = gtk_tree_row_reference_new(model, file_path);
-		gtk_tree_path_free(file_path);
-
-		g_hash_table_insert(files, (gpointer)g_strdup(bp->file),(gpointer)file_reference);
-	}
-	else
-	{
-		GtkTreePath *path = gtk_tree_row_reference_get_path(file_reference);
-		gtk_tree_model_get_iter(model, &file_iter, path);
-		gtk_tree_path_free(path);
-	}
+	GtkTreeIter iter, child, *sibling = NULL;
+	file_node *node = get_file_node(bp->file);
 	
 	/* lookup where to insert new row */
-	if(gtk_tree_model_iter_children(model, &child, &file_iter))
+	if(gtk_tree_model_iter_children(model, &child, &node->iter))
 	{
 		do
 		{
@@ -845,10 +864,64 @@ void bptree_add_breakpoint(breakpoint* bp)
 		while(gtk_tree_model_iter_next(model, &child));
 	}
 	
-	gtk_tree_store_insert_before(store, &iter, &file_iter, sibling);
+	gtk_tree_store_insert_before(store, &iter, &node->iter, sibling);
 	bp->iter = iter;
 	
-	bptree_update_breakpoint(bp);
+	set_breakpoint_row(bp);
+	if (!bp->enabled)
+	{
+		node->disabled++;
+		update_file_node(node);
+	}
+}
+
+/*
+ * add a list of breakpoints to the tree view at once,
+ * tree is filled detached from the view, each file's breaks are
+ * sorted once and prepended from the last one
+ * arguments:
+ * 		breaks - list of breakpoints to add
+ */
+void bptree_add_breakpoints(GList *breaks)
+{
+	GList *sorted, *iter;
+	file_node *node = NULL;
+	gboolean fresh = FALSE;
+
+	g_object_ref(model);
+	gtk_tree_view_set_model(GTK_TREE_VIEW(tree), NULL);
+
+	sorted = g_list_sort(g_list_copy(breaks), compare_breaks_desc);
+	for (iter = sorted; iter; iter = iter->next)
+	{
+		breakpoint *bp = (breakpoint*)iter->data;
+
+		if (!iter->prev || strcmp(((breakpoint*)iter->prev->data)->file, bp->file))
+		{
+			/* next file, only files without breaks can be filled by prepending */
+			node = (file_node*)g_hash_table_lookup(files, bp->file);
+			fresh = !node || !gtk_tree_model_iter_has_child(model, &node->iter);
+			if (!node)
+				node = get_file_node(bp->file);
+		}
+
+		if (fresh)
+		{
+			/* breaks come in descending line order, so each one goes first */
+			gtk_tree_store_insert(store, &bp->iter, &node->iter, 0);
+			set_breakpoint_row(bp);
+			if (!bp->enabled)
+				node->disabled++;
+		}
+		else
+			bptree_add_breakpoint(bp);
+	}
+	g_list_free(sorted);
+
+	bptree_update_file_nodes();
+
+	gtk_tree_view_set_model(GTK_TREE_VIEW(tree), model);
+	g_object_unref(model);
 }
 
 /*
@@ -858,17 +931,31 @@ void bptree_add_breakpoint(breakpoint* bp)
  */
 void bptree_update_breakpoint(breakpoint* bp)
 {
-	gchar *location = g_strdup_printf(_("line %i"), bp->line);
-	
-	gtk_tree_store_set (store, &bp->iter,
-                    ENABLED, bp->enabled,
-                    HITSCOUNT, bp->hitscount,
-                    CONDITION, bp->condition,
-                    FILEPATH, location,
-                    LINE, bp->line,
-                    -1);
-	
-    g_free(location);
+	set_breakpoint_enabled(bp, (file_node*)g_hash_table_lookup(files, bp->file));
+	set_breakpoint_row(bp);
+}
+
+/*
+ * update line numbers of the breakpoints in the list,
+ * rows keep their order since all lines are shifted by the same offset
+ * arguments:
+ * 		breaks - list of breakpoints to update
+ */
+void bptree_update_lines(GList *breaks)
+{
+	GList *iter;
+	for (iter = breaks; iter; iter = iter->next)
+	{
+		breakpoint *bp = (breakpoint*)iter->data;
+		gchar *location = g_strdup_printf(_("line %i"), bp->line);
+
+		gtk_tree_store_set (store, &bp->iter,
+						FILEPATH, location,
+						LINE, bp->line,
+						-1);
+
+		g_free(location);
+	}
 }
 
 /*
@@ -878,35 +965,46 @@ void bptree_update_breakpoint(breakpoint* bp)
  */
 void bptree_remove_breakpoint(breakpoint* bp)
 {
-	GtkTreeIter file;
-	gtk_tree_model_iter_parent(model, &file, &(bp->iter));
-	
+	file_node *node = (file_node*)g_hash_table_lookup(files, bp->file);
+	gboolean enabled;
+
+	gtk_tree_model_get(model, &bp->iter, ENABLED, &enabled, -1);
 	gtk_tree_store_remove(store, &(bp->iter));
 
-	if (!gtk_tree_model_iter_n_children(model, &file))
+	if (!gtk_tree_model_iter_has_child(model, &node->iter))
 	{
+		gtk_tree_store_remove(store, &node->iter);
 		g_hash_table_remove(files, (gpointer)bp->file);
-		gtk_tree_store_remove(store, &file);
 	}
-	else
+	else if (!enabled)
 	{
-		update_file_node(&file);
+		node->disabled--;
+		update_file_node(node);
 	}
 }
 
+/*
+ * removes all breakpoints from the tree view
+ * arguments:
+ */
+void bptree_remove_all(void)
+{
+	gtk_tree_store_clear(store);
+	g_hash_table_remove_all(files);
+}
+
 /*
  * updates all file ENABLED checkboxes base on theit children states
  * arguments:
  */
 void bptree_update_file_nodes(void)
 {
-	GtkTreeIter file;
-	if(gtk_tree_model_iter_children(model, &file, NULL))
+	GHashTableIter iter;
+	gpointer node;
+
+	g_hash_table_iter_init(&iter, files);
+	while (g_hash_table_iter_next(&iter, NULL, &node))
 	{
-		do
-		{
-			update_file_node(&file);
-		}
-		while(gtk_tree_model_iter_next(model, &file));
+		update_file_node((file_node*)node);
 	}
 }
@@ -31,7 +31,10 @@ gboolean		bptree_init(move_to_line_cb callback);
 void			bptree_destroy(void);
 void 			bptree_add_breakpoint(breakpoint* bp);
 void 			bptree_update_breakpoint(breakpoint* bp);
+void 			bptree_update_lines(GList *breaks);
 void 			bptree_remove_breakpoint(breakpoint* bp);
+void 			bptree_add_breakpoints(GList *breaks);
+void 			bptree_remove_all(void);
 void 			bptree_set_condition(breakpoint* bp);
 void 			bptree_set_hitscount(breakpoint* bp);
 void 			bptree_set_enabled(breakpoint* bp);
@@ -40,6 +40,9 @@ extern GeanyFunctions	*geany_functions;
 /* container for break-for-file g_tree GTree-s */
 GHashTable* files = NULL;
 
+/* breakpoints on deleted lines waiting to be removed from the debug session */
+static GList *removals_pending = NULL;
+
 /*
  * Functions for breakpoint iteration support
  */
@@ -94,17 +97,31 @@ static void on_add(breakpoint *bp)
 	/* add marker */
 	markers_add_breakpoint(bp);
 }
+static gboolean breaks_is_stored(breakpoint *bp)
+{
+	GTree *tree = g_hash_table_lookup(files, bp->file);
+	return tree && g_tree_lookup(tree, GINT_TO_POINTER(bp->line)) == bp;
+}
 static void on_remove(breakpoint *bp)
 {
-	GTree *tree;
+	GTree *tree = g_hash_table_lookup(files, bp->file);
+	breakpoint *stored = tree ? (breakpoint*)g_tree_lookup(tree, GINT_TO_POINTER(bp->line)) : NULL;
 	
 	/* remove marker */
 	markers_remove_breakpoint(bp);
 	/* remove from breakpoints tab */
 	bptree_remove_breakpoint(bp);
 	/* remove from internal storage */
-	tree = g_hash_table_lookup(files, bp->file);
-	g_tree_remove(tree, GINT_TO_POINTER(bp->line));
+	if (stored == bp)
+		g_tree_remove(tree, GINT_TO_POINTER(bp->line));
+	else
+	{
+		/* already taken out of the storage by breaks_shift_lines,
+		its old line may hold a shifted breakpoint now */
+		if (stored)
+			markers_add_breakpoint(stored);
+		g_free(bp);
+	}
 }
 static void on_set_hits_count(breakpoint *bp)
 {
@@ -299,9 +316,11 @@ static void breaks_remove_list_debug(GList *list)
 	for (iter = list; iter; iter = iter->next)
 	{
 		breakpoint *bp = (breakpoint*)iter->data;
-		if (debug_remove_break(bp))
+		/* a breakpoint on deleted lines is not in the storage any more,
+		drop it even if the debugger failed to remove it */
+		if (debug_remove_break(bp) || !breaks_is_stored(bp))
 		{
-			on_remove((breakpoint*)iter->data);
+			on_remove(bp);
 		}
 	}
 	g_list_free(list);
@@ -334,8 +353,14 @@ gboolean breaks_init(move_to_line_cb cb)
  */
 void breaks_destroy(void)
 {
-	/* remove all markers */
 	GList *breaks, *iter;
+
+	/* breakpoints on deleted lines are not in the storage any more */
+	g_list_foreach(removals_pending, (GFunc)g_free, NULL);
+	g_list_free(removals_pending);
+	removals_pending = NULL;
+
+	/* remove all markers */
 	breaks = iter = breaks_get_all();
 	while (iter)
 	{
@@ -398,6 +423,69 @@ void breaks_add(const char* file, int line, char* condition, int enabled, int hi
 		debug_request_interrupt((bs_callback)breaks_add_debug, (gpointer)bp);
 }
 
+/*
+ * Add a list of breakpoints at once (used on debug config loading).
+ * Breaks tab is populated in bulk if debugger is idle.
+ * arguments:
+ * 		list - list of breakpoints allocated by break_new_full,
+ * 		list and breakpoints are owned by the function
+ */
+void breaks_add_list(GList *list)
+{
+	GList *iter, *added = NULL;
+
+	if (DBS_IDLE != debug_get_state())
+	{
+		for (iter = list; iter; iter = iter->next)
+		{
+			breakpoint *bp = (breakpoint*)iter->data;
+			breaks_add(bp->file, bp->line, bp->condition, bp->enabled, bp->hitscount);
+			g_free(bp);
+		}
+		g_list_free(list);
+
+		return;
+	}
+
+	for (iter = list; iter; iter = iter->next)
+	{
+		breakpoint *bp = (breakpoint*)iter->data;
+		GTree *tree;
+
+		/* check whether GTree for this file exists and create if doesn't */
+		if (!(tree = g_hash_table_lookup(files, bp->file)))
+		{
+			char *newfile = g_strdup(bp->file);
+			tree = g_tree_new_full(compare_func, NULL, NULL, (GDestroyNotify)g_free);
+			g_hash_table_insert(files, newfile, tree);
+		}
+
+		/* skip duplicates */
+		if (g_tree_lookup(tree, GINT_TO_POINTER(bp->line)))
+		{
+			g_free(bp);
+			continue;
+		}
+
+		/* insert to internal storage */
+		g_tree_insert(tree, GINT_TO_POINTER(bp->line), bp);
+		added = g_list_prepend(added, bp);
+	}
+	g_list_free(list);
+
+	/* add to breakpoints tab */
+	bptree_add_breakpoints(added);
+
+	/* add markers */
+	for (iter = added; iter; iter = iter->next)
+	{
+		markers_add_breakpoint((breakpoint*)iter->data);
+	}
+	g_list_free(added);
+
+	config_set_debug_changed();
+}
+
 /*
  * Remove breakpoint.
  * arguments:
@@ -465,7 +553,8 @@ void breaks_remove_list(GList *list)
  */
 void breaks_remove_all(void)
 {
-	g_hash_table_foreach(files, hash_table_foreach_call_function, (gpointer)on_remove);
+	g_hash_table_foreach(files, hash_table_foreach_call_function, (gpointer)markers_remove_breakpoint);
+	bptree_remove_all();
 	g_hash_table_remove_all(files);
 }
 
@@ -638,6 +727,104 @@ void breaks_move_to_line(const char* file, int line_from, int line_to)
 	}
 }
 
+/*
+ * Iterates through GTree
+ * adding items starting from the given line to GList
+ */
+typedef struct _shift_data {
+	int line;
+	GList *breaks;
+} shift_data;
+static gboolean tree_foreach_add_from_line(gpointer key, gpointer value, gpointer data)
+{
+	shift_data *sd = (shift_data*)data;
+	if (GPOINTER_TO_INT(key) >= sd->line)
+		sd->breaks = g_list_prepend(sd->breaks, value);
+	return FALSE;
+}
+
+/*
+ * Removes the breakpoints on deleted lines which were waiting for
+ * the debugger to get to a state allowing to change breakpoints.
+ */
+void breaks_remove_pending(void)
+{
+	GList *list;
+	enum dbs state = debug_get_state();
+
+	if (!removals_pending || (DBS_IDLE != state && DBS_STOPPED != state))
+		return;
+
+	list = removals_pending;
+	removals_pending = NULL;
+	breaks_remove_list(list);
+}
+
+/*
+ * Shifts all file breakpoints starting from a line in a single pass,
+ * removing the ones that were on deleted lines the way breaks_remove does.
+ * The shifted breakpoints are not passed to the debug session, which only
+ * knows the files that are readonly while debugging - breakpoints are set
+ * with their new lines when next session starts.
+ * arguments:
+ * 		file - breakpoints filename
+ * 		line - first affected line
+ * 		delta - number of lines added (negative for deleted lines)
+ */
+void breaks_shift_lines(const char* file, int line, int delta)
+{
+	GTree *tree;
+	shift_data sd = { line, NULL };
+	GList *iter, *shifted = NULL, *removed = NULL;
+	enum dbs state;
+
+	if (!delta || !(tree = g_hash_table_lookup(files, file)))
+		return;
+
+	/* collect affected breakpoints in ascending order */
+	g_tree_foreach(tree, tree_foreach_add_from_line, &sd);
+	if (!sd.breaks)
+		return;
+	sd.breaks = g_list_reverse(sd.breaks);
+
+	/* take them all out first, so that new lines never collide with old ones */
+	for (iter = sd.breaks; iter; iter = iter->next)
+		g_tree_steal(tree, GINT_TO_POINTER(((breakpoint*)iter->data)->line));
+
+	for (iter = sd.breaks; iter; iter = iter->next)
+	{
+		breakpoint *bp = (breakpoint*)iter->data;
+		if (delta < 0 && bp->line < line - delta)
+			removed = g_list_prepend(removed, bp);
+		else
+		{
+			bp->line += delta;
+			g_tree_insert(tree, GINT_TO_POINTER(bp->line), bp);
+			shifted = g_list_prepend(shifted, bp);
+		}
+	}
+
+	bptree_update_lines(shifted);
+
+	g_list_free(shifted);
+	g_list_free(sd.breaks);
+
+	/* mark config for saving */
+	config_set_debug_changed();
+
+	/* breaks_remove_list takes the list, keep the removals until the debugger
+	can handle them if it can not be interrupted now */
+	if (removed)
+	{
+		state = debug_get_state();
+		if (DBS_IDLE == state || DBS_STOPPED == state ||
+			(DBS_RUNNING == state && debug_supports_async_breaks()))
+			breaks_remove_list(removed);
+		else
+			removals_pending = g_list_concat(removals_pending, removed);
+	}
+}
+
 /*
  * Checks whether breakpoint is set.
  * arguments:
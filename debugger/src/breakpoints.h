@@ -38,6 +38,7 @@ typedef void	(*select_frame_cb)(int frame_number);
 gboolean		breaks_init(move_to_line_cb callback);
 void			breaks_destroy(void);
 void			breaks_add(const char* file, int line, char* condition, int enable, int hitscount);
+void			breaks_add_list(GList *list);
 void			breaks_remove(const char* file, int line);
 void			breaks_remove_list(GList *list);
 void			breaks_remove_all(void);
@@ -46,6 +47,8 @@ void			breaks_set_hits_count(const char *file, int line, int count);
 void			breaks_set_condition(const char *file, int line, const char* condition);
 void			breaks_set_enabled_for_file(const char *file, gboolean enabled);
 void			breaks_move_to_line(const char* file, int line_from, int line_to);
+void			breaks_shift_lines(const char* file, int line, int delta);
+void			breaks_remove_pending(void);
 break_state		breaks_get_state(const char* file, int line);
 GList*			breaks_get_for_document(const char* file);
 GList*			breaks_get_all(void);
@@ -260,42 +260,12 @@ gboolean on_editor_notify(
 		}
 		case SCN_MODIFIED:
 		{
-			if(((SC_MOD_INSERTTEXT & nt->modificationType) || (SC_MOD_DELETETEXT && nt->modificationType)) && editor->document->file_name && nt->linesAdded)
+			if(((SC_MOD_INSERTTEXT & nt->modificationType) || (SC_MOD_DELETETEXT & nt->modificationType)) && editor->document->file_name && nt->linesAdded)
 			{
 				int line = sci_get_line_from_position(editor->sci, nt->position) + 1;
 
-				GList *breaks = breaks_get_for_document(editor->document->file_name);
-				if (breaks)
-				{
-					GList *iter = breaks;
-					while (iter)
-					{
-						breakpoint *bp = (breakpoint*)iter->data;
-
-						if (nt->linesAdded > 0 && bp->line >= line)
-						{
-							breaks_move_to_line(bp->file, bp->line, bp->line + nt->linesAdded);
-							bptree_update_breakpoint(bp);
-						}
-						else if (nt->linesAdded < 0 && bp->line >= line)
-						{
-							if (bp->line < line - nt->linesAdded)
-							{
-								breaks_remove(bp->file, bp->line);
-							}
-							else
-							{
-								breaks_move_to_line(bp->file, bp->line, bp->line + nt->linesAdded);
-								bptree_update_breakpoint(bp);
-							}
-						}
-						iter = iter->next;
-					}
-					
-					config_set_debug_changed();
-
-					g_list_free(breaks);
-				}
+				/* shift (and remove) all affected breakpoints in one pass */
+				breaks_shift_lines(editor->document->file_name, line, nt->linesAdded);
 			}
 			break;
 		}
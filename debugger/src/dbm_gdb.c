@@ -111,8 +111,14 @@ static GList *autos = NULL;
 /* watches list */
 static GList *watches = NULL;
 
-/* loaded files list */
-static GList *files = NULL;
+/* set when the frame has changed and autos/watches have to be refreshed
+on the next request, so that a stop is reported without waiting for them */
+static gboolean autos_outdated = FALSE;
+static gboolean watches_outdated = FALSE;
+
+/* loaded files set and its generation, that is increased each time the set changes */
+static GHashTable *files = NULL;
+static guint files_generation = 0;
 
 /* set to true if library was loaded/unloaded
 and it's nessesary to refresh files list */
@@ -181,16 +187,20 @@ static void on_gdb_exit(GPid pid, gint status, gpointer data)
 	g_list_foreach(autos, (GFunc)g_free, NULL);
 	g_list_free(autos);
 	autos = NULL;
+	autos_outdated = FALSE;
 	
 	/* delete watches */
 	g_list_foreach(watches, (GFunc)g_free, NULL);
 	g_list_free(watches);
 	watches = NULL;
+	watches_outdated = FALSE;
 	
 	/* delete files */
-	g_list_foreach(files, (GFunc)g_free, NULL);
-	g_list_free(files);
-	files = NULL;
+	if (files)
+	{
+		g_hash_table_destroy(files);
+		files = NULL;
+	}
 	
 	g_source_remove(gdb_src_id);
 	
@@ -526,11 +536,8 @@ static gboolean on_read_from_gdb(GIOChannel * src, GIOCondition cond, gpointer d
 
 				if (SR_BREAKPOINT_HIT == stop_reason || SR_END_STEPPING_RANGE == stop_reason)
 				{
-					/* update autos */
-					update_autos();
-			
-					/* update watches */
-					update_watches();
+					/* autos and watches are refreshed when requested */
+					autos_outdated = watches_outdated = TRUE;
 			
 					/* update files */
 					if (file_refresh_needed)
@@ -1104,8 +1111,7 @@ static void set_active_frame(int frame_number)
 	if (RC_DONE == exec_sync_command(command, TRUE, NULL))
 	{
 		active_frame = frame_number;
-		update_autos();
-		update_watches();
+		autos_outdated = watches_outdated = TRUE;
 	}
 	g_free(command);
 }
@@ -1410,23 +1416,23 @@ static void get_variables (GList *vars)
 	}
 }
 
+/*
+ * checks whether a key is not in the hash table passed as user data
+ */
+static gboolean hash_table_missing_key(gpointer key, gpointer value, gpointer user_data)
+{
+	return !g_hash_table_lookup((GHashTable*)user_data, key);
+}
+
 /*
  * updates files list
  */
 static void update_files(void)
 {
-	GHashTable *ht = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, NULL);
+	GHashTable *ht = g_hash_table_new_full(g_str_hash, g_str_equal, (GDestroyNotify)g_free, NULL);
 	gchar *record = NULL;
 	gchar *pos;
 
-	if (files)
-	{
-		/* free previous list */
-		g_list_foreach(files, (GFunc)g_free, NULL);
-		g_list_free(files);
-		files = NULL;
-	}
-
 	exec_sync_command("-file-list-exec-source-files", TRUE, &record);
 	pos = record;
 	while ( (pos = strstr(pos, "fullname=\"")) )
@@ -1435,15 +1441,27 @@ static void update_files(void)
 		*(strchr(pos, '\"')) = '\0';
 		if (!g_hash_table_lookup(ht, pos))
 		{
-			g_hash_table_insert(ht, (gpointer)pos, (gpointer)1);
-			files = g_list_append(files, g_strdup(pos));
+			g_hash_table_insert(ht, (gpointer)g_strdup(pos), (gpointer)1);
 		}
 			
 		pos += strlen(pos) + 1;
 	}
-
-	g_hash_table_destroy(ht);
 	g_free(record);
+
+	/* keep the previous set and generation if nothing has changed */
+	if (files &&
+		g_hash_table_size(files) == g_hash_table_size(ht) &&
+		!g_hash_table_find(ht, hash_table_missing_key, files))
+	{
+		g_hash_table_destroy(ht);
+	}
+	else
+	{
+		if (files)
+			g_hash_table_destroy(files);
+		files = ht;
+		files_generation++;
+	}
 }
 
 /*
@@ -1600,6 +1618,11 @@ static void update_autos(void)
  */
 static GList* get_autos (void)
 {
+	if (autos_outdated)
+	{
+		update_autos();
+		autos_outdated = FALSE;
+	}
 	return g_list_copy(autos);
 }
 
@@ -1608,15 +1631,21 @@ static GList* get_autos (void)
  */
 static GList* get_watches (void)
 {
+	if (watches_outdated)
+	{
+		update_watches();
+		watches_outdated = FALSE;
+	}
 	return g_list_copy(watches);
 }
 
 /*
- * get files list 
+ * get files set (owned by the module) and its generation
  */
-static GList* get_files (void)
+static GHashTable* get_files (guint *generation)
 {
-	return g_list_copy(files);
+	*generation = files_generation;
+	return files;
 }
 
 /*
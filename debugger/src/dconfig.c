@@ -100,6 +100,7 @@ static void debug_load_from_keyfile(GKeyFile *keyfile)
 {
 	gchar *value;
 	int i, count;
+	GList *breaks;
 
 	debug_config_loading = TRUE;
 	
@@ -144,6 +145,7 @@ static void debug_load_from_keyfile(GKeyFile *keyfile)
 
 	/* breakpoints */
 	count = g_key_file_get_integer(keyfile, DEBUGGER_GROUP, "breaks_count", NULL);
+	breaks = NULL;
 	for (i = 0; i < count; i++)
 	{
 		gchar *break_file_id = g_strdup_printf("break_%i_file", i);
@@ -158,7 +160,8 @@ static void debug_load_from_keyfile(GKeyFile *keyfile)
 		int hits_count = g_key_file_get_integer(keyfile, DEBUGGER_GROUP, break_hits_id, NULL);
 		gboolean enabled = g_key_file_get_boolean(keyfile, DEBUGGER_GROUP, break_enabled_id, NULL);
 		
-		breaks_add(file, line, condition, enabled, hits_count);
+		if (file)
+			breaks = g_list_prepend(breaks, break_new_full(file, line, condition, enabled, hits_count));
 
 		g_free(break_file_id);
 		g_free(break_line_id);
@@ -169,7 +172,7 @@ static void debug_load_from_keyfile(GKeyFile *keyfile)
 		g_free(file);
 		g_free(condition);
 	}
-	bptree_update_file_nodes();
+	breaks_add_list(g_list_reverse(breaks));
 
 	debug_config_loading = FALSE;
 }
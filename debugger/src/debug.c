@@ -137,8 +137,22 @@ static GList* stack = NULL;
 
 /*
  * pages which are loaded in debugger and therefore, are set readonly
+ * (real path -> number of debugger source files with that real path)
  */
-static GList *read_only_pages = NULL;
+static GHashTable *read_only_pages = NULL;
+
+/*
+ * debugger source files (-> real path) the readonly pages were set for
+ * and the module's source files generation they correspond to
+ */
+static GHashTable *source_files = NULL;
+static guint source_files_generation = 0;
+
+/*
+ * idle source that fills autos and watches pages after a stop,
+ * once the stack and the current position have been shown
+ */
+static guint variables_source = 0;
 
 /* available modules */
 static module_description modules[] = 
@@ -645,16 +659,157 @@ static void on_debugger_run (void)
 }
 
 
+/* 
+ * sets document with a given real path readonly or writable if it's open
+ */
+static void set_page_readonly(const gchar *real_path, gboolean readonly)
+{
+	GeanyDocument *doc = document_find_by_real_path(real_path);
+	if (doc)
+		scintilla_send_message(doc->editor->sci, SCI_SETREADONLY, readonly, 0);
+}
+
+/* 
+ * syncs readonly pages with debugger source files,
+ * does nothing if source files haven't changed since the last call
+ */
+static void update_read_only_pages(void)
+{
+	guint generation;
+	GHashTable *files = active_module->get_files(&generation);
+	GHashTableIter iter;
+	gpointer file, real_path;
+
+	if (!read_only_pages)
+	{
+		read_only_pages = g_hash_table_new_full(g_str_hash, g_str_equal, (GDestroyNotify)g_free, NULL);
+		source_files = g_hash_table_new_full(g_str_hash, g_str_equal, (GDestroyNotify)g_free, (GDestroyNotify)g_free);
+	}
+	else if (generation == source_files_generation)
+		return;
+
+	source_files_generation = generation;
+
+	/* remove and make writable those files, that are not in the current set */
+	g_hash_table_iter_init(&iter, source_files);
+	while (g_hash_table_iter_next(&iter, &file, &real_path))
+	{
+		if (!files || !g_hash_table_lookup(files, file))
+		{
+			int count = GPOINTER_TO_INT(g_hash_table_lookup(read_only_pages, real_path)) - 1;
+			if (count > 0)
+				g_hash_table_replace(read_only_pages, g_strdup((gchar*)real_path), GINT_TO_POINTER(count));
+			else
+			{
+				set_page_readonly((const gchar*)real_path, FALSE);
+				g_hash_table_remove(read_only_pages, real_path);
+			}
+			g_hash_table_iter_remove(&iter);
+		}
+	}
+
+	/* add and make readonly those files from the current set that are new */
+	if (files)
+	{
+		g_hash_table_iter_init(&iter, files);
+		while (g_hash_table_iter_next(&iter, &file, NULL))
+		{
+			if (!g_hash_table_lookup(source_files, file))
+			{
+				gchar *path = tm_get_real_path((const gchar*)file);
+				int count;
+
+				/* gdb may report files that do not exist locally */
+				if (!path)
+					path = g_strdup((const gchar*)file);
+				count = GPOINTER_TO_INT(g_hash_table_lookup(read_only_pages, path));
+				if (!count)
+					set_page_readonly(path, TRUE);
+				g_hash_table_replace(read_only_pages, g_strdup(path), GINT_TO_POINTER(count + 1));
+				g_hash_table_insert(source_files, g_strdup((gchar*)file), path);
+			}
+		}
+	}
+}
+
+/*
+ * cancels pending autos/watches update
+ */
+static void cancel_variables_update(void)
+{
+	if (variables_source)
+	{
+		g_source_remove(variables_source);
+		variables_source = 0;
+	}
+}
+
+/*
+ * second idle stage of a stop handling - updates watches
+ */
+static gboolean update_watches_idle(gpointer data)
+{
+	GList *watches;
+
+	variables_source = 0;
+
+	/* debugger has been resumed or exited meanwhile */
+	if (DBS_STOPPED != debug_state)
+		return FALSE;
+
+	watches = active_module->get_watches();
+	update_variables(GTK_TREE_VIEW(wtree), NULL, watches);
+
+	return FALSE;
+}
+
+/*
+ * first idle stage of a stop handling - updates autos and
+ * queues watches update, so that the UI is repainted in between
+ */
+static gboolean update_autos_idle(gpointer data)
+{
+	GList *autos;
+
+	variables_source = 0;
+
+	/* debugger has been resumed or exited meanwhile */
+	if (DBS_STOPPED != debug_state)
+		return FALSE;
+
+	autos = active_module->get_autos();
+	update_variables(GTK_TREE_VIEW(atree), NULL, autos);
+
+	variables_source = g_idle_add(update_watches_idle, NULL);
+
+	return FALSE;
+}
+
+/*
+ * schedules autos/watches update, restarting it if one is already pending
+ */
+static void queue_variables_update(void)
+{
+	cancel_variables_update();
+	variables_source = g_idle_add(update_autos_idle, NULL);
+}
+
 /* 
  * called from debug module when debugger is being stopped 
  */
 static void on_debugger_stopped (int thread_id)
 {
-	GList *iter, *files, *autos, *watches;
+	GList *iter;
 
 	/* update debug state */
 	debug_state = DBS_STOPPED;
 
+	/* remove breakpoints whose lines were deleted while running */
+	breaks_remove_pending();
+
+	/* drop autos/watches update left from the previous stop */
+	cancel_variables_update();
+
 	/* update buttons panel state */
 	if (!interrupt_data)
 	{
@@ -697,61 +852,7 @@ static void on_debugger_stopped (int thread_id)
 	stree_select_first_frame(TRUE);
 
 	/* files */
-	files = active_module->get_files();
-	/* remove from list and make writable those files,
-	that are not in the current list */
-	iter = read_only_pages;
-	while (iter)
-	{
-		if (!g_list_find_custom(files, iter->data, (GCompareFunc)g_strcmp0))
-		{
-			GList *next;
-
-			/* set document writable */
-			GeanyDocument *doc = document_find_by_real_path((const gchar*)iter->data);
-			if (doc)
-				scintilla_send_message(doc->editor->sci, SCI_SETREADONLY, 0, 0);
-
-			/* free file name */
-			g_free(iter->data);
-			/* save next item pointer */
-			next = iter->next;
-			/* remove current item */
-			read_only_pages = g_list_delete_link(read_only_pages, iter);
-
-			/* set next item and continue */
-			iter = next;
-			continue;
-		}
-
-		iter = iter->next;
-	}
-	/* add to the list and make readonly those files
-	from the current list that are new */
-	iter = files;
-	while (iter)
-	{
-		if (!g_list_find_custom(read_only_pages, iter->data, (GCompareFunc)g_strcmp0))
-		{
-			/* set document readonly */
-			GeanyDocument *doc = document_find_by_real_path((const gchar*)iter->data);
-			if (doc)
-				scintilla_send_message(doc->editor->sci, SCI_SETREADONLY, 1, 0);
-
-			/* add new file to the list */
-			read_only_pages = g_list_append(read_only_pages, g_strdup((gchar*)iter->data));
-		}
-		iter = iter->next;
-	}
-	g_list_free(files);
-
-	/* autos */
-	autos = active_module->get_autos();
-	update_variables(GTK_TREE_VIEW(atree), NULL, autos);
-	
-	/* watches */
-	watches = active_module->get_watches();
-	update_variables(GTK_TREE_VIEW(wtree), NULL, watches);
+	update_read_only_pages();
 
 	if (stack)
 	{
@@ -773,6 +874,9 @@ static void on_debugger_stopped (int thread_id)
 	/* remove breaks readonly if current module doesn't support run-time breaks operation */
 	if (!(active_module->features & MF_ASYNC_BREAKS))
 		bptree_set_readonly(FALSE);
+
+	/* autos and watches are fetched after the position is shown */
+	queue_variables_update();
 }
 
 /* 
@@ -782,7 +886,9 @@ static void on_debugger_exited (int code)
 {
 	GtkTextIter start, end;
 	GtkTextBuffer *buffer;
-	GList *iter;
+
+	/* drop pending autos/watches update */
+	cancel_variables_update();
 
 	/* remove marker for current instruction if was set */
 	if (stack)
@@ -818,17 +924,21 @@ static void on_debugger_exited (int code)
 		bptree_set_readonly(FALSE);
 	
 	/* set files that was readonly during debug writable */
-	for (iter = read_only_pages; iter; iter = iter->next)
+	if (read_only_pages)
 	{
-		GeanyDocument *doc = document_find_by_real_path((const gchar*)iter->data);
-		if (doc)
-			scintilla_send_message(doc->editor->sci, SCI_SETREADONLY, 0, 0);
-
-		/* free file name */
-		g_free(iter->data);
+		GHashTableIter iter;
+		gpointer real_path;
+
+		g_hash_table_iter_init(&iter, read_only_pages);
+		while (g_hash_table_iter_next(&iter, &real_path, NULL))
+			set_page_readonly((const gchar*)real_path, FALSE);
+
+		g_hash_table_destroy(read_only_pages);
+		read_only_pages = NULL;
+		g_hash_table_destroy(source_files);
+		source_files = NULL;
+		source_files_generation = 0;
 	}
-	g_list_free(read_only_pages);
-	read_only_pages = NULL;
 
 	/* clear and destroy calltips cache */
 	g_hash_table_destroy(calltips);
@@ -842,6 +952,9 @@ static void on_debugger_exited (int code)
 	
 	/* update debug state */
 	debug_state = DBS_IDLE;
+
+	/* remove breakpoints whose lines were deleted while exiting */
+	breaks_remove_pending();
 }
 
 /* 
@@ -921,6 +1034,10 @@ static void on_select_frame(int frame_number)
 {
 	GList *autos, *watches;
 	frame *f = (frame*)g_list_nth(stack, active_module->get_active_frame())->data;
+
+	/* autos and watches are updated below */
+	cancel_variables_update();
+
 	markers_remove_current_instruction(f->file, f->line);
 	markers_add_frame(f->file, f->line);
 
@@ -1052,6 +1169,9 @@ void debug_init(void)
  */
 void debug_destroy(void)
 {
+	/* drop pending autos/watches update */
+	cancel_variables_update();
+
 	/* close PTY file descriptors */
 	close(pty_master);
 	close(pty_slave);
@@ -1389,8 +1509,7 @@ void debug_jump_to_current_instruction(void)
  */
 void debug_on_file_open(GeanyDocument *doc)
 {
-	const gchar *file = DOC_FILENAME(doc);
-	if (g_list_find_custom(read_only_pages, (gpointer)file, (GCompareFunc)g_strcmp0))
+	if (read_only_pages && doc->real_path && g_hash_table_lookup(read_only_pages, doc->real_path))
 		scintilla_send_message(doc->editor->sci, SCI_SETREADONLY, 1, 0);
 }
 
@@ -124,7 +124,7 @@ typedef struct _dbg_module {
 	GList* (*get_autos) (void);
 	GList* (*get_watches) (void);
 	
-	GList* (*get_files) (void);
+	GHashTable* (*get_files) (guint *generation);
 
 	GList* (*get_children) (gchar* path);
 	variable* (*add_watch)(gchar* expression);
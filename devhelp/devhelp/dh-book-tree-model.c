@@ -0,0 +1,517 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 8 -*- */
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#include "config.h"
+#include <gtk/gtk.h>
+
+#include "dh-link.h"
+#include "dh-book.h"
+#include "dh-book-tree-model.h"
+
+/* Exposes the trees of the enabled books as they are, without copying them.
+ * An iter points to the GNode of its row; the top level rows are the roots
+ * of the book trees. */
+
+typedef struct {
+        DhBook *book;
+        GNode  *root;
+} BookRoot;
+
+struct _DhBookTreeModelPriv {
+        DhBookManager *book_manager;
+
+        /* BookRoot of the enabled books, in the book manager order */
+        GArray *roots;
+
+        gint    stamp;
+};
+
+static void dh_book_tree_model_init            (DhBookTreeModel      *model);
+static void dh_book_tree_model_class_init      (DhBookTreeModelClass *klass);
+static void dh_book_tree_model_tree_model_init (GtkTreeModelIface    *iface);
+
+G_DEFINE_TYPE_WITH_CODE (DhBookTreeModel, dh_book_tree_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                dh_book_tree_model_tree_model_init));
+
+#define G_NODE(x) ((GNode *) x)
+#define ROOT(priv, i) (g_array_index ((priv)->roots, BookRoot, (i)))
+
+static void book_tree_model_disabled_book_list_changed_cb (DhBookManager   *book_manager,
+                                                           DhBookTreeModel *model);
+
+static void
+book_tree_model_dispose (GObject *object)
+{
+        DhBookTreeModel     *model = DH_BOOK_TREE_MODEL (object);
+        DhBookTreeModelPriv *priv = model->priv;
+
+        if (priv->book_manager) {
+                g_signal_handlers_disconnect_by_func (priv->book_manager,
+                                                      book_tree_model_disabled_book_list_changed_cb,
+                                                      model);
+                g_object_unref (priv->book_manager);
+                priv->book_manager = NULL;
+        }
+
+        G_OBJECT_CLASS (dh_book_tree_model_parent_class)->dispose (object);
+}
+
+static void
+book_tree_model_finalize (GObject *object)
+{
+        DhBookTreeModel     *model = DH_BOOK_TREE_MODEL (object);
+        DhBookTreeModelPriv *priv = model->priv;
+
+        g_array_free (priv->roots, TRUE);
+
+        g_free (model->priv);
+
+        G_OBJECT_CLASS (dh_book_tree_model_parent_class)->finalize (object);
+}
+
+static void
+dh_book_tree_model_class_init (DhBookTreeModelClass *klass)
+{
+        GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+        object_class->finalize = book_tree_model_finalize;
+        object_class->dispose = book_tree_model_dispose;
+}
+
+static void
+dh_book_tree_model_init (DhBookTreeModel *model)
+{
+        DhBookTreeModelPriv *priv;
+
+        priv = g_new0 (DhBookTreeModelPriv, 1);
+        model->priv = priv;
+
+        priv->roots = g_array_new (FALSE, FALSE, sizeof (BookRoot));
+
+        do {
+                priv->stamp = g_random_int ();
+        } while (priv->stamp == 0);
+}
+
+static void
+book_tree_model_set_iter (DhBookTreeModel *model,
+                          GtkTreeIter     *iter,
+                          GNode           *node)
+{
+        iter->stamp = model->priv->stamp;
+        iter->user_data = node;
+}
+
+static gint
+book_tree_model_root_position (DhBookTreeModelPriv *priv,
+                               GNode               *root)
+{
+        guint i;
+
+        for (i = 0; i < priv->roots->len; i++) {
+                if (ROOT (priv, i).root == root) {
+                        return i;
+                }
+        }
+
+        return -1;
+}
+
+static GtkTreeModelFlags
+book_tree_model_get_flags (GtkTreeModel *tree_model)
+{
+        return GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+static gint
+book_tree_model_get_n_columns (GtkTreeModel *tree_model)
+{
+        return DH_BOOK_TREE_MODEL_NUM_COLS;
+}
+
+static GType
+book_tree_model_get_column_type (GtkTreeModel *tree_model,
+                                 gint          column)
+{
+        switch (column) {
+        case DH_BOOK_TREE_MODEL_COL_TITLE:
+                return G_TYPE_STRING;
+        case DH_BOOK_TREE_MODEL_COL_LINK:
+                return G_TYPE_POINTER;
+        case DH_BOOK_TREE_MODEL_COL_WEIGHT:
+                return PANGO_TYPE_WEIGHT;
+        default:
+                return G_TYPE_INVALID;
+        }
+}
+
+static gboolean
+book_tree_model_get_iter (GtkTreeModel *tree_model,
+                          GtkTreeIter  *iter,
+                          GtkTreePath  *path)
+{
+        DhBookTreeModel     *model = DH_BOOK_TREE_MODEL (tree_model);
+        DhBookTreeModelPriv *priv = model->priv;
+        GNode               *node;
+        const gint          *indices;
+        gint                 depth, i;
+
+        indices = gtk_tree_path_get_indices (path);
+        depth = gtk_tree_path_get_depth (path);
+
+        if (indices == NULL || depth == 0) {
+                return FALSE;
+        }
+
+        if (indices[0] < 0 || indices[0] >= (gint) priv->roots->len) {
+                return FALSE;
+        }
+
+        node = ROOT (priv, indices[0]).root;
+        for (i = 1; node && i < depth; i++) {
+                node = g_node_nth_child (node, indices[i]);
+        }
+
+        if (!node) {
+                return FALSE;
+        }
+
+        book_tree_model_set_iter (model, iter, node);
+
+        return TRUE;
+}
+
+static GtkTreePath *
+book_tree_model_get_path (GtkTreeModel *tree_model,
+                          GtkTreeIter  *iter)
+{
+        DhBookTreeModel     *model = DH_BOOK_TREE_MODEL (tree_model);
+        DhBookTreeModelPriv *priv = model->priv;
+        GtkTreePath         *path;
+        GNode               *node;
+        gint                 i;
+
+        g_return_val_if_fail (iter->stamp == priv->stamp, NULL);
+
+        path = gtk_tree_path_new ();
+
+        for (node = iter->user_data; node->parent; node = node->parent) {
+                gtk_tree_path_prepend_index (path,
+                                             g_node_child_position (node->parent, node));
+        }
+
+        i = book_tree_model_root_position (priv, node);
+        if (i < 0) {
+                gtk_tree_path_free (path);
+                return NULL;
+        }
+        gtk_tree_path_prepend_index (path, i);
+
+        return path;
+}
+
+static void
+book_tree_model_get_value (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter,
+                           gint          column,
+                           GValue       *value)
+{
+        DhLink *link;
+
+        link = G_NODE (iter->user_data)->data;
+
+        switch (column) {
+        case DH_BOOK_TREE_MODEL_COL_TITLE:
+                g_value_init (value, G_TYPE_STRING);
+                g_value_set_string (value, dh_link_get_name (link));
+                break;
+        case DH_BOOK_TREE_MODEL_COL_LINK:
+                g_value_init (value, G_TYPE_POINTER);
+                g_value_set_pointer (value, link);
+                break;
+        case DH_BOOK_TREE_MODEL_COL_WEIGHT:
+                g_value_init (value, PANGO_TYPE_WEIGHT);
+                g_value_set_enum (value,
+                                  dh_link_get_link_type (link) == DH_LINK_TYPE_BOOK ?
+                                  PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL);
+                break;
+        default:
+                g_warning ("Bad column %d requested", column);
+        }
+}
+
+static gboolean
+book_tree_model_iter_next (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter)
+{
+        DhBookTreeModel     *model = DH_BOOK_TREE_MODEL (tree_model);
+        DhBookTreeModelPriv *priv = model->priv;
+        GNode               *node = iter->user_data;
+        gint                 i;
+
+        g_return_val_if_fail (priv->stamp == iter->stamp, FALSE);
+
+        if (node->parent) {
+                iter->user_data = node->next;
+                return (iter->user_data != NULL);
+        }
+
+        i = book_tree_model_root_position (priv, node);
+        if (i < 0 || i + 1 >= (gint) priv->roots->len) {
+                iter->user_data = NULL;
+                return FALSE;
+        }
+
+        iter->user_data = ROOT (priv, i + 1).root;
+        return TRUE;
+}
+
+static gboolean
+book_tree_model_iter_children (GtkTreeModel *tree_model,
+                               GtkTreeIter  *iter,
+                               GtkTreeIter  *parent)
+{
+        DhBookTreeModel     *model = DH_BOOK_TREE_MODEL (tree_model);
+        DhBookTreeModelPriv *priv = model->priv;
+        GNode               *child;
+
+        if (parent) {
+                g_return_val_if_fail (priv->stamp == parent->stamp, FALSE);
+                child = G_NODE (parent->user_data)->children;
+        } else {
+                child = priv->roots->len > 0 ? ROOT (priv, 0).root : NULL;
+        }
+
+        if (child) {
+                book_tree_model_set_iter (model, iter, child);
+                return TRUE;
+        }
+
+        return FALSE;
+}
+
+static gboolean
+book_tree_model_iter_has_child (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter)
+{
+        return G_NODE (iter->user_data)->children != NULL;
+}
+
+static gint
+book_tree_model_iter_n_children (GtkTreeModel *tree_model,
+                                 GtkTreeIter  *iter)
+{
+        DhBookTreeModelPriv *priv;
+
+        priv = DH_BOOK_TREE_MODEL (tree_model)->priv;
+
+        if (iter == NULL) {
+                return priv->roots->len;
+        }
+
+        g_return_val_if_fail (priv->stamp == iter->stamp, -1);
+
+        return g_node_n_children (iter->user_data);
+}
+
+static gboolean
+book_tree_model_iter_nth_child (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter,
+                                GtkTreeIter  *parent,
+                                gint          n)
+{
+        DhBookTreeModel     *model = DH_BOOK_TREE_MODEL (tree_model);
+        DhBookTreeModelPriv *priv = model->priv;
+        GNode               *child = NULL;
+
+        if (parent) {
+                g_return_val_if_fail (priv->stamp == parent->stamp, FALSE);
+                child = g_node_nth_child (parent->user_data, n);
+        } else if (n >= 0 && n < (gint) priv->roots->len) {
+                child = ROOT (priv, n).root;
+        }
+
+        if (child) {
+                book_tree_model_set_iter (model, iter, child);
+                return TRUE;
+        }
+
+        return FALSE;
+}
+
+static gboolean
+book_tree_model_iter_parent (GtkTreeModel *tree_model,
+                             GtkTreeIter  *iter,
+                             GtkTreeIter  *child)
+{
+        DhBookTreeModel *model = DH_BOOK_TREE_MODEL (tree_model);
+        GNode           *node = G_NODE (child->user_data)->parent;
+
+        g_return_val_if_fail (model->priv->stamp == child->stamp, FALSE);
+
+        if (node) {
+                book_tree_model_set_iter (model, iter, node);
+                return TRUE;
+        }
+
+        return FALSE;
+}
+
+static void
+dh_book_tree_model_tree_model_init (GtkTreeModelIface *iface)
+{
+        iface->get_flags       = book_tree_model_get_flags;
+        iface->get_n_columns   = book_tree_model_get_n_columns;
+        iface->get_column_type = book_tree_model_get_column_type;
+        iface->get_iter        = book_tree_model_get_iter;
+        iface->get_path        = book_tree_model_get_path;
+        iface->get_value       = book_tree_model_get_value;
+        iface->iter_next       = book_tree_model_iter_next;
+        iface->iter_children   = book_tree_model_iter_children;
+        iface->iter_has_child  = book_tree_model_iter_has_child;
+        iface->iter_n_children = book_tree_model_iter_n_children;
+        iface->iter_nth_child  = book_tree_model_iter_nth_child;
+        iface->iter_parent     = book_tree_model_iter_parent;
+}
+
+static void
+book_tree_model_insert_root (DhBookTreeModel *model,
+                             guint            i,
+                             DhBook          *book)
+{
+        DhBookTreeModelPriv *priv = model->priv;
+        BookRoot             root;
+        GtkTreePath         *path;
+        GtkTreeIter          iter;
+
+        root.book = book;
+        root.root = dh_book_get_tree (book);
+        g_array_insert_val (priv->roots, i, root);
+
+        path = gtk_tree_path_new_from_indices (i, -1);
+        book_tree_model_set_iter (model, &iter, root.root);
+        gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+        if (root.root->children) {
+                gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (model),
+                                                      path, &iter);
+        }
+        gtk_tree_path_free (path);
+}
+
+static void
+book_tree_model_remove_root (DhBookTreeModel *model,
+                             guint            i)
+{
+        GtkTreePath *path;
+
+        g_array_remove_index (model->priv->roots, i);
+
+        path = gtk_tree_path_new_from_indices (i, -1);
+        gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+        gtk_tree_path_free (path);
+}
+
+/* Brings the top level rows in line with the enabled books, only inserting
+ * and removing the rows of the books which were enabled or disabled. */
+static void
+book_tree_model_update_roots (DhBookTreeModel *model)
+{
+        DhBookTreeModelPriv *priv = model->priv;
+        GList               *l;
+        guint                i = 0;
+
+        for (l = dh_book_manager_get_books (priv->book_manager);
+             l;
+             l = g_list_next (l)) {
+                DhBook  *book = DH_BOOK (l->data);
+                gboolean enabled = dh_book_get_tree (book) != NULL;
+
+                if (i < priv->roots->len && ROOT (priv, i).book == book) {
+                        if (enabled) {
+                                i++;
+                        } else {
+                                book_tree_model_remove_root (model, i);
+                        }
+                } else if (enabled) {
+                        book_tree_model_insert_root (model, i, book);
+                        i++;
+                }
+        }
+
+        while (priv->roots->len > i) {
+                book_tree_model_remove_root (model, priv->roots->len - 1);
+        }
+}
+
+static void
+book_tree_model_disabled_book_list_changed_cb (DhBookManager   *book_manager,
+                                               DhBookTreeModel *model)
+{
+        book_tree_model_update_roots (model);
+}
+
+DhBookTreeModel *
+dh_book_tree_model_new (DhBookManager *book_manager)
+{
+        DhBookTreeModel *model;
+
+        g_return_val_if_fail (DH_IS_BOOK_MANAGER (book_manager), NULL);
+
+        model = g_object_new (DH_TYPE_BOOK_TREE_MODEL, NULL);
+
+        model->priv->book_manager = g_object_ref (book_manager);
+        g_signal_connect (book_manager,
+                          "disabled-book-list-updated",
+                          G_CALLBACK (book_tree_model_disabled_book_list_changed_cb),
+                          model);
+
+        book_tree_model_update_roots (model);
+
+        return model;
+}
+
+/* Sets iter to the first row, in the order of the rows, whose URI is the
+ * given URI or the given URI without its anchor. Only the books are
+ * looked at, through their URI index, not every row. */
+gboolean
+dh_book_tree_model_find_uri (DhBookTreeModel *model,
+                             const gchar     *uri,
+                             GtkTreeIter     *iter)
+{
+        DhBookTreeModelPriv *priv;
+        guint                i;
+
+        g_return_val_if_fail (DH_IS_BOOK_TREE_MODEL (model), FALSE);
+        g_return_val_if_fail (uri != NULL, FALSE);
+
+        priv = model->priv;
+
+        for (i = 0; i < priv->roots->len; i++) {
+                GNode *node;
+
+                node = dh_book_find_uri (ROOT (priv, i).book, uri);
+                if (node) {
+                        book_tree_model_set_iter (model, iter, node);
+                        return TRUE;
+                }
+        }
+
+        return FALSE;
+}
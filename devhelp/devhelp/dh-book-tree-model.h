@@ -0,0 +1,65 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 8 -*- */
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __DH_BOOK_TREE_MODEL_H__
+#define __DH_BOOK_TREE_MODEL_H__
+
+#include <gtk/gtk.h>
+#include "dh-book-manager.h"
+
+G_BEGIN_DECLS
+
+#define DH_TYPE_BOOK_TREE_MODEL            (dh_book_tree_model_get_type ())
+#define DH_BOOK_TREE_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), DH_TYPE_BOOK_TREE_MODEL, DhBookTreeModel))
+#define DH_BOOK_TREE_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), DH_TYPE_BOOK_TREE_MODEL, DhBookTreeModelClass))
+#define DH_IS_BOOK_TREE_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), DH_TYPE_BOOK_TREE_MODEL))
+#define DH_IS_BOOK_TREE_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), DH_TYPE_BOOK_TREE_MODEL))
+#define DH_BOOK_TREE_MODEL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), DH_TYPE_BOOK_TREE_MODEL, DhBookTreeModelClass))
+
+typedef struct _DhBookTreeModel      DhBookTreeModel;
+typedef struct _DhBookTreeModelClass DhBookTreeModelClass;
+typedef struct _DhBookTreeModelPriv  DhBookTreeModelPriv;
+
+struct _DhBookTreeModel
+{
+        GObject              parent_instance;
+        DhBookTreeModelPriv *priv;
+};
+
+struct _DhBookTreeModelClass
+{
+        GObjectClass parent_class;
+};
+
+enum {
+        DH_BOOK_TREE_MODEL_COL_TITLE,
+        DH_BOOK_TREE_MODEL_COL_LINK,
+        DH_BOOK_TREE_MODEL_COL_WEIGHT,
+        DH_BOOK_TREE_MODEL_NUM_COLS
+};
+
+GType            dh_book_tree_model_get_type (void);
+DhBookTreeModel *dh_book_tree_model_new      (DhBookManager   *book_manager);
+gboolean         dh_book_tree_model_find_uri (DhBookTreeModel *model,
+                                              const gchar     *uri,
+                                              GtkTreeIter     *iter);
+
+G_END_DECLS
+
+#endif /* __DH_BOOK_TREE_MODEL_H__ */
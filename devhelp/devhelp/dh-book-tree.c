@@ -27,29 +27,18 @@
 
 #include "dh-marshal.h"
 #include "dh-book-tree.h"
+#include "dh-book-tree-model.h"
 #include "dh-book.h"
 
 typedef struct {
-        const gchar *uri;
-        gboolean     found;
-        GtkTreeIter  iter;
-        GtkTreePath *path;
-} FindURIData;
-
-typedef struct {
-        GtkTreeStore  *store;
-        DhBookManager *book_manager;
-        DhLink        *selected_link;
+        DhBookTreeModel *model;
+        DhLink          *selected_link;
 } DhBookTreePriv;
 
 static void dh_book_tree_class_init        (DhBookTreeClass  *klass);
 static void dh_book_tree_init              (DhBookTree       *tree);
 static void book_tree_add_columns          (DhBookTree       *tree);
 static void book_tree_setup_selection      (DhBookTree       *tree);
-static void book_tree_populate_tree        (DhBookTree       *tree);
-static void book_tree_insert_node          (DhBookTree       *tree,
-                                            GNode            *node,
-                                            GtkTreeIter      *parent_iter);
 static void book_tree_selection_changed_cb (GtkTreeSelection *selection,
                                             DhBookTree       *tree);
 
@@ -58,13 +47,6 @@ enum {
         LAST_SIGNAL
 };
 
-enum {
-	COL_TITLE,
-	COL_LINK,
-	COL_WEIGHT,
-	N_COLUMNS
-};
-
 G_DEFINE_TYPE (DhBookTree, dh_book_tree, GTK_TYPE_TREE_VIEW);
 
 #define GET_PRIVATE(instance) G_TYPE_INSTANCE_GET_PRIVATE \
@@ -77,8 +59,9 @@ book_tree_finalize (GObject *object)
 {
 	DhBookTreePriv *priv = GET_PRIVATE (object);
 
-	g_object_unref (priv->store);
-        g_object_unref (priv->book_manager);
+	if (priv->model) {
+		g_object_unref (priv->model);
+	}
 
         G_OBJECT_CLASS (dh_book_tree_parent_class)->finalize (object);
 }
@@ -110,13 +93,8 @@ dh_book_tree_init (DhBookTree *tree)
 
         priv = GET_PRIVATE (tree);
 
-	priv->store = gtk_tree_store_new (N_COLUMNS,
-					  G_TYPE_STRING,
-					  G_TYPE_POINTER,
-                                          PANGO_TYPE_WEIGHT);
+	priv->model = NULL;
 	priv->selected_link = NULL;
-	gtk_tree_view_set_model (GTK_TREE_VIEW (tree),
-				 GTK_TREE_MODEL (priv->store));
 
 	gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (tree), FALSE);
 
@@ -139,8 +117,8 @@ book_tree_add_columns (DhBookTree *tree)
 		      NULL);
 	gtk_tree_view_column_pack_start (column, cell, TRUE);
 	gtk_tree_view_column_set_attributes (column, cell,
-					     "text", COL_TITLE,
-                                             "weight", COL_WEIGHT,
+					     "text", DH_BOOK_TREE_MODEL_COL_TITLE,
+                                             "weight", DH_BOOK_TREE_MODEL_COL_WEIGHT,
 					     NULL);
 
 	gtk_tree_view_append_column (GTK_TREE_VIEW (tree), column);
@@ -160,71 +138,6 @@ book_tree_setup_selection (DhBookTree *tree)
 			  tree);
 }
 
-static void
-book_tree_populate_tree (DhBookTree *tree)
-{
-        DhBookTreePriv *priv = GET_PRIVATE (tree);
-        GList          *l;
-
-        gtk_tree_store_clear (priv->store);
-
-        for (l = dh_book_manager_get_books (priv->book_manager);
-             l;
-             l = g_list_next (l)) {
-                DhBook *book = DH_BOOK (l->data);
-                GNode  *node;
-
-                node = dh_book_get_tree (book);
-                while(node) {
-                        book_tree_insert_node (tree, node, NULL);
-                        node = g_node_next_sibling (node);
-                }
-        }
-}
-
-static void
-book_manager_disabled_book_list_changed_cb (DhBookManager *book_manager,
-                                            gpointer user_data)
-{
-        DhBookTree *tree = user_data;
-        book_tree_populate_tree (tree);
-}
-
-static void
-book_tree_insert_node (DhBookTree  *tree,
-		       GNode       *node,
-		       GtkTreeIter *parent_iter)
-
-{
-        DhBookTreePriv *priv = GET_PRIVATE (tree);
-	DhLink         *link;
-	GtkTreeIter     iter;
-        PangoWeight     weight;
-	GNode          *child;
-
-	link = node->data;
-
-	gtk_tree_store_append (priv->store, &iter, parent_iter);
-
-	if (dh_link_get_link_type (link) == DH_LINK_TYPE_BOOK) {
-                weight = PANGO_WEIGHT_BOLD;
-	} else {
-                weight = PANGO_WEIGHT_NORMAL;
-        }
-
-        gtk_tree_store_set (priv->store, &iter,
-                            COL_TITLE, dh_link_get_name (link),
-                            COL_LINK, link,
-                            COL_WEIGHT, weight,
-                            -1);
-
-	for (child = g_node_first_child (node);
-	     child;
-	     child = g_node_next_sibling (child)) {
-		book_tree_insert_node (tree, child, &iter);
-	}
-}
-
 static void
 book_tree_selection_changed_cb (GtkTreeSelection *selection,
 				DhBookTree       *tree)
@@ -235,9 +148,9 @@ book_tree_selection_changed_cb (GtkTreeSelection *selection,
 	if (gtk_tree_selection_get_selected (selection, NULL, &iter)) {
                 DhLink *link;
 
-		gtk_tree_model_get (GTK_TREE_MODEL (priv->store),
+		gtk_tree_model_get (GTK_TREE_MODEL (priv->model),
 				    &iter,
-                                    COL_LINK, &link,
+                                    DH_BOOK_TREE_MODEL_COL_LINK, &link,
                                     -1);
 		if (link != priv->selected_link) {
 			g_signal_emit (tree, signals[LINK_SELECTED], 0, link);
@@ -258,13 +171,11 @@ dh_book_tree_new (DhBookManager *book_manager)
 	tree = g_object_new (DH_TYPE_BOOK_TREE, NULL);
         priv = GET_PRIVATE (tree);
 
-        priv->book_manager = g_object_ref (book_manager);
-        g_signal_connect (priv->book_manager,
-                          "disabled-book-list-updated",
-                          G_CALLBACK (book_manager_disabled_book_list_changed_cb),
-                          tree);
-
-        book_tree_populate_tree (tree);
+        /* The model only exposes the book trees, the rows are not copied
+         * and enabling or disabling a book only touches its own row. */
+        priv->model = dh_book_tree_model_new (book_manager);
+	gtk_tree_view_set_model (GTK_TREE_VIEW (tree),
+				 GTK_TREE_MODEL (priv->model));
 
 	/* Mark the first item as selected, or it would get automatically
 	 * selected when the treeview will get focus; but that's not even
@@ -277,11 +188,12 @@ dh_book_tree_new (DhBookManager *book_manager)
 	g_signal_handlers_block_by_func	(selection,
 					 book_tree_selection_changed_cb,
 					 tree);
-	gtk_tree_model_get_iter_first ( GTK_TREE_MODEL (priv->store), &iter);
-	gtk_tree_model_get (GTK_TREE_MODEL (priv->store),
-			&iter, COL_LINK, &link, -1);
-	priv->selected_link = link;
-	gtk_tree_selection_select_iter (selection, &iter);
+	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->model), &iter)) {
+		gtk_tree_model_get (GTK_TREE_MODEL (priv->model),
+				    &iter, DH_BOOK_TREE_MODEL_COL_LINK, &link, -1);
+		priv->selected_link = link;
+		gtk_tree_selection_select_iter (selection, &iter);
+	}
 	g_signal_handlers_unblock_by_func (selection,
 					   book_tree_selection_changed_cb,
 					   tree);
@@ -289,64 +201,36 @@ dh_book_tree_new (DhBookManager *book_manager)
         return GTK_WIDGET (tree);
 }
 
-static gboolean
-book_tree_find_uri_foreach (GtkTreeModel *model,
-			    GtkTreePath  *path,
-			    GtkTreeIter  *iter,
-			    FindURIData  *data)
-{
-	DhLink      *link;
-        gchar       *link_uri;
-
-	gtk_tree_model_get (model, iter,
-			    COL_LINK, &link,
-			    -1);
-
-        link_uri = dh_link_get_uri (link);
-	if (g_str_has_prefix (data->uri, link_uri)) {
-		data->found = TRUE;
-		data->iter = *iter;
-		data->path = gtk_tree_path_copy (path);
-	}
-        g_free (link_uri);
-
-	return data->found;
-}
-
 void
 dh_book_tree_select_uri (DhBookTree  *tree,
 			 const gchar *uri)
 {
         DhBookTreePriv   *priv = GET_PRIVATE (tree);
 	GtkTreeSelection *selection;
-	FindURIData       data;
-
-	data.found = FALSE;
-	data.uri = uri;
-
-	gtk_tree_model_foreach (GTK_TREE_MODEL (priv->store),
-				(GtkTreeModelForeachFunc) book_tree_find_uri_foreach,
-				&data);
+	GtkTreeIter       iter;
+	GtkTreePath      *path;
 
-	if (!data.found) {
+	if (!dh_book_tree_model_find_uri (priv->model, uri, &iter)) {
 		return;
 	}
 
+	path = gtk_tree_model_get_path (GTK_TREE_MODEL (priv->model), &iter);
+
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (tree));
 
 	g_signal_handlers_block_by_func	(selection,
 					 book_tree_selection_changed_cb,
 					 tree);
 
-	gtk_tree_view_expand_to_path (GTK_TREE_VIEW (tree), data.path);
-	gtk_tree_selection_select_iter (selection, &data.iter);
-	gtk_tree_view_set_cursor (GTK_TREE_VIEW (tree), data.path, NULL, 0);
+	gtk_tree_view_expand_to_path (GTK_TREE_VIEW (tree), path);
+	gtk_tree_selection_select_iter (selection, &iter);
+	gtk_tree_view_set_cursor (GTK_TREE_VIEW (tree), path, NULL, 0);
 
 	g_signal_handlers_unblock_by_func (selection,
 					   book_tree_selection_changed_cb,
 					   tree);
 
-	gtk_tree_path_free (data.path);
+	gtk_tree_path_free (path);
 }
 
 const gchar *
@@ -378,7 +262,7 @@ dh_book_tree_get_selected_book_title (DhBookTree *tree)
 	gtk_tree_path_free (path);
 
 	gtk_tree_model_get (model, &iter,
-			    COL_LINK, &link,
+			    DH_BOOK_TREE_MODEL_COL_LINK, &link,
 			    -1);
 
 	return dh_link_get_name (link);
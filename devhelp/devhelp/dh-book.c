@@ -42,6 +42,10 @@ typedef struct {
         GNode    *tree;
         /* Generated list of keywords in the book */
         GList    *keywords;
+        /* Nodes of the book tree in pre-order */
+        GPtrArray  *nodes;
+        /* URI of a node -> position of its first node in nodes, plus one */
+        GHashTable *uri_index;
 } DhBookPriv;
 
 G_DEFINE_TYPE (DhBook, dh_book, G_TYPE_OBJECT);
@@ -77,6 +81,11 @@ book_finalize (GObject *object)
                 g_list_free (priv->keywords);
         }
 
+        if (priv->uri_index) {
+                g_hash_table_destroy (priv->uri_index);
+                g_ptr_array_free (priv->nodes, TRUE);
+        }
+
         g_free (priv->title);
 
         g_free (priv->path);
@@ -105,6 +114,8 @@ dh_book_init (DhBook *book)
         priv->enabled = TRUE;
         priv->tree = NULL;
         priv->keywords = NULL;
+        priv->nodes = NULL;
+        priv->uri_index = NULL;
 }
 
 static void
@@ -177,6 +188,84 @@ dh_book_get_tree (DhBook *book)
         return priv->enabled ? priv->tree : NULL;
 }
 
+static gboolean
+book_index_node (GNode      *node,
+                 DhBookPriv *priv)
+{
+        gchar *uri;
+
+        g_ptr_array_add (priv->nodes, node);
+
+        uri = dh_link_get_uri (node->data);
+        if (g_hash_table_lookup (priv->uri_index, uri)) {
+                g_free (uri);
+        } else {
+                g_hash_table_insert (priv->uri_index, uri,
+                                     GUINT_TO_POINTER (priv->nodes->len));
+        }
+
+        return FALSE;
+}
+
+static guint
+book_lookup_uri (DhBookPriv  *priv,
+                 const gchar *uri)
+{
+        return GPOINTER_TO_UINT (g_hash_table_lookup (priv->uri_index, uri));
+}
+
+/* Returns the first node of the tree, in pre-order, whose URI is the given
+ * URI or the given URI without its anchor. */
+GNode *
+dh_book_find_uri (DhBook      *book,
+                  const gchar *uri)
+{
+        DhBookPriv  *priv;
+        const gchar *anchor;
+        guint        pos;
+
+        g_return_val_if_fail (DH_IS_BOOK (book), NULL);
+        g_return_val_if_fail (uri != NULL, NULL);
+
+        priv = GET_PRIVATE (book);
+
+        if (!priv->enabled) {
+                return NULL;
+        }
+
+        if (!priv->uri_index) {
+                priv->nodes = g_ptr_array_new ();
+                priv->uri_index = g_hash_table_new_full (g_str_hash,
+                                                         g_str_equal,
+                                                         g_free,
+                                                         NULL);
+                g_node_traverse (priv->tree,
+                                 G_PRE_ORDER,
+                                 G_TRAVERSE_ALL,
+                                 -1,
+                                 (GNodeTraverseFunc)book_index_node,
+                                 priv);
+        }
+
+        pos = book_lookup_uri (priv, uri);
+
+        anchor = strchr (uri, '#');
+        if (anchor) {
+                gchar *page_uri;
+                guint  page_pos;
+
+                page_uri = g_strndup (uri, anchor - uri);
+                page_pos = book_lookup_uri (priv, page_uri);
+                g_free (page_uri);
+
+                if (page_pos && (!pos || page_pos < pos)) {
+                        pos = page_pos;
+                }
+        }
+
+        return pos ? g_ptr_array_index (priv->nodes, pos - 1) : NULL;
+}
+
 const gchar *
 dh_book_get_name (DhBook *book)
 {
@@ -50,6 +50,8 @@ GType        dh_book_get_type     (void) G_GNUC_CONST;
 DhBook      *dh_book_new          (const gchar  *book_path);
 GList       *dh_book_get_keywords (DhBook *book);
 GNode       *dh_book_get_tree     (DhBook *book);
+GNode       *dh_book_find_uri     (DhBook      *book,
+                                   const gchar *uri);
 const gchar *dh_book_get_name     (DhBook *book);
 const gchar *dh_book_get_title    (DhBook *book);
 gboolean     dh_book_get_enabled  (DhBook *book);
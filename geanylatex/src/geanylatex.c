@@ -70,6 +70,7 @@ static GtkWidget *menu_latex_insert_command = NULL;
 static GtkWidget *menu_latex_replacement = NULL;
 static GtkWidget *menu_latex_replacement_submenu = NULL;
 static GtkWidget *menu_latex_replace_selection = NULL;
+static GtkWidget *menu_latex_replace_commands = NULL;
 static GtkWidget *menu_latex_replace_toggle = NULL;
 static GtkWidget *menu_latex_toolbar_wizard = NULL;
 
@@ -88,9 +89,6 @@ static gboolean glatex_wizard_to_generic_toolbar = FALSE;
 /* We want to keep this deactivated by default as the
  * user needs to know what he is doing here.... */
 static gboolean glatex_autocompletion_active = FALSE;
-/* Value how many line should be search for autocompletion of \end{}
- * and \endgroup{}. */
-static gint glatex_autocompletion_context_size;
 static gboolean glatex_autocompletion_only_for_latex;
 gboolean glatex_autobraces_active = TRUE;
 gboolean glatex_lowercase_on_smallcaps = FALSE;
@@ -521,6 +519,10 @@ static gboolean on_editor_notify(G_GNUC_UNUSED GObject *object, GeanyEditor *edi
 
 	g_return_val_if_fail(editor != NULL, FALSE);
 	sci = editor->sci;
+
+	if (nt->nmhdr.code == SCN_MODIFIED)
+		glatex_env_index_update(editor->document, nt);
+
 	/* Autocompletion for LaTeX specific stuff:
 	 * Introducing \end{} or \endgroup{} after a \begin{}
 
@@ -597,28 +599,12 @@ static gboolean on_editor_notify(G_GNUC_UNUSED GObject *object, GeanyEditor *edi
 									break;
 								}
 							}
-							/* Search whether the environment is closed within the next
-							 * lines. We assume, no \end is needed in such cases */
-							/* TODO using sci_find_text() should be way faster than getting
-							 *	  the line buffer and performing string comparisons */
-							for (i = 1; i < glatex_autocompletion_context_size; i++)
+							/* Nothing needs to be done if the environment
+							 * is already closed somewhere */
+							if (glatex_env_index_is_closed(editor->document, line))
 							{
-								gchar *tmp;
-								gchar *end_construct;
-								tmp = sci_get_line(sci, line + i);
-
-								end_construct = g_strdup_printf("\\end%s{%s}", full_cmd, env);
-								if (strstr(tmp, end_construct) != NULL)
-								{
-									/* Clean up everything and quit as nothing
-									 * needs to be done */
-									g_free(tmp);
-									g_free(buf);
-									g_free(end_construct);
-									return FALSE;
-								}
-								g_free(tmp);
-								g_free(end_construct);
+								g_free(buf);
+								return FALSE;
 							}
 
 							/* After we have this, we need to ensure basic
@@ -779,6 +765,7 @@ static void on_document_close(G_GNUC_UNUSED GObject *obj, GeanyDocument *doc,
 {
 	g_return_if_fail(doc != NULL);
 
+	glatex_env_index_remove(doc);
 	if (doc->index < 2)
 		deactivate_toolbar_items();
 	if (doc->index < 1 &&
@@ -1965,6 +1952,12 @@ static void init_keybindings(void)
 	keybindings_set_item(key_group, KB_LATEX_REPLACE_SPECIAL_CHARS,
 		glatex_kb_replace_special_chars, 0, 0, "latex_replace_chars",
 		_("Replace special characters"), NULL);
+	keybindings_set_item(key_group, KB_LATEX_REPLACE_LATEX_COMMANDS,
+		glatex_kb_replace_latex_commands, 0, 0, "latex_replace_commands",
+		_("Replace TeX substitutes with special characters"), NULL);
+	keybindings_set_item(key_group, KB_LATEX_GOTO_MATCHING_ENVIRONMENT,
+		glatex_kb_goto_matching_environment, 0, 0, "latex_goto_matching_environment",
+		_("Go to matching \\begin or \\end"), NULL);
 	keybindings_set_item(key_group, KB_LATEX_ENVIRONMENT_INSERT,
 		glatex_kbref_insert_environment, 0, 0, "latex_insert_environment",
 		_("Run insert environment dialog"), menu_latex_insert_environment);
@@ -2039,21 +2032,6 @@ static void glatex_init_configuration(void)
 		"glatex_lowercase_on_smallcaps", FALSE);
 
 	/* Hidden preferences. Can be set directly via configuration file*/
-	glatex_autocompletion_context_size = utils_get_setting_integer(config, "autocompletion",
-		"glatex_set_autocompletion_contextsize", 5);
-
-	/* Doing some input validation */
-	if (glatex_autocompletion_active == TRUE &&
-		glatex_autocompletion_context_size <= 0)
-	{
-		glatex_autocompletion_context_size = 5;
-		g_warning(_("glatex_set_autocompletion_contextsize has been "
-					"initialized with an invalid value. Default value taken. "
-					"Please check your configuration file"));
-	}
-	/* Increase value by an offset as we add a new line so 2 really means 2 */
-	glatex_autocompletion_context_size = glatex_autocompletion_context_size + 2;
-
 	glatex_autocompletion_only_for_latex = utils_get_setting_boolean(config, "autocompletion",
 		"glatex_autocompletion_only_for_latex", TRUE);
 	glatex_capitalize_sentence_starts = utils_get_setting_boolean(config, "autocompletion",
@@ -2232,12 +2210,24 @@ add_menu_to_menubar(void)
 		menu_latex_replace_selection = gtk_menu_item_new_with_mnemonic(
 			_("Bulk _Replace Special Characters"));
 		ui_widget_set_tooltip_text(menu_latex_replace_selection,
-			_("_Replace selected special characters with TeX substitutes"));
+			_("Replace special characters of the selection or, without a "
+			  "selection, of the whole document with TeX substitutes"));
 		gtk_container_add(GTK_CONTAINER(menu_latex_replacement_submenu),
 			menu_latex_replace_selection);
 		g_signal_connect(menu_latex_replace_selection, "activate",
 			G_CALLBACK(glatex_replace_special_character), NULL);
 
+		/* Add menuitem for the reverse bulk replacement */
+		menu_latex_replace_commands = gtk_menu_item_new_with_mnemonic(
+			_("Replace TeX Substitutes with _Characters"));
+		ui_widget_set_tooltip_text(menu_latex_replace_commands,
+			_("Replace TeX substitutes of the selection or, without a "
+			  "selection, of the whole document with the special characters"));
+		gtk_container_add(GTK_CONTAINER(menu_latex_replacement_submenu),
+			menu_latex_replace_commands);
+		g_signal_connect(menu_latex_replace_commands, "activate",
+			G_CALLBACK(glatex_replace_latex_commands_with_characters), NULL);
+
 		/* Add menu entry for toggling input replacment */
 		menu_latex_replace_toggle = gtk_check_menu_item_new_with_mnemonic(
 			_("Toggle _Special Character Replacement"));
@@ -2418,4 +2408,6 @@ plugin_cleanup(void)
 	g_free(glatex_ref_chapter_string);
 	g_free(glatex_ref_page_string);
 	g_free(glatex_ref_all_string);
+	glatex_free_entities();
+	glatex_env_index_free_all();
 }
@@ -35,6 +35,7 @@
 #include "latexutils.h"
 #include "reftex.h"
 #include "latexenvironments.h"
+#include "latexenvindex.h"
 #include "formatutils.h"
 #include "latexstructure.h"
 #include "latexkeybindings.h"
@@ -0,0 +1,779 @@
+/*
+ *      latexenvindex.c
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ *      MA 02110-1301, USA.
+ */
+
+/* Index of the \begin and \end commands of a document. It is built when it
+ * is first needed and afterwards only the lines touched by a modification
+ * are scanned again.
+ *
+ * Each command is a node of two treaps: one of all commands by position,
+ * and one of the commands of its name. The position of a command is stored
+ * relative to its parent, so moving all commands after a modification only
+ * touches one path. The commands of a name count 1 for \begin and -1 for
+ * \end, and each node keeps the sum and the lowest prefix sum of its
+ * subtree. The nesting depth at a command and the command where it drops
+ * again are found along one path, so an edit and a lookup take O(log n). */
+
+#include "latexenvindex.h"
+
+enum
+{
+	ORDER_TREE,
+	NAME_TREE,
+	TREE_COUNT
+};
+
+typedef struct EnvCommand EnvCommand;
+
+typedef struct
+{
+	EnvCommand *parent;
+	EnvCommand *left;
+	EnvCommand *right;
+} TreeLinks;
+
+struct EnvCommand
+{
+	TreeLinks links[TREE_COUNT];
+	/* the same in both treaps, higher ones are nearer to the root */
+	guint priority;
+	/* position of the backslash, relative to the parent in the ORDER_TREE */
+	gint offset;
+	/* length of the command */
+	gint len;
+	gboolean begin;
+	/* "group{env}" of "\begingroup{env}", owned by the names of the index */
+	const gchar *name;
+	/* of the subtree in the NAME_TREE: the sum and the lowest prefix sum */
+	gint sum;
+	gint min_sum;
+};
+
+typedef struct
+{
+	/* root of the NAME_TREE of the commands of a name */
+	EnvCommand *root;
+} EnvName;
+
+typedef struct
+{
+	/* root of the ORDER_TREE */
+	EnvCommand *root;
+	/* name -> EnvName, so equal names are the same string */
+	GHashTable *names;
+} EnvIndex;
+
+static GHashTable *indexes = NULL;
+
+#define LINKS(cmd, tree) (&(cmd)->links[tree])
+#define VALUE(cmd) ((cmd)->begin ? 1 : -1)
+
+
+static void free_commands(EnvCommand *cmd)
+{
+	if (cmd == NULL)
+		return;
+
+	free_commands(cmd->links[ORDER_TREE].left);
+	free_commands(cmd->links[ORDER_TREE].right);
+	g_free(cmd);
+}
+
+
+static void env_index_free(gpointer data)
+{
+	EnvIndex *idx = data;
+
+	free_commands(idx->root);
+	g_hash_table_destroy(idx->names);
+	g_free(idx);
+}
+
+
+static void update_sums(EnvCommand *cmd)
+{
+	EnvCommand *left = cmd->links[NAME_TREE].left;
+	EnvCommand *right = cmd->links[NAME_TREE].right;
+	gint sum = VALUE(cmd);
+	gint min_sum = sum;
+
+	if (left != NULL)
+	{
+		min_sum = MIN(left->min_sum, left->sum + sum);
+		sum += left->sum;
+	}
+	if (right != NULL)
+	{
+		min_sum = MIN(min_sum, sum + right->min_sum);
+		sum += right->sum;
+	}
+	cmd->sum = sum;
+	cmd->min_sum = min_sum;
+}
+
+
+static void update_path(EnvCommand *cmd, gint tree)
+{
+	if (tree != NAME_TREE)
+		return;
+
+	for (; cmd != NULL; cmd = cmd->links[NAME_TREE].parent)
+		update_sums(cmd);
+}
+
+
+/* Moves cmd above its parent */
+static void rotate_up(EnvCommand *cmd, gint tree, EnvCommand **root)
+{
+	TreeLinks *c = LINKS(cmd, tree);
+	EnvCommand *parent = c->parent;
+	TreeLinks *p = LINKS(parent, tree);
+	EnvCommand *grand = p->parent;
+	EnvCommand *inner;
+
+	if (p->left == cmd)
+	{
+		inner = c->right;
+		p->left = inner;
+		c->right = parent;
+	}
+	else
+	{
+		inner = c->left;
+		p->right = inner;
+		c->left = parent;
+	}
+	if (inner != NULL)
+		LINKS(inner, tree)->parent = parent;
+	p->parent = cmd;
+	c->parent = grand;
+
+	if (grand == NULL)
+		*root = cmd;
+	else if (LINKS(grand, tree)->left == parent)
+		LINKS(grand, tree)->left = cmd;
+	else
+		LINKS(grand, tree)->right = cmd;
+
+	if (tree == ORDER_TREE)
+	{
+		gint offset = cmd->offset;
+
+		if (inner != NULL)
+			inner->offset += offset;
+		cmd->offset += parent->offset;
+		parent->offset = -offset;
+	}
+	else
+	{
+		update_sums(parent);
+		update_sums(cmd);
+	}
+}
+
+
+/* Adds cmd as a child of parent, or as the root if parent is NULL */
+static void tree_attach(EnvCommand *cmd, gint tree, EnvCommand **root,
+		EnvCommand *parent, gboolean left)
+{
+	TreeLinks *c = LINKS(cmd, tree);
+
+	c->parent = parent;
+	c->left = c->right = NULL;
+	if (parent == NULL)
+		*root = cmd;
+	else if (left)
+		LINKS(parent, tree)->left = cmd;
+	else
+		LINKS(parent, tree)->right = cmd;
+
+	if (tree == NAME_TREE)
+		update_sums(cmd);
+	while (c->parent != NULL && c->parent->priority < cmd->priority)
+		rotate_up(cmd, tree, root);
+	update_path(c->parent, tree);
+}
+
+
+static void tree_remove(EnvCommand *cmd, gint tree, EnvCommand **root)
+{
+	TreeLinks *c = LINKS(cmd, tree);
+	EnvCommand *parent;
+
+	/* rotate it down to a leaf */
+	while (c->left != NULL || c->right != NULL)
+	{
+		EnvCommand *child;
+
+		if (c->left == NULL)
+			child = c->right;
+		else if (c->right == NULL)
+			child = c->left;
+		else
+			child = c->left->priority > c->right->priority ? c->left : c->right;
+		rotate_up(child, tree, root);
+	}
+
+	parent = c->parent;
+	if (parent == NULL)
+		*root = NULL;
+	else if (LINKS(parent, tree)->left == cmd)
+		LINKS(parent, tree)->left = NULL;
+	else
+		LINKS(parent, tree)->right = NULL;
+	update_path(parent, tree);
+}
+
+
+static EnvCommand *tree_next(EnvCommand *cmd, gint tree)
+{
+	EnvCommand *next = LINKS(cmd, tree)->right;
+
+	if (next != NULL)
+	{
+		while (LINKS(next, tree)->left != NULL)
+			next = LINKS(next, tree)->left;
+		return next;
+	}
+	for (next = LINKS(cmd, tree)->parent; next != NULL && LINKS(next, tree)->right == cmd;
+			next = LINKS(next, tree)->parent)
+		cmd = next;
+	return next;
+}
+
+
+static gint command_pos(EnvCommand *cmd)
+{
+	gint pos = 0;
+
+	for (; cmd != NULL; cmd = cmd->links[ORDER_TREE].parent)
+		pos += cmd->offset;
+	return pos;
+}
+
+
+/* Returns the first command at or after pos, NULL if there is none */
+static EnvCommand *lower_bound(EnvIndex *idx, gint pos)
+{
+	EnvCommand *cmd = idx->root, *found = NULL;
+	gint base = 0;
+
+	while (cmd != NULL)
+	{
+		gint cmd_pos = base + cmd->offset;
+
+		if (cmd_pos >= pos)
+		{
+			found = cmd;
+			cmd = cmd->links[ORDER_TREE].left;
+		}
+		else
+			cmd = cmd->links[ORDER_TREE].right;
+		base = cmd_pos;
+	}
+	return found;
+}
+
+
+/* Moves the commands at or after pos by delta */
+static void shift_commands(EnvIndex *idx, gint pos, gint delta)
+{
+	EnvCommand *cmd = idx->root;
+	gint base = 0;
+
+	while (cmd != NULL)
+	{
+		gint cmd_pos = base + cmd->offset;
+
+		if (cmd_pos >= pos)
+		{
+			EnvCommand *left = cmd->links[ORDER_TREE].left;
+
+			/* this moves the whole subtree, the left one is back in place
+			 * and checked again */
+			cmd->offset += delta;
+			if (left != NULL)
+				left->offset -= delta;
+			base = cmd_pos + delta;
+			cmd = left;
+		}
+		else
+		{
+			base = cmd_pos;
+			cmd = cmd->links[ORDER_TREE].right;
+		}
+	}
+}
+
+
+static void add_command(EnvIndex *idx, gint pos, gint len, gboolean begin, gchar *name)
+{
+	EnvCommand *cmd = g_new0(EnvCommand, 1);
+	EnvCommand *node, *parent = NULL;
+	gpointer key;
+	EnvName *env;
+	gint base = 0;
+	gboolean left = FALSE;
+
+	if (g_hash_table_lookup_extended(idx->names, name, &key, (gpointer *) &env))
+		g_free(name);
+	else
+	{
+		key = name;
+		env = g_new0(EnvName, 1);
+		g_hash_table_insert(idx->names, key, env);
+	}
+	cmd->name = key;
+	cmd->len = len;
+	cmd->begin = begin;
+	cmd->priority = g_random_int();
+
+	for (node = idx->root; node != NULL; )
+	{
+		gint node_pos = base + node->offset;
+
+		parent = node;
+		left = pos < node_pos;
+		node = left ? node->links[ORDER_TREE].left : node->links[ORDER_TREE].right;
+		base = node_pos;
+	}
+	cmd->offset = pos - base;
+	tree_attach(cmd, ORDER_TREE, &idx->root, parent, left);
+
+	parent = NULL;
+	for (node = env->root; node != NULL; )
+	{
+		parent = node;
+		left = pos < command_pos(node);
+		node = left ? node->links[NAME_TREE].left : node->links[NAME_TREE].right;
+	}
+	tree_attach(cmd, NAME_TREE, &env->root, parent, left);
+}
+
+
+static void remove_command(EnvIndex *idx, EnvCommand *cmd)
+{
+	EnvName *env = g_hash_table_lookup(idx->names, cmd->name);
+
+	tree_remove(cmd, NAME_TREE, &env->root);
+	tree_remove(cmd, ORDER_TREE, &idx->root);
+	g_free(cmd);
+}
+
+
+/* Removes the commands from start to before end */
+static void remove_commands(EnvIndex *idx, gint start, gint end)
+{
+	EnvCommand *cmd = lower_bound(idx, start);
+
+	while (cmd != NULL && command_pos(cmd) < end)
+	{
+		EnvCommand *next = tree_next(cmd, ORDER_TREE);
+
+		remove_command(idx, cmd);
+		cmd = next;
+	}
+}
+
+
+/* Adds the commands of text, which starts at a line start at offset */
+static void scan_text(EnvIndex *idx, const gchar *text, gint offset)
+{
+	const gchar *p;
+
+	for (p = text; *p != '\0'; p++)
+	{
+		const gchar *q, *env = "";
+		gint cmd_len, env_len = 0, len;
+		gboolean begin;
+
+		/* skip comments */
+		if (*p == '%' && (p == text || p[-1] != '\\'))
+		{
+			while (p[1] != '\0' && p[1] != '\n' && p[1] != '\r')
+				p++;
+			continue;
+		}
+		if (*p != '\\')
+			continue;
+		/* skip "\\" as its second backslash does not start a command */
+		if (p[1] == '\\')
+		{
+			p++;
+			continue;
+		}
+
+		if (strncmp(p + 1, "begin", 5) == 0)
+		{
+			begin = TRUE;
+			q = p + 6;
+		}
+		else if (strncmp(p + 1, "end", 3) == 0)
+		{
+			begin = FALSE;
+			q = p + 4;
+		}
+		else
+			continue;
+
+		cmd_len = 0;
+		while (g_ascii_isalpha(q[cmd_len]))
+			cmd_len++;
+
+		if (q[cmd_len] == '{')
+		{
+			env = q + cmd_len + 1;
+			while (env[env_len] != '\0' && env[env_len] != '}' &&
+				env[env_len] != '\n' && env[env_len] != '\r')
+				env_len++;
+			if (env[env_len] != '}')
+				continue;
+			len = env + env_len + 1 - p;
+		}
+		else if (cmd_len > 0)
+			len = q + cmd_len - p;
+		else
+			continue;
+
+		add_command(idx, offset + (p - text), len, begin,
+			g_strdup_printf("%.*s{%.*s}", cmd_len, q, env_len, env));
+
+		p += len - 1;
+	}
+}
+
+
+/* Scans the lines from the one at start to the one at end again */
+static void rescan_lines(EnvIndex *idx, ScintillaObject *sci, gint start, gint end)
+{
+	gchar *text;
+
+	start = sci_get_position_from_line(sci, sci_get_line_from_position(sci, start));
+	end = sci_get_line_end_position(sci, sci_get_line_from_position(sci, end));
+
+	remove_commands(idx, start, end);
+	text = sci_get_contents_range(sci, start, end);
+	scan_text(idx, text, start);
+	g_free(text);
+}
+
+
+/* Sets sum to the sum of the commands of the name of cmd before it, and lowest
+ * to the lowest sum before it, 0 if there is none lower */
+static void get_prefix_sums(EnvCommand *cmd, gint *sum, gint *lowest)
+{
+	EnvCommand *left = cmd->links[NAME_TREE].left;
+	EnvCommand *parent;
+	gint s = 0, low = 0;
+
+	if (left != NULL)
+	{
+		s = left->sum;
+		low = MIN(0, left->min_sum);
+	}
+	for (; (parent = cmd->links[NAME_TREE].parent) != NULL; cmd = parent)
+	{
+		if (parent->links[NAME_TREE].right == cmd)
+		{
+			/* the parent and its left subtree come before */
+			EnvCommand *pleft = parent->links[NAME_TREE].left;
+			gint psum = VALUE(parent);
+			gint plow = 0;
+
+			if (pleft != NULL)
+			{
+				plow = MIN(0, pleft->min_sum);
+				psum += pleft->sum;
+			}
+			plow = MIN(plow, psum);
+			low = MIN(plow, psum + low);
+			s += psum;
+		}
+	}
+	*sum = s;
+	*lowest = low;
+}
+
+
+/* Returns the first command of the subtree of cmd at which the sum is at most
+ * max, base is the sum before the subtree, which must contain one */
+static EnvCommand *descend_first(EnvCommand *cmd, gint base, gint max)
+{
+	for (;;)
+	{
+		EnvCommand *left = cmd->links[NAME_TREE].left;
+
+		if (left != NULL && base + left->min_sum <= max)
+		{
+			cmd = left;
+			continue;
+		}
+		if (left != NULL)
+			base += left->sum;
+		base += VALUE(cmd);
+		if (base <= max)
+			return cmd;
+		cmd = cmd->links[NAME_TREE].right;
+	}
+}
+
+
+/* Returns the last command of the subtree of cmd at which the sum is at most
+ * max, base is the sum before the subtree, which must contain one */
+static EnvCommand *descend_last(EnvCommand *cmd, gint base, gint max)
+{
+	for (;;)
+	{
+		EnvCommand *left = cmd->links[NAME_TREE].left;
+		EnvCommand *right = cmd->links[NAME_TREE].right;
+		gint at = base + VALUE(cmd) + (left != NULL ? left->sum : 0);
+
+		if (right != NULL && at + right->min_sum <= max)
+		{
+			base = at;
+			cmd = right;
+		}
+		else if (at <= max)
+			return cmd;
+		else
+			cmd = left;
+	}
+}
+
+
+/* Returns the first command of the name of cmd after it at which the sum is at
+ * most max, at is the sum at cmd */
+static EnvCommand *find_first_after(EnvCommand *cmd, gint at, gint max)
+{
+	EnvCommand *right = cmd->links[NAME_TREE].right;
+	EnvCommand *parent;
+
+	if (right != NULL)
+	{
+		if (at + right->min_sum <= max)
+			return descend_first(right, at, max);
+		at += right->sum;
+	}
+	for (; (parent = cmd->links[NAME_TREE].parent) != NULL; cmd = parent)
+	{
+		if (parent->links[NAME_TREE].left == cmd)
+		{
+			at += VALUE(parent);
+			if (at <= max)
+				return parent;
+			right = parent->links[NAME_TREE].right;
+			if (right != NULL)
+			{
+				if (at + right->min_sum <= max)
+					return descend_first(right, at, max);
+				at += right->sum;
+			}
+		}
+	}
+	return NULL;
+}
+
+
+/* Returns the last command of the name of cmd before it at which the sum is at
+ * most max, before is the sum before cmd */
+static EnvCommand *find_last_before(EnvCommand *cmd, gint before, gint max)
+{
+	EnvCommand *left = cmd->links[NAME_TREE].left;
+	EnvCommand *parent;
+	/* the sum before the subtree of cmd */
+	gint base = before;
+
+	if (left != NULL)
+	{
+		base -= left->sum;
+		if (base + left->min_sum <= max)
+			return descend_last(left, base, max);
+	}
+	for (; (parent = cmd->links[NAME_TREE].parent) != NULL; cmd = parent)
+	{
+		if (parent->links[NAME_TREE].right == cmd)
+		{
+			if (base <= max)
+				return parent;
+			base -= VALUE(parent);
+			left = parent->links[NAME_TREE].left;
+			if (left != NULL)
+			{
+				base -= left->sum;
+				if (base + left->min_sum <= max)
+					return descend_last(left, base, max);
+			}
+		}
+	}
+	return NULL;
+}
+
+
+/* Returns the command matching cmd, NULL if there is none. A \begin is matched
+ * by the first \end of its name which brings the nesting depth of the name
+ * back to the one before it. */
+static EnvCommand *get_match(EnvCommand *cmd)
+{
+	EnvCommand *match;
+	gint before, lowest;
+
+	get_prefix_sums(cmd, &before, &lowest);
+	if (cmd->begin)
+		return find_first_after(cmd, before + 1, before);
+
+	match = find_last_before(cmd, before, before - 1);
+	if (match != NULL)
+		return tree_next(match, NAME_TREE);
+	if (before - 1 < 0)
+		return NULL;
+	/* the \end closes the first \begin of its name */
+	while (cmd->links[NAME_TREE].parent != NULL)
+		cmd = cmd->links[NAME_TREE].parent;
+	while (cmd->links[NAME_TREE].left != NULL)
+		cmd = cmd->links[NAME_TREE].left;
+	return cmd;
+}
+
+
+static EnvIndex *get_index(GeanyDocument *doc)
+{
+	EnvIndex *idx;
+
+	if (indexes == NULL)
+		indexes = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, env_index_free);
+
+	idx = g_hash_table_lookup(indexes, doc);
+	if (idx == NULL)
+	{
+		gchar *text = sci_get_contents(doc->editor->sci, -1);
+
+		idx = g_new0(EnvIndex, 1);
+		idx->names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+		scan_text(idx, text, 0);
+		g_free(text);
+		g_hash_table_insert(indexes, doc, idx);
+	}
+	return idx;
+}
+
+
+/* Updates the index of doc, if it has one, after a SCN_MODIFIED */
+void glatex_env_index_update(GeanyDocument *doc, SCNotification *nt)
+{
+	EnvIndex *idx;
+	ScintillaObject *sci = doc->editor->sci;
+
+	if (indexes == NULL || nt->nmhdr.code != SCN_MODIFIED)
+		return;
+	idx = g_hash_table_lookup(indexes, doc);
+	if (idx == NULL)
+		return;
+
+	if (nt->modificationType & SC_MOD_INSERTTEXT)
+	{
+		shift_commands(idx, nt->position, nt->length);
+		rescan_lines(idx, sci, nt->position, nt->position + nt->length);
+	}
+	else if (nt->modificationType & SC_MOD_DELETETEXT)
+	{
+		remove_commands(idx, nt->position, nt->position + nt->length);
+		shift_commands(idx, nt->position, -nt->length);
+		rescan_lines(idx, sci, nt->position, nt->position);
+	}
+}
+
+
+/* Whether the first command on line is a \begin which is closed by an \end.
+ * Unlike the matches, the \end commands after it must close it and all open
+ * environments of its name around it, so a new \begin{itemize} inside
+ * a closed itemize is not closed. */
+gboolean glatex_env_index_is_closed(GeanyDocument *doc, gint line)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	EnvIndex *idx = get_index(doc);
+	EnvCommand *cmd = lower_bound(idx, sci_get_position_from_line(sci, line));
+	gint before, lowest;
+
+	if (cmd == NULL || command_pos(cmd) >= sci_get_line_end_position(sci, line) ||
+		! cmd->begin)
+		return FALSE;
+
+	/* the depth drops to the one before the outermost open environment */
+	get_prefix_sums(cmd, &before, &lowest);
+	return find_first_after(cmd, before + 1, lowest) != NULL;
+}
+
+
+/* Returns the position of the command matching the command at pos, or the
+ * first one on the line of pos, -1 if there is none */
+gint glatex_env_index_get_matching(GeanyDocument *doc, gint pos)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	EnvIndex *idx = get_index(doc);
+	gint line = sci_get_line_from_position(sci, pos);
+	gint line_end = sci_get_line_end_position(sci, line);
+	EnvCommand *c = lower_bound(idx, sci_get_position_from_line(sci, line));
+	EnvCommand *cmd = NULL;
+
+	for (; c != NULL; c = tree_next(c, ORDER_TREE))
+	{
+		gint c_pos = command_pos(c);
+
+		if (c_pos >= line_end)
+			break;
+		if (cmd == NULL || (c_pos <= pos && pos <= c_pos + c->len))
+			cmd = c;
+	}
+
+	if (cmd == NULL || (cmd = get_match(cmd)) == NULL)
+		return -1;
+	return command_pos(cmd);
+}
+
+
+void glatex_env_index_remove(GeanyDocument *doc)
+{
+	if (indexes != NULL)
+		g_hash_table_remove(indexes, doc);
+}
+
+
+void glatex_env_index_free_all(void)
+{
+	if (indexes != NULL)
+	{
+		g_hash_table_destroy(indexes);
+		indexes = NULL;
+	}
+}
+
+
+void glatex_goto_matching_environment(void)
+{
+	GeanyDocument *doc = NULL;
+	gint pos;
+
+	doc = document_get_current();
+	g_return_if_fail(doc != NULL);
+
+	pos = glatex_env_index_get_matching(doc, sci_get_current_position(doc->editor->sci));
+	if (pos != -1)
+		editor_goto_pos(doc->editor, pos, TRUE);
+	else
+		ui_set_statusbar(FALSE, _("No matching \\begin or \\end found"));
+}
@@ -0,0 +1,32 @@
+/*
+ *      latexenvindex.h
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ *      MA 02110-1301, USA.
+ */
+
+#ifndef LATEXENVINDEX_H
+#define LATEXENVINDEX_H
+
+#include "geanylatex.h"
+
+void glatex_env_index_update(GeanyDocument *doc, SCNotification *nt);
+gboolean glatex_env_index_is_closed(GeanyDocument *doc, gint line);
+gint glatex_env_index_get_matching(GeanyDocument *doc, gint pos);
+void glatex_env_index_remove(GeanyDocument *doc);
+void glatex_env_index_free_all(void);
+void glatex_goto_matching_environment(void);
+
+#endif
@@ -69,6 +69,20 @@ void glatex_kb_replace_special_chars(G_GNUC_UNUSED guint key_id)
 }
 
 
+void glatex_kb_replace_latex_commands(G_GNUC_UNUSED guint key_id)
+{
+	g_return_if_fail(document_get_current() != NULL);
+	glatex_replace_latex_commands_with_characters();
+}
+
+
+void glatex_kb_goto_matching_environment(G_GNUC_UNUSED guint key_id)
+{
+	g_return_if_fail(document_get_current() != NULL);
+	glatex_goto_matching_environment();
+}
+
+
 void glatex_kb_format_bold(G_GNUC_UNUSED guint key_id)
 {
 	g_return_if_fail(document_get_current() != NULL);
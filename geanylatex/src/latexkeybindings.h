@@ -50,6 +50,8 @@ enum
 	KB_LATEX_INSERT_COMMAND,
 	KB_LATEX_INSERT_CITE,
 	KB_LATEX_TOGGLE_UNDERSCORE_AUTOBRACES,
+	KB_LATEX_REPLACE_LATEX_COMMANDS,
+	KB_LATEX_GOTO_MATCHING_ENVIRONMENT,
 	COUNT_KB
 };
 
@@ -61,6 +63,8 @@ void glatex_kbwizard(G_GNUC_UNUSED guint key_id);
 void glatex_kb_insert_newline(G_GNUC_UNUSED guint key_id);
 void glatex_kb_insert_newitem(G_GNUC_UNUSED guint key_id);
 void glatex_kb_replace_special_chars(G_GNUC_UNUSED guint key_id);
+void glatex_kb_replace_latex_commands(G_GNUC_UNUSED guint key_id);
+void glatex_kb_goto_matching_environment(G_GNUC_UNUSED guint key_id);
 void glatex_kb_format_bold(G_GNUC_UNUSED guint key_id);
 void glatex_kb_format_italic(G_GNUC_UNUSED guint key_id);
 void glatex_kb_format_typewriter(G_GNUC_UNUSED guint key_id);
@@ -118,46 +118,51 @@ glatex_insert_string(const gchar *string, gboolean reset_position)
 }
 
 
-void glatex_replace_special_character(void)
+/* Replaces the selection or, without one, the whole document with its
+ * conversion, in one step to undo. The ASCII characters like "%" are only
+ * converted in a selection, in the whole document they are LaTeX markup. */
+static void replace_with_conversion(gchar *(*convert)(const gchar *text, gboolean ascii))
 {
 	GeanyDocument *doc = NULL;
+	ScintillaObject *sci;
+	gchar *text;
+	gchar *new;
+
 	doc = document_get_current();
+	g_return_if_fail(doc != NULL);
+	sci = doc->editor->sci;
 
-	if (doc != NULL && sci_has_selection(doc->editor->sci))
-	{
-		guint selection_len;
-		gchar *selection = NULL;
-		GString *replacement = g_string_new(NULL);
-		guint i;
-		gchar *new = NULL;
-		const gchar *entity = NULL;
-		gchar buf[7];
-		gint len;
+	if (sci_has_selection(sci))
+		text = sci_get_selection_contents(sci);
+	else
+		text = sci_get_contents(sci, -1);
+	new = convert(text, sci_has_selection(sci));
 
-		selection = sci_get_selection_contents(doc->editor->sci);
+	if (! utils_str_equal(text, new))
+	{
+		if (sci_has_selection(sci))
+		{
+			sci_replace_sel(sci, new);
+		}
+		else
+		{
+			sci_set_target_start(sci, 0);
+			sci_set_target_end(sci, sci_get_length(sci));
+			sci_replace_target(sci, new, FALSE);
+		}
+	}
+	g_free(text);
+	g_free(new);
+}
 
-		selection_len = strlen(selection);
 
-		for (i = 0; i < selection_len; i++)
-		{
-			len = g_unichar_to_utf8(g_utf8_get_char(selection + i), buf);
-			i = len - 1 + i;
-			buf[len] = '\0';
-			entity = glatex_get_entity(buf);
+void glatex_replace_special_character(void)
+{
+	replace_with_conversion(glatex_replace_entities);
+}
 
-			if (entity != NULL)
-			{
 
-				g_string_append(replacement, entity);
-			}
-			else
-			{
-				g_string_append(replacement, buf);
-			}
-		}
-		new = g_string_free(replacement, FALSE);
-		sci_replace_sel(doc->editor->sci, new);
-		g_free(selection);
-		g_free(new);
-	}
+void glatex_replace_latex_commands_with_characters(void)
+{
+	replace_with_conversion(glatex_replace_latex_commands);
 }
@@ -19,6 +19,7 @@
  *      MA 02110-1301, USA.
  */
 
+#include <string.h>
 #include <gtk/gtk.h>
 #include "support.h"
 #include "datatypes.h"
@@ -69,7 +70,6 @@ SubMenuTemplate glatex_char_array[] = {
 	{GREEK_LETTERS, "Γ", "\\Gamma" },
 	{GREEK_LETTERS, "γ", "\\gamma" },
 	{GREEK_LETTERS, "Δ", "\\Delta" },
-	{GREEK_LETTERS, "δ", "\\Delta" },
 	{GREEK_LETTERS, "δ", "\\delta" },
 	{GREEK_LETTERS, "Ε", "\\Epsilon" },
 	{GREEK_LETTERS, "ε", "\\epsilon" },
@@ -232,21 +232,283 @@ SubMenuTemplate glatex_char_array[] = {
 
 };
 
+/* Replacements indexed by code point, built on first use. ASCII characters are
+ * looked up in an array, all others in a hash table. */
+static const gchar *ascii_entities[128];
+static GHashTable *entities = NULL;
+
+/* Trie of the LaTeX commands without their backslash, for replacing them
+ * with their characters. The nodes of the first character are indexed by
+ * it, each node links its first child and its next sibling. */
+typedef struct
+{
+	gchar c;
+	gint child;
+	gint sibling;
+	/* the character of the command ending at this node */
+	const gchar *label;
+} CommandNode;
+
+static GArray *command_trie = NULL;
+static gint command_roots[128];
+
+
+static gint add_command_node(gchar c)
+{
+	CommandNode node = { c, -1, -1, NULL };
+
+	g_array_append_val(command_trie, node);
+	return command_trie->len - 1;
+}
+
+
+static void add_command(const gchar *command, const gchar *label)
+{
+	gint node;
+
+	/* skip the backslash */
+	command++;
+	if ((guchar) *command >= G_N_ELEMENTS(command_roots))
+		return;
+	if (command_roots[(guchar) *command] == 0)
+		command_roots[(guchar) *command] = add_command_node(*command);
+	node = command_roots[(guchar) *command];
+
+	for (command++; *command != '\0'; command++)
+	{
+		gint child = g_array_index(command_trie, CommandNode, node).child;
+
+		while (child != -1 && g_array_index(command_trie, CommandNode, child).c != *command)
+			child = g_array_index(command_trie, CommandNode, child).sibling;
+
+		if (child == -1)
+		{
+			child = add_command_node(*command);
+			g_array_index(command_trie, CommandNode, child).sibling =
+				g_array_index(command_trie, CommandNode, node).child;
+			g_array_index(command_trie, CommandNode, node).child = child;
+		}
+		node = child;
+	}
+	/* the first entry of a command wins, as for the characters */
+	if (g_array_index(command_trie, CommandNode, node).label == NULL)
+		g_array_index(command_trie, CommandNode, node).label = label;
+}
+
+
+static void init_index(void)
+{
+	guint i;
+
+	if (entities != NULL)
+		return;
+
+	entities = g_hash_table_new(g_direct_hash, g_direct_equal);
+	command_trie = g_array_new(FALSE, FALSE, sizeof(CommandNode));
+	/* node 0 is never used, 0 marks a missing root */
+	add_command_node('\0');
+
+	for (i = 0; glatex_char_array[i].label != NULL; i++)
+	{
+		const gchar *label = glatex_char_array[i].label;
+		gunichar c = g_utf8_get_char(label);
+
+		/* a backslash starts all commands, it is never replaced */
+		if (EMPTY(label) || utils_str_equal(label, "\\"))
+			continue;
+		if (*g_utf8_next_char(label) != '\0')
+			continue;
+
+		if (c < G_N_ELEMENTS(ascii_entities))
+		{
+			if (ascii_entities[c] == NULL)
+				ascii_entities[c] = glatex_char_array[i].latex;
+		}
+		else if (g_hash_table_lookup(entities, GUINT_TO_POINTER(c)) == NULL)
+			g_hash_table_insert(entities, GUINT_TO_POINTER(c),
+				(gpointer) glatex_char_array[i].latex);
+
+		if (glatex_char_array[i].latex[0] == '\\')
+			add_command(glatex_char_array[i].latex, label);
+	}
+}
+
+
+/* Whether command is a control word like "\alpha", which ends at the first
+ * character not being a letter. Control symbols like "\%" or "\"a" are not. */
+static gboolean is_control_word(const gchar *command)
+{
+	return command[0] == '\\' && g_ascii_isalpha(command[1]);
+}
+
+
+static const gchar *get_unichar_entity(gunichar c)
+{
+	if (c < G_N_ELEMENTS(ascii_entities))
+		return ascii_entities[c];
+	return g_hash_table_lookup(entities, GUINT_TO_POINTER(c));
+}
+
+
 const gchar *glatex_get_entity(const gchar *letter)
 {
-	if (! utils_str_equal(letter, "\\"))
+	init_index();
+
+	/* only single characters are replaced */
+	if (EMPTY(letter) || *g_utf8_next_char(letter) != '\0')
+		return NULL;
+
+	return get_unichar_entity(g_utf8_get_char(letter));
+}
+
+
+/* Returns a copy of text with all special characters replaced by their LaTeX
+ * commands. The ASCII characters like "$" and "%" are only replaced if ascii
+ * is set, as they are mostly markup in a LaTeX document. Control words get an
+ * empty group if a letter follows, so "αb" becomes "\alpha{}b" instead of the
+ * unknown "\alphab". */
+gchar *glatex_replace_entities(const gchar *text, gboolean ascii)
+{
+	GString *result;
+	const gchar *p, *run;
+
+	g_return_val_if_fail(text != NULL, NULL);
+	init_index();
+
+	result = g_string_sized_new(strlen(text));
+	run = text;
+	for (p = text; *p != '\0'; )
+	{
+		const gchar *entity;
+		const gchar *next;
+
+		if ((guchar) *p < 0x80)
+		{
+			entity = ascii ? ascii_entities[(guchar) *p] : NULL;
+			next = p + 1;
+		}
+		else
+		{
+			entity = get_unichar_entity(g_utf8_get_char_validated(p, -1));
+			next = g_utf8_find_next_char(p, NULL);
+			if (next == NULL)
+				next = p + strlen(p);
+		}
+
+		if (entity != NULL)
+		{
+			/* characters without replacement are copied in one go */
+			g_string_append_len(result, run, p - run);
+			g_string_append(result, entity);
+			if (is_control_word(entity) && g_ascii_isalpha(*next))
+				g_string_append(result, "{}");
+			run = next;
+		}
+		p = next;
+	}
+	g_string_append_len(result, run, p - run);
+
+	return g_string_free(result, FALSE);
+}
+
+
+/* Returns the character of the longest command at text, which starts with
+ * a backslash, NULL if there is none, and sets len to the length of the command */
+static const gchar *match_command(const gchar *text, gsize *len)
+{
+	const gchar *label = NULL;
+	gint node;
+	gsize i;
+
+	if ((guchar) text[1] >= G_N_ELEMENTS(command_roots))
+		return NULL;
+	node = command_roots[(guchar) text[1]];
+
+	for (i = 2; node != 0; i++)
+	{
+		gint child;
+
+		if (g_array_index(command_trie, CommandNode, node).label != NULL)
+		{
+			label = g_array_index(command_trie, CommandNode, node).label;
+			*len = i;
+		}
+		if (text[i] == '\0')
+			break;
+
+		child = g_array_index(command_trie, CommandNode, node).child;
+		while (child != -1 && g_array_index(command_trie, CommandNode, child).c != text[i])
+			child = g_array_index(command_trie, CommandNode, child).sibling;
+		if (child == -1)
+			break;
+		node = child;
+	}
+
+	if (label == NULL)
+		return NULL;
+	/* a control word must not be followed by a letter, "\pin" is not "\pi";
+	 * a control symbol may, "\"and" is "\"a" and "nd" */
+	if (is_control_word(text) && g_ascii_isalpha(text[*len]))
+		return NULL;
+	return label;
+}
+
+
+/* Returns a copy of text with all LaTeX commands of the special characters
+ * replaced by the characters, the reverse of glatex_replace_entities(). The
+ * escaped ASCII characters like "\%" are only replaced if ascii is set. */
+gchar *glatex_replace_latex_commands(const gchar *text, gboolean ascii)
+{
+	GString *result;
+	const gchar *p, *run;
+
+	g_return_val_if_fail(text != NULL, NULL);
+	init_index();
+
+	result = g_string_sized_new(strlen(text));
+	run = p = text;
+	while ((p = strchr(p, '\\')) != NULL)
 	{
-		guint i, len;
-    	len = G_N_ELEMENTS(glatex_char_array);
-		for (i = 0; i < len; i++)
+		const gchar *label;
+		gsize len;
+
+		/* "\\" is a line break, not the start of a command */
+		if (p[1] == '\\')
+		{
+			p += 2;
+			continue;
+		}
+
+		label = match_command(p, &len);
+		if (label == NULL || (! ascii && (guchar) *label < 0x80))
 		{
-			if (utils_str_equal(glatex_char_array[i].label, letter))
-			{
-				return glatex_char_array[i].latex;
-			}
+			p++;
+			continue;
 		}
+
+		g_string_append_len(result, run, p - run);
+		g_string_append(result, label);
+		/* drop the empty group ending a control word */
+		if (is_control_word(p) && strncmp(p + len, "{}", 2) == 0)
+			len += 2;
+		p += len;
+		run = p;
 	}
+	g_string_append(result, run);
+
+	return g_string_free(result, FALSE);
+}
+
+
+void glatex_free_entities(void)
+{
+	if (entities == NULL)
+		return;
 
-	/* if the char is not in the list */
-	return NULL;
+	g_hash_table_destroy(entities);
+	entities = NULL;
+	g_array_free(command_trie, TRUE);
+	command_trie = NULL;
+	memset(ascii_entities, 0, sizeof(ascii_entities));
+	memset(command_roots, 0, sizeof(command_roots));
 }
@@ -34,5 +34,8 @@ extern SubMenuTemplate glatex_char_array[];
 extern CategoryName glatex_cat_names[];
 
 const gchar *glatex_get_entity(const gchar *letter);
+gchar *glatex_replace_entities(const gchar *text, gboolean ascii);
+gchar *glatex_replace_latex_commands(const gchar *text, gboolean ascii);
+void glatex_free_entities(void);
 
 #endif
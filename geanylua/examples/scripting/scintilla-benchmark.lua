@@ -0,0 +1,62 @@
+--[[
+  Compares the call rates of geany.scintilla() and a function made by
+  geany.scifunc(), by reading every byte of the current document
+--]]
+
+
+local len=geany.scintilla("SCI_GETLENGTH")
+
+if (not len) or (len==0)
+then
+  geany.message("Scintilla benchmark:", "The current document is empty.")
+  return
+end
+
+-- Read at least a million bytes, going over the document several times
+local rounds=math.ceil(1000000/len)
+local calls=rounds*len
+
+
+local function rate(t)
+  if t>0 then return string.format("%.0f calls/s", calls/t) end
+  return "too fast to measure"
+end
+
+
+local t0=os.clock()
+for r=1,rounds
+do
+  for pos=0,len-1
+  do
+    geany.scintilla("SCI_GETCHARAT", pos)
+  end
+end
+local by_name=os.clock()-t0
+
+t0=os.clock()
+for r=1,rounds
+do
+  for pos=0,len-1
+  do
+    geany.scintilla(2007, pos)
+  end
+end
+local by_id=os.clock()-t0
+
+local getchar=geany.scifunc("SCI_GETCHARAT")
+t0=os.clock()
+for r=1,rounds
+do
+  for pos=0,len-1
+  do
+    getchar(pos)
+  end
+end
+local by_func=os.clock()-t0
+
+
+geany.message("Scintilla benchmark:",
+  string.format("%d calls of SCI_GETCHARAT\n\n", calls)..
+  "geany.scintilla(\"SCI_GETCHARAT\", pos):  "..rate(by_name).."\n"..
+  "geany.scintilla(2007, pos):  "..rate(by_id).."\n"..
+  "geany.scifunc(\"SCI_GETCHARAT\")(pos):  "..rate(by_func))
@@ -0,0 +1,58 @@
+--[[
+  Compares searching and replacing from a Lua loop with geany.findall()
+  and geany.replaceall(), in a new document with 100000 matches
+--]]
+
+
+local count=100000
+local sample=string.rep("foo bar\n", count)
+
+geany.newfile()
+
+
+-- Find all matches with geany.find() in a loop
+geany.text(sample)
+local t0=os.clock()
+local found=0
+local pos=0
+local len=geany.length()
+while true
+do
+  local a,b=geany.find("bar", pos, len, {"matchcase"})
+  if not a then break end
+  found=found+1
+  pos=b
+end
+local find_loop=os.clock()-t0
+
+t0=os.clock()
+local matches=geany.findall("bar", 0, len, {"matchcase"})
+local findall=os.clock()-t0
+
+
+-- Replace all matches with geany.find() and geany.selection() in a loop
+t0=os.clock()
+local replaced=0
+pos=0
+while true
+do
+  local a,b=geany.find("bar", pos, geany.length(), {"matchcase"})
+  if not a then break end
+  geany.select(a,b)
+  geany.selection("bazz")
+  replaced=replaced+1
+  pos=a+4
+end
+local replace_loop=os.clock()-t0
+
+geany.text(sample)
+t0=os.clock()
+local n=geany.replaceall("bar", "bazz", 0, geany.length(), {"matchcase"})
+local replaceall=os.clock()-t0
+
+
+geany.message("Search benchmark:",
+  string.format("find() loop:  %d matches in %.3f s\n", found, find_loop)..
+  string.format("findall():  %d matches in %.3f s\n\n", #matches, findall)..
+  string.format("find() and selection() loop:  %d replacements in %.3f s\n", replaced, replace_loop)..
+  string.format("replaceall():  %d replacements in %.3f s", n, replaceall))
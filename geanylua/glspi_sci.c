@@ -554,15 +554,23 @@ static gint glspi_byte(lua_State* L)
 
 
 static GHashTable*sci_cmd_hash=NULL;
+static GHashTable*sci_cmd_id_hash=NULL;
 
 static void glspi_init_sci_cmd_hash(void)
 {
 	gint i;
 	sci_cmd_hash=g_hash_table_new(g_str_hash,g_str_equal);
+	sci_cmd_id_hash=g_hash_table_new(g_direct_hash,g_direct_equal);
 	for (i=0; sci_cmd_hash_entries[i].name; i++) {
 		g_hash_table_insert(
 			sci_cmd_hash,
 			(gpointer) sci_cmd_hash_entries[i].name,&sci_cmd_hash_entries[i]);
+		/* The first entry of an id wins, as it did for the linear search */
+		if (!g_hash_table_lookup(sci_cmd_id_hash, GINT_TO_POINTER(sci_cmd_hash_entries[i].msgid))) {
+			g_hash_table_insert(
+				sci_cmd_id_hash,
+				GINT_TO_POINTER(sci_cmd_hash_entries[i].msgid),&sci_cmd_hash_entries[i]);
+		}
 	}
 }
 
@@ -572,6 +580,10 @@ static void glspi_free_sci_cmd_hash(void) {
 		g_hash_table_destroy(sci_cmd_hash);
 		sci_cmd_hash=NULL;
 	}
+	if (sci_cmd_id_hash) {
+		g_hash_table_destroy(sci_cmd_id_hash);
+		sci_cmd_id_hash=NULL;
+	}
 }
 
 void glspi_set_sci_cmd_hash(gboolean create) {
@@ -583,19 +595,26 @@ void glspi_set_sci_cmd_hash(gboolean create) {
 }
 
 
-static SciCmdHashEntry* lookup_cmd_id(gint cmd)
+#define lookup_cmd_id(cmd) g_hash_table_lookup(sci_cmd_id_hash,GINT_TO_POINTER(cmd))
+
+#define lookup_cmd_str(cmd) g_hash_table_lookup(sci_cmd_hash,cmd)
+
+
+static SciCmdHashEntry* lookup_cmd_name(const gchar*name)
 {
+	SciCmdHashEntry*he;
+	gchar cmdbuf[64];
 	gint i;
-	for (i=0;sci_cmd_hash_entries[i].name; i++) {
-		if (sci_cmd_hash_entries[i].msgid==cmd) { return &sci_cmd_hash_entries[i];}
-	}
-	return NULL;
+	/* Names already in upper case need no copy */
+	he=lookup_cmd_str((strncmp(name,"SCI_",4)==0)?&name[4]:name);
+	if (he) { return he; }
+	memset(cmdbuf,'\0', sizeof(cmdbuf));
+	strncpy(cmdbuf,name,sizeof(cmdbuf)-1);
+	for (i=0;cmdbuf[i];i++) {cmdbuf[i]=g_ascii_toupper(cmdbuf[i]);}
+	return lookup_cmd_str((strncmp(cmdbuf,"SCI_",4)==0)?&cmdbuf[4]:cmdbuf);
 }
 
 
-#define lookup_cmd_str(cmd) g_hash_table_lookup(sci_cmd_hash,cmd);
-
-
 
 static gint glspi_fail_not_implemented(lua_State* L, const gchar*funcname, const gchar*cmdname)
 {
@@ -619,66 +638,72 @@ static gint glspi_fail_arg_count(lua_State* L, const gchar*funcname, const gchar
 }
 
 
+static gint glspi_fail_unknown_cmd(lua_State* L, const gchar*funcname)
+{
+	lua_pushfstring(
+		L, _( "Error in module \"%s\" at function %s():\n"
+			"unknown command \"%s\" given for argument #1.\n"),
+		LUA_MODULE_NAME, &funcname[6], lua_tostring(L,1));
+	lua_error(L);
+	return 0;
+}
 
-#define FAIL_API glspi_fail_not_implemented(L,__FUNCTION__,he->name)
 
-#define FAIL_ARGC glspi_fail_arg_count(L,__FUNCTION__,he->name)
 
-static gint glspi_scintilla(lua_State* L)
+#define FAIL_API glspi_fail_not_implemented(L,funcname,he->name)
+
+#define FAIL_ARGC glspi_fail_arg_count(L,funcname,he->name)
+
+#define FAIL_PARAM_ARG(argnum,type) glspi_fail_arg_type(L,funcname,argnum,type)
+
+
+/* Looks up the command given as the first argument */
+static SciCmdHashEntry* lookup_cmd_arg(lua_State* L)
+{
+	if (lua_isnumber(L,1)) {
+		return lookup_cmd_id((gint)lua_tonumber(L,1));
+	} else {
+		return lookup_cmd_name(lua_tostring(L,1));
+	}
+}
+
+
+/*
+  Sends the command he with its wparam and lparam taken from the arguments
+  starting at argbase, and pushes its result.
+*/
+static gint glspi_send_sci_cmd(lua_State* L, SciCmdHashEntry*he, gint argbase, const gchar*funcname)
 {
 	uptr_t wparam=0;
 	sptr_t lparam=0;
-	SciCmdHashEntry*he=NULL;
-	gint argc=lua_gettop(L);
+	gint argc=lua_gettop(L)-argbase+1;
 	gchar*resultbuf=NULL;
 	gint bufsize=0;
 	DOC_REQUIRED
-	if (argc==0) { return FAIL_STRING_ARG(1); }
-
-	if (lua_isnumber(L,1)) {
-		he=lookup_cmd_id((gint)lua_tonumber(L,1));
-	} else {
-		if (lua_isstring(L,1)) {
-			gchar cmdbuf[64];
-			gint i;
-			memset(cmdbuf,'\0', sizeof(cmdbuf));
-			strncpy(cmdbuf,lua_tostring(L,1),sizeof(cmdbuf)-1);
-			for (i=0;cmdbuf[i];i++) {cmdbuf[i]=g_ascii_toupper(cmdbuf[i]);}
-			he=lookup_cmd_str((strncmp(cmdbuf,"SCI_",4)==0)?&cmdbuf[4]:cmdbuf);
-		} else { return FAIL_STRING_ARG(1); }
-	}
-	if ( !he ) {
-		lua_pushfstring(
-			L, _( "Error in module \"%s\" at function %s():\n"
-				"unknown command \"%s\" given for argument #1.\n"),
-			LUA_MODULE_NAME, &__FUNCTION__[6], lua_tostring(L,1));
-		lua_error(L);
-		return 0;
-	}
 
 	if (((he->wparam==SLT_INT)&&(he->lparam==SLT_STRINGRESULT))) {
 		/* We can allow missing wparam (length) for some string result types */
 	} else {
-		if ((he->lparam!=SLT_VOID)&&(argc<3)) { return FAIL_ARGC; }
-		if (((he->wparam!=SLT_VOID)&&(argc<2))) { return FAIL_ARGC; }
+		if ((he->lparam!=SLT_VOID)&&(argc<2)) { return FAIL_ARGC; }
+		if (((he->wparam!=SLT_VOID)&&(argc<1))) { return FAIL_ARGC; }
 	}
 	switch (he->wparam) {
 		case SLT_VOID:
 		break;
 		case SLT_INT:
-			if (argc>=2) {
-				if (!lua_isnumber(L,2)) {return FAIL_NUMERIC_ARG(2); };
-				wparam=lua_tonumber(L,2);
+			if (argc>=1) {
+				if (!lua_isnumber(L,argbase)) {return FAIL_PARAM_ARG(argbase,"number"); };
+				wparam=lua_tonumber(L,argbase);
 			}
 			break;
 		case SLT_STRING:
-			if (!lua_isstring(L,2)) {return FAIL_STRING_ARG(2); };
-			wparam=(uptr_t)lua_tostring(L,2);
+			if (!lua_isstring(L,argbase)) {return FAIL_PARAM_ARG(argbase,"string"); };
+			wparam=(uptr_t)lua_tostring(L,argbase);
 		break;
 		case SLT_CELLS: return FAIL_API;
 		case SLT_BOOL:
-			if (!lua_isboolean(L,2)) {return FAIL_BOOL_ARG(2); };
-			wparam=lua_toboolean(L,2);
+			if (!lua_isboolean(L,argbase)) {return FAIL_PARAM_ARG(argbase,"boolean"); };
+			wparam=lua_toboolean(L,argbase);
 		break;
 		case SLT_TEXTRANGE: return FAIL_API;
 		case SLT_STRINGRESULT: return FAIL_API;
@@ -691,17 +716,17 @@ static gint glspi_scintilla(lua_State* L)
 		case SLT_VOID:
 		break;
 		case SLT_INT:
-			if (!lua_isnumber(L,3)) { return FAIL_NUMERIC_ARG(2); };
-			lparam=lua_tonumber(L,3);
+			if (!lua_isnumber(L,argbase+1)) { return FAIL_PARAM_ARG(argbase+1,"number"); };
+			lparam=lua_tonumber(L,argbase+1);
 		break;
 		case SLT_STRING:
-			if (!lua_isstring(L,3)) {return FAIL_STRING_ARG(2); };
-			lparam=(sptr_t)lua_tostring(L,3);
+			if (!lua_isstring(L,argbase+1)) {return FAIL_PARAM_ARG(argbase+1,"string"); };
+			lparam=(sptr_t)lua_tostring(L,argbase+1);
 		break;
 		case SLT_CELLS: return FAIL_API;
 		case SLT_BOOL:
-			if (!lua_isboolean(L,3)) {return FAIL_BOOL_ARG(3); };
-			lparam=lua_toboolean(L,3);
+			if (!lua_isboolean(L,argbase+1)) {return FAIL_PARAM_ARG(argbase+1,"boolean"); };
+			lparam=lua_toboolean(L,argbase+1);
 			break;
 		case SLT_TEXTRANGE: return FAIL_API;
 		case SLT_STRINGRESULT:
@@ -752,34 +777,76 @@ static gint glspi_scintilla(lua_State* L)
 	}
 }
 
-static gint glspi_find(lua_State* L)
-{
-	struct TextToFind ttf;
 
-	gint flags=0;
-	gint i,n;
-	gchar *text;
+static gint glspi_scintilla(lua_State* L)
+{
+	SciCmdHashEntry*he=NULL;
 	DOC_REQUIRED
-	switch (lua_gettop(L)) {
-		case 0:return FAIL_STRING_ARG(1);
-		case 1:return FAIL_NUMERIC_ARG(2);
-		case 2:return FAIL_NUMERIC_ARG(3);
-		case 3:return FAIL_TABLE_ARG(4);
+	if (lua_gettop(L)==0) { return FAIL_STRING_ARG(1); }
+	if (!lua_isnumber(L,1) && !lua_isstring(L,1)) { return FAIL_STRING_ARG(1); }
+
+	he=lookup_cmd_arg(L);
+	if ( !he ) { return glspi_fail_unknown_cmd(L,__FUNCTION__); }
+
+	return glspi_send_sci_cmd(L,he,2,__FUNCTION__);
+}
+
+
+/* Calls the command resolved by glspi_scifunc() */
+static gint scifunc_closure(lua_State* L)
+{
+	SciCmdHashEntry*he=lua_touserdata(L,lua_upvalueindex(1));
+	return glspi_send_sci_cmd(L,he,1,"glspi_scifunc");
+}
+
+
+/* Whether a wparam or lparam of type t can be passed */
+static gboolean param_type_supported(GlspiType t)
+{
+	switch (t) {
+		case SLT_VOID:
+		case SLT_INT:
+		case SLT_STRING:
+		case SLT_BOOL:
+			return TRUE;
+		default:
+			return FALSE;
 	}
+}
 
-	if (!lua_isstring(L,1)) { return FAIL_STRING_ARG(1); }
-	if (!lua_isnumber(L,2)) { return FAIL_NUMERIC_ARG(2); }
-	if (!lua_isnumber(L,3)) { return FAIL_NUMERIC_ARG(3); }
-	if (!lua_istable(L,4)) { return FAIL_TABLE_ARG(4); }
 
-	text=g_strdup(lua_tostring(L,1));
-	ttf.lpstrText=text;
-	ttf.chrg.cpMin=lua_tonumber(L,2);
-	ttf.chrg.cpMax=lua_tonumber(L,3);
+/*
+  Returns a function sending the command given by its name or id, the
+  lookup and the check of its parameter types are done only once.
+*/
+static gint glspi_scifunc(lua_State* L)
+{
+	SciCmdHashEntry*he=NULL;
+	const gchar*funcname=__FUNCTION__;
+	if (lua_gettop(L)==0) { return FAIL_STRING_ARG(1); }
+	if (!lua_isnumber(L,1) && !lua_isstring(L,1)) { return FAIL_STRING_ARG(1); }
+
+	he=lookup_cmd_arg(L);
+	if ( !he ) { return glspi_fail_unknown_cmd(L,__FUNCTION__); }
+
+	if (!param_type_supported(he->wparam)) { return FAIL_API; }
+	if (!param_type_supported(he->lparam) && he->lparam!=SLT_STRINGRESULT) { return FAIL_API; }
+	if (he->result!=SLT_VOID && he->result!=SLT_INT && he->result!=SLT_BOOL) { return FAIL_API; }
 
-	n=lua_objlen(L,4);
+	lua_pushlightuserdata(L,he);
+	lua_pushcclosure(L,&scifunc_closure,1);
+	return 1;
+}
+
+/* Returns the SCFIND_* flags of the table of option names at argument argnum */
+static gint glspi_find_flags(lua_State* L, gint argnum, const gchar*funcname)
+{
+	gint flags=0;
+	gint i,n;
+
+	n=lua_objlen(L,argnum);
 	for (i=1;i<=n; i++) {
-		lua_rawgeti(L,4,i);
+		lua_rawgeti(L,argnum,i);
 		if (lua_isstring(L, -1)) {
 			const gchar*flagname=lua_tostring(L,-1);
 			if (g_ascii_strcasecmp(flagname, "matchcase")==0){
@@ -796,13 +863,42 @@ static gint glspi_find(lua_State* L)
 				lua_pushfstring(L, _("Error in module \"%s\" at function %s():\n"
 					" invalid table in argument #%d:\n"
 					" unknown flag \"%s\" for element #%d\n"),
-					LUA_MODULE_NAME, &__FUNCTION__[6], 4,
+					LUA_MODULE_NAME, &funcname[6], argnum,
 					(strlen(flagname)>64)?_("<too large to display>"):flagname, i);
 				lua_error(L);
 			}
-		} else return glspi_fail_elem_type(L, __FUNCTION__, 4, i, "string");
+		} else return glspi_fail_elem_type(L, funcname, argnum, i, "string");
 		lua_pop(L, 1);
 	}
+	return flags;
+}
+
+
+static gint glspi_find(lua_State* L)
+{
+	struct TextToFind ttf;
+
+	gint flags=0;
+	gchar *text;
+	DOC_REQUIRED
+	switch (lua_gettop(L)) {
+		case 0:return FAIL_STRING_ARG(1);
+		case 1:return FAIL_NUMERIC_ARG(2);
+		case 2:return FAIL_NUMERIC_ARG(3);
+		case 3:return FAIL_TABLE_ARG(4);
+	}
+
+	if (!lua_isstring(L,1)) { return FAIL_STRING_ARG(1); }
+	if (!lua_isnumber(L,2)) { return FAIL_NUMERIC_ARG(2); }
+	if (!lua_isnumber(L,3)) { return FAIL_NUMERIC_ARG(3); }
+	if (!lua_istable(L,4)) { return FAIL_TABLE_ARG(4); }
+
+	text=g_strdup(lua_tostring(L,1));
+	ttf.lpstrText=text;
+	ttf.chrg.cpMin=lua_tonumber(L,2);
+	ttf.chrg.cpMax=lua_tonumber(L,3);
+
+	flags=glspi_find_flags(L, 4, __FUNCTION__);
 
 	if (scintilla_send_message(doc->editor->sci,SCI_FINDTEXT,flags,(sptr_t)&ttf)!=-1) {
 		push_number(L,ttf.chrgText.cpMin);
@@ -816,6 +912,133 @@ static gint glspi_find(lua_State* L)
 }
 
 
+/*
+  Searches for text from the target start to stop, returns the start of the
+  match or -1, the target is set to the match.
+*/
+static gint search_next(ScintillaObject*sci, const gchar*text, gsize len, gint start, gint stop)
+{
+	scintilla_send_message(sci, SCI_SETTARGETSTART, start, 0);
+	scintilla_send_message(sci, SCI_SETTARGETEND, stop, 0);
+	return scintilla_send_message(sci, SCI_SEARCHINTARGET, len, (sptr_t)text);
+}
+
+
+/*
+  Returns where to search on after a match from start to end, an empty match
+  moves on by one char. Returns -1 after an empty match at the document end.
+*/
+static gint search_continue(ScintillaObject*sci, gint start, gint end)
+{
+	gint next;
+	if (end>start) { return end; }
+	next=scintilla_send_message(sci, SCI_POSITIONAFTER, end, 0);
+	return (next>end)?next:-1;
+}
+
+
+/* Returns an array with the start and stop positions of all matches */
+static gint glspi_findall(lua_State* L)
+{
+	ScintillaObject*sci;
+	const gchar*text;
+	size_t len;
+	gint start, stop, flags, n=0;
+	DOC_REQUIRED
+	switch (lua_gettop(L)) {
+		case 0:return FAIL_STRING_ARG(1);
+		case 1:return FAIL_NUMERIC_ARG(2);
+		case 2:return FAIL_NUMERIC_ARG(3);
+		case 3:return FAIL_TABLE_ARG(4);
+	}
+
+	if (!lua_isstring(L,1)) { return FAIL_STRING_ARG(1); }
+	if (!lua_isnumber(L,2)) { return FAIL_NUMERIC_ARG(2); }
+	if (!lua_isnumber(L,3)) { return FAIL_NUMERIC_ARG(3); }
+	if (!lua_istable(L,4)) { return FAIL_TABLE_ARG(4); }
+
+	sci=doc->editor->sci;
+	text=lua_tolstring(L,1,&len);
+	start=MIN(lua_tonumber(L,2), lua_tonumber(L,3));
+	stop=MAX(lua_tonumber(L,2), lua_tonumber(L,3));
+	flags=glspi_find_flags(L, 4, __FUNCTION__);
+
+	scintilla_send_message(sci, SCI_SETSEARCHFLAGS, flags, 0);
+	lua_newtable(L);
+	while ((start<=stop) && (search_next(sci, text, len, start, stop)!=-1)) {
+		gint a=scintilla_send_message(sci, SCI_GETTARGETSTART, 0, 0);
+		gint b=scintilla_send_message(sci, SCI_GETTARGETEND, 0, 0);
+		lua_createtable(L,2,0);
+		push_number(L,a);
+		lua_rawseti(L,-2,1);
+		push_number(L,b);
+		lua_rawseti(L,-2,2);
+		lua_rawseti(L,-2,++n);
+		start=search_continue(sci, a, b);
+		if (start<0) { break; }
+	}
+	return 1;
+}
+
+
+/*
+  Replaces all matches in one undo action and returns their number. Each
+  replacement is made right after its match was found, the search goes on
+  after it, so the positions found before stay valid.
+*/
+static gint glspi_replaceall(lua_State* L)
+{
+	ScintillaObject*sci;
+	const gchar*text;
+	const gchar*repl;
+	size_t len, repl_len;
+	gint start, stop, flags, n=0;
+	gint replace_msg;
+	DOC_REQUIRED
+	switch (lua_gettop(L)) {
+		case 0:return FAIL_STRING_ARG(1);
+		case 1:return FAIL_STRING_ARG(2);
+		case 2:return FAIL_NUMERIC_ARG(3);
+		case 3:return FAIL_NUMERIC_ARG(4);
+		case 4:return FAIL_TABLE_ARG(5);
+	}
+
+	if (!lua_isstring(L,1)) { return FAIL_STRING_ARG(1); }
+	if (!lua_isstring(L,2)) { return FAIL_STRING_ARG(2); }
+	if (!lua_isnumber(L,3)) { return FAIL_NUMERIC_ARG(3); }
+	if (!lua_isnumber(L,4)) { return FAIL_NUMERIC_ARG(4); }
+	if (!lua_istable(L,5)) { return FAIL_TABLE_ARG(5); }
+
+	sci=doc->editor->sci;
+	text=lua_tolstring(L,1,&len);
+	repl=lua_tolstring(L,2,&repl_len);
+	start=MIN(lua_tonumber(L,3), lua_tonumber(L,4));
+	stop=MAX(lua_tonumber(L,3), lua_tonumber(L,4));
+	flags=glspi_find_flags(L, 5, __FUNCTION__);
+	/* Regular expressions can refer to tagged sections in the replacement */
+	replace_msg=(flags & SCFIND_REGEXP)?SCI_REPLACETARGETRE:SCI_REPLACETARGET;
+
+	scintilla_send_message(sci, SCI_SETSEARCHFLAGS, flags, 0);
+	scintilla_send_message(sci, SCI_BEGINUNDOACTION, 0, 0);
+	while ((start<=stop) && (search_next(sci, text, len, start, stop)!=-1)) {
+		gint a=scintilla_send_message(sci, SCI_GETTARGETSTART, 0, 0);
+		gint b=scintilla_send_message(sci, SCI_GETTARGETEND, 0, 0);
+		gint end;
+		scintilla_send_message(sci, replace_msg, repl_len, (sptr_t)repl);
+		n++;
+		/* The target is now the replacement, the stop moves by the change of the length */
+		end=scintilla_send_message(sci, SCI_GETTARGETEND, 0, 0);
+		stop+=end-b;
+		/* An empty match must not be found again behind its replacement */
+		start=(a==b)?search_continue(sci, end, end):end;
+		if (start<0) { break; }
+	}
+	scintilla_send_message(sci, SCI_ENDUNDOACTION, 0, 0);
+	push_number(L,n);
+	return 1;
+}
+
+
 
 /*
 SCFIND_MATCHCASE  A match only occurs with text that matches the case of the search string.
@@ -862,7 +1085,10 @@ static const struct luaL_reg glspi_sci_funcs[] = {
 	{"match",     glspi_match},
 	{"byte",      glspi_byte},
 	{"scintilla", glspi_scintilla},
+	{"scifunc",   glspi_scifunc},
 	{"find",      glspi_find},
+	{"findall",   glspi_findall},
+	{"replaceall",glspi_replaceall},
 	{NULL,NULL}
 };
 
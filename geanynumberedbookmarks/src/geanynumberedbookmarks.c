@@ -46,7 +46,7 @@ typedef struct FileData
 	gchar *pcFolding;     /* holds which folds are open and which not */
 	gint LastChangedTime; /* time file was last changed by this editor */
 	gchar *pcBookmarks;   /* holds non-numbered bookmarks */
-	struct FileData * NextNode;
+	GList *pLink;         /* link of this structure in qKnownFiles */
 } FileData;
 
 
@@ -72,7 +72,11 @@ static gboolean bRememberBookmarks=TRUE;
 
 /* internal variables */
 static gint iShiftNumbers[]={41,33,34,163,36,37,94,38,42,40};
-static FileData *fdKnownFilesSettings=NULL;
+/* maximum number of files whose details are remembered */
+static const guint iMaxKnownFiles=500;
+/* FileData of the files come across, by normalised filename, and least recently opened first */
+static GHashTable *htKnownFiles=NULL;
+static GQueue *qKnownFiles=NULL;
 static gulong key_release_signal_id;
 
 /* default config file */
@@ -304,62 +308,184 @@ static const gchar ** aszMarkerImages[]=
 };
 
 
+/* return the key of a filename in htKnownFiles, to be freed by the caller: repeated directory
+ * separators are dropped and on Windows, where filenames are not case sensitive, the case is folded
+*/
+static gchar * NormaliseFileName(const gchar *pcFileName)
+{
+	gchar *pcKey,*pcTemp;
+	const gchar *pcSource;
+	gchar c;
+
+	pcKey=g_malloc(strlen(pcFileName)+1);
+	for(pcSource=pcFileName,pcTemp=pcKey;pcSource[0]!=0;pcSource++)
+	{
+		c=pcSource[0];
+#ifdef G_OS_WIN32
+		if(c=='/')
+			c=G_DIR_SEPARATOR;
+#endif
+		/* keep a leading "\\" of windows network paths */
+		if(c==G_DIR_SEPARATOR && pcTemp>pcKey+1 && pcTemp[-1]==G_DIR_SEPARATOR)
+			continue;
+
+		pcTemp[0]=c;
+		pcTemp++;
+	}
+	pcTemp[0]=0;
+
+#ifdef G_OS_WIN32
+	pcTemp=g_utf8_casefold(pcKey,-1);
+	g_free(pcKey);
+	pcKey=pcTemp;
+#endif
+
+	return pcKey;
+}
+
+
+/* create the store of FileData structures if not done yet */
+static void InitFileDataStore(void)
+{
+	if(htKnownFiles!=NULL)
+		return;
+
+	htKnownFiles=g_hash_table_new_full(g_str_hash,g_str_equal,g_free,NULL);
+	qKnownFiles=g_queue_new();
+}
+
+
+/* return the FileData structure for a file if have come across it before, NULL otherwise */
+static FileData * FindFileData(const gchar *pcFileName)
+{
+	gchar *pcKey;
+	FileData *fd;
+
+	if(htKnownFiles==NULL)
+		return NULL;
+
+	pcKey=NormaliseFileName(pcFileName);
+	fd=g_hash_table_lookup(htKnownFiles,pcKey);
+	g_free(pcKey);
+
+	return fd;
+}
+
+
+/* free a FileData structure, after it has been taken out of the store */
+static void FreeFileData(FileData *fd)
+{
+	/* free filename */
+	g_free(fd->pcFileName);
+	/* free folding & bookmark information if present */
+	g_free(fd->pcFolding);
+	g_free(fd->pcBookmarks);
+	/* free memory block  */
+	g_free(fd);
+}
+
+
+/* remove a FileData structure from the store and free it */
+static void ForgetFileData(FileData *fd)
+{
+	gchar *pcKey;
+
+	pcKey=NormaliseFileName(fd->pcFileName);
+	g_hash_table_remove(htKnownFiles,pcKey);
+	g_free(pcKey);
+
+	g_queue_delete_link(qKnownFiles,fd->pLink);
+	FreeFileData(fd);
+}
+
+
+/* forget the least recently opened files while there are more than iMaxKnownFiles, so that the
+ * details of files which have been deleted or moved since do not pile up. Files open in the
+ * editor and the file just added are kept
+*/
+static void PruneFileDataStore(void)
+{
+	GList *pNode,*pNext;
+	FileData *fd;
+
+	for(pNode=qKnownFiles->head;pNode!=qKnownFiles->tail && qKnownFiles->length>iMaxKnownFiles;
+	    pNode=pNext)
+	{
+		pNext=pNode->next;
+		fd=pNode->data;
+		if(document_find_by_filename(fd->pcFileName)==NULL)
+			ForgetFileData(fd);
+	}
+}
+
+
+/* mark a FileData structure as the most recently opened one */
+static void TouchFileData(FileData *fd)
+{
+	g_queue_unlink(qKnownFiles,fd->pLink);
+	g_queue_push_tail_link(qKnownFiles,fd->pLink);
+}
+
+
 /* return a FileData structure for a file
  * if not come across this file before then create one, otherwise return existing structure with
  * data in it
- * returns NULL on error
 */
 static FileData * GetFileData(gchar *pcFileName)
 {
-	FileData *fdTemp=fdKnownFilesSettings;
+	FileData *fd;
 	gint i;
 
-	/* First handle if main pointer doesn't point to anything */
-	if(fdTemp==NULL)
-	{
-		if((fdKnownFilesSettings=(FileData*)(g_malloc(sizeof *fdTemp)))!=NULL)
-		{
-			fdKnownFilesSettings->pcFileName=g_strdup(pcFileName);
-			for(i=0;i<10;i++)
-				fdKnownFilesSettings->iBookmark[i]=-1;
-
-			/* don't need to initiate iBookmarkLinePos */
-			fdKnownFilesSettings->pcFolding=NULL;
-			fdKnownFilesSettings->LastChangedTime=-1;
-			fdKnownFilesSettings->pcBookmarks=NULL;
-			fdKnownFilesSettings->NextNode=NULL;
-		}
-		return fdKnownFilesSettings;
-	}
+	fd=FindFileData(pcFileName);
+	if(fd!=NULL)
+		return fd;
 
-	/* move through chain to the correct entry or the end of a chain */
-	while(TRUE)
-	{
-		/* if have found relavent FileData, then exit */
-		if(utils_str_equal(pcFileName,fdTemp->pcFileName)==TRUE)
-			return fdTemp;
+	InitFileDataStore();
 
-		/* if end of chain, then add new entry, and return it. */
-		if(fdTemp->NextNode==NULL)
-		{
-			if((fdTemp->NextNode=(FileData*)(g_malloc(sizeof *fdTemp)))!=NULL)
-			{
-				fdTemp->NextNode->pcFileName=g_strdup(pcFileName);
-				for(i=0;i<10;i++)
-					fdTemp->NextNode->iBookmark[i]=-1;
-
-				/* don't need to initiate iBookmarkLinePos */
-				fdTemp->NextNode->pcFolding=NULL;
-				fdTemp->NextNode->LastChangedTime=-1;
-				fdTemp->NextNode->pcBookmarks=NULL;
-				fdTemp->NextNode->NextNode=NULL;
-			}
-			return fdTemp->NextNode;
+	fd=g_new(FileData,1);
+	fd->pcFileName=g_strdup(pcFileName);
+	for(i=0;i<10;i++)
+		fd->iBookmark[i]=-1;
 
-		}
-		fdTemp=fdTemp->NextNode;
+	/* don't need to initiate iBookmarkLinePos */
+	fd->pcFolding=NULL;
+	fd->LastChangedTime=-1;
+	fd->pcBookmarks=NULL;
 
-	}
+	g_queue_push_tail(qKnownFiles,fd);
+	fd->pLink=qKnownFiles->tail;
+	g_hash_table_insert(htKnownFiles,NormaliseFileName(pcFileName),fd);
+	PruneFileDataStore();
+
+	return fd;
+}
+
+
+/* free all the FileData structures and the store */
+static void FreeFileDataStore(void)
+{
+	if(htKnownFiles==NULL)
+		return;
+
+	g_queue_foreach(qKnownFiles,(GFunc)FreeFileData,NULL);
+	g_queue_free(qKnownFiles);
+	g_hash_table_destroy(htKnownFiles);
+	qKnownFiles=NULL;
+	htKnownFiles=NULL;
+}
+
+
+/* return TRUE if a file has bookmarks or folds worth remembering */
+static gboolean FileDataHasDetails(FileData *fd)
+{
+	gint i;
+
+	for(i=0;i<10;i++)
+		if(fd->iBookmark[i]!=-1)
+			return TRUE;
+
+	return (bRememberFolds==TRUE && fd->pcFolding!=NULL) ||
+	       (bRememberBookmarks==TRUE && fd->pcBookmarks!=NULL);
 }
 
 
@@ -371,15 +497,8 @@ static gboolean SaveIndividualSetting(GKeyFile *gkf,FileData *fd,gint iNumber,gc
 	gchar *pszMarkers;
 	gint i;
 
-	/* first check if any bookmarks or folds for this file */
-	/* if not can skip it */
-	for(i=0;i<10;i++)
-		if(fd->iBookmark[i]!=-1) break;
-	/* i==10 if no markers set */
-
 	/* skip if no folding data or markers */
-	if(i==10 && (bRememberFolds==FALSE || fd->pcFolding==NULL) && 
-	   (bRememberBookmarks==FALSE || fd->pcBookmarks==NULL))
+	if(FileDataHasDetails(fd)==FALSE)
 		return FALSE;
 
 	/* now save file data */
@@ -469,7 +588,8 @@ static void SaveSettings(gchar *filename)
 	GKeyFile *config=NULL;
 	gchar *config_file=NULL,*config_dir=NULL;
 	gchar *data;
-	FileData* fdTemp=fdKnownFilesSettings;
+	FileData* fdTemp;
+	GList *pNode;
 	gint i=0;
 
 	/* create new config from default settings */
@@ -485,13 +605,12 @@ static void SaveSettings(gchar *filename)
 		g_key_file_set_string(config,"Settings","File_Details_Suffix",FileDetailsSuffix);
 
 	/* now save file data */
-	while(fdTemp!=NULL)
+	for(pNode=(qKnownFiles!=NULL ? qKnownFiles->head : NULL);pNode!=NULL;pNode=pNode->next)
 	{
+		fdTemp=pNode->data;
 		/* if this entry has data needing saveing then save it and increment the counter */
 		if(SaveIndividualSetting(config,fdTemp,i,fdTemp->pcFileName))
 			i++;
-
-		fdTemp=fdTemp->NextNode;
 	}
 
 	/* turn config into data */
@@ -586,6 +705,7 @@ static gboolean LoadIndividualSetting(GKeyFile *gkf,gint iNumber,gchar *Filename
 
 	/* get folding data */
 	pcKey[0]='B';
+	g_free(fd->pcFolding);
 	if(bRememberFolds==TRUE)
 		fd->pcFolding=(gchar*)(utils_get_setting_string(gkf,"FileData",pcKey,NULL));
 	else
@@ -633,6 +753,7 @@ static gboolean LoadIndividualSetting(GKeyFile *gkf,gint iNumber,gchar *Filename
 
 	/* get non-numbered bookmarks */
 	pcKey[0]='F';
+	g_free(fd->pcBookmarks);
 	if(bRememberBookmarks==TRUE)
 		fd->pcBookmarks=(gchar*)(utils_get_setting_string(gkf,"FileData",pcKey,NULL));
 	else
@@ -961,6 +1082,7 @@ static void on_document_open(GObject *obj, GeanyDocument *doc, gpointer user_dat
 
 	/* check to see if file has changed since geany last saved it */
 	fd=GetFileData(doc->file_name);
+	TouchFileData(fd);
 	if(stat(doc->file_name,&sBuf)==0 && fd!=NULL && fd->LastChangedTime!=-1 &&
 	   fd->LastChangedTime!=sBuf.st_mtime)
 	{
@@ -1153,10 +1275,28 @@ static void on_document_save(GObject *obj, GeanyDocument *doc, gpointer user_dat
 }
 
 
+/* handler for when a document is closed
+ * This forgets the details of the file if there is nothing worth remembering, so that the store
+ * does not keep growing with every file opened
+*/
+static void on_document_close(GObject *obj, GeanyDocument *doc, gpointer user_data)
+{
+	FileData *fd;
+
+	if(doc->file_name==NULL)
+		return;
+
+	fd=FindFileData(doc->file_name);
+	if(fd!=NULL && FileDataHasDetails(fd)==FALSE)
+		ForgetFileData(fd);
+}
+
+
 PluginCallback plugin_callbacks[] =
 {
 	{ "document-open", (GCallback) &on_document_open, FALSE, NULL },
 	{ "document-save", (GCallback) &on_document_save, FALSE, NULL },
+	{ "document-close", (GCallback) &on_document_close, FALSE, NULL },
 	{ NULL, NULL, FALSE, NULL }
 };
 
@@ -1539,8 +1679,6 @@ void plugin_cleanup(void)
 	gint k;
 	guint i;
 	ScintillaObject* sci;
-	FileData *fdTemp=fdKnownFilesSettings;
-	FileData *fdTemp2;
 	guint32 *markers;
 
 	/* uncouple keypress monitor */
@@ -1559,19 +1697,7 @@ void plugin_cleanup(void)
 		}
 
 	/* Clear memory used to hold file details */
-	while(fdTemp!=NULL)
-	{
-		/* free filename */
-		g_free(fdTemp->pcFileName);
-		/* free folding & bookmark information if present */
-		g_free(fdTemp->pcFolding);
-		g_free(fdTemp->pcBookmarks);
-
-		fdTemp2=fdTemp->NextNode;
-		/* free memory block  */
-		g_free(fdTemp);
-		fdTemp=fdTemp2;
-	}
+	FreeFileDataStore();
 
 	/* free memory used for settings */
 	g_free(FileDetailsSuffix);
@@ -0,0 +1,373 @@
+/*
+ *      blame.c - Plugin to geany light IDE to work with vc
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Blame shown as margin text, parsed while "git blame --incremental" runs */
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <geanyplugin.h>
+#include "geanyvc.h"
+
+extern GeanyData *geany_data;
+extern GeanyFunctions *geany_functions;
+
+
+/* Geany uses the margins 0 to 2 */
+#define BLAME_MARGIN 3
+/* space between the margin text and the line numbers, in pixels */
+#define BLAME_MARGIN_PADDING 8
+
+#define BLAME_ID_LENGTH 40
+
+typedef struct
+{
+	gchar id[BLAME_ID_LENGTH + 1];
+	gchar *author;
+	glong time;
+	/* margin text and its width, created when the first lines are shown */
+	gchar *text;
+	gint width;
+} BlameCommit;
+
+typedef struct
+{
+	GeanyDocument *doc;
+	gchar *dir;
+	const gchar **env;
+	/* argv of the commands still to run */
+	GSList *passes;
+	/* output watch of the running command, 0 if none is running */
+	guint source;
+	/* commits by id, each commit's details are only sent once */
+	GHashTable *commits;
+	/* commit and 0 based lines of the group being parsed */
+	BlameCommit *commit;
+	gint line;
+	gint count;
+	gint width;
+} Blame;
+
+/* shown blames by document */
+static GHashTable *blames = NULL;
+
+
+static void
+blame_commit_free(gpointer data)
+{
+	BlameCommit *commit = data;
+
+	g_free(commit->author);
+	g_free(commit->text);
+	g_free(commit);
+}
+
+
+static void
+free_passes(Blame * blame)
+{
+	GSList *cur;
+
+	for (cur = blame->passes; cur != NULL; cur = g_slist_next(cur))
+		g_strfreev(cur->data);
+	g_slist_free(blame->passes);
+	blame->passes = NULL;
+}
+
+
+static void
+blame_free(Blame * blame)
+{
+	free_passes(blame);
+	g_hash_table_destroy(blame->commits);
+	g_free(blame->dir);
+	g_free(blame);
+}
+
+
+static const gchar *
+blame_commit_get_text(BlameCommit * commit, ScintillaObject * sci)
+{
+	if (commit->text == NULL)
+	{
+		/* lines which are not committed have an all zero id */
+		if (strspn(commit->id, "0") == BLAME_ID_LENGTH)
+			commit->text = g_strdup(_("Not committed yet"));
+		else
+		{
+			time_t t = commit->time;
+			gchar date[32] = "";
+
+			strftime(date, sizeof(date), "%Y-%m-%d", localtime(&t));
+			commit->text = g_strdup_printf("%.8s %s %s", commit->id, date,
+						       commit->author ? commit->author : "");
+		}
+		commit->width = scintilla_send_message(sci, SCI_TEXTWIDTH, STYLE_LINENUMBER,
+						       (sptr_t) commit->text);
+	}
+	return commit->text;
+}
+
+
+/* sets the margin text of the lines of the parsed group */
+static void
+show_group(Blame * blame)
+{
+	ScintillaObject *sci = blame->doc->editor->sci;
+	const gchar *text = blame_commit_get_text(blame->commit, sci);
+	gint line;
+
+	if (blame->commit->width + BLAME_MARGIN_PADDING > blame->width)
+	{
+		blame->width = blame->commit->width + BLAME_MARGIN_PADDING;
+		scintilla_send_message(sci, SCI_SETMARGINWIDTHN, BLAME_MARGIN, blame->width);
+	}
+	for (line = blame->line; line < blame->line + blame->count; line++)
+	{
+		scintilla_send_message(sci, SCI_MARGINSETTEXT, line, (sptr_t) text);
+		scintilla_send_message(sci, SCI_MARGINSETSTYLE, line, STYLE_LINENUMBER);
+	}
+}
+
+
+/*
+ * Parses a line of "git blame --incremental" output. Each group of lines starts with
+ * "<id> <original line> <final line> <count>", followed by the details of the commit
+ * the first time it appears, and ends with "filename <name>".
+ */
+static void
+parse_line(Blame * blame, const gchar * line)
+{
+	if (blame->commit == NULL)
+	{
+		const gchar *pos = line + BLAME_ID_LENGTH;
+		gchar *end;
+		gchar id[BLAME_ID_LENGTH + 1];
+
+		if (strlen(line) <= BLAME_ID_LENGTH || *pos != ' ')
+			return;
+		/* skip the original line */
+		strtol(pos, &end, 10);
+		blame->line = strtol(end, &end, 10) - 1;
+		blame->count = strtol(end, NULL, 10);
+		if (blame->line < 0 || blame->count <= 0)
+			return;
+
+		g_strlcpy(id, line, sizeof(id));
+		blame->commit = g_hash_table_lookup(blame->commits, id);
+		if (blame->commit == NULL)
+		{
+			blame->commit = g_new0(BlameCommit, 1);
+			g_strlcpy(blame->commit->id, id, sizeof(blame->commit->id));
+			g_hash_table_insert(blame->commits, blame->commit->id, blame->commit);
+		}
+	}
+	else if (g_str_has_prefix(line, "author "))
+		setptr(blame->commit->author, g_strdup(line + strlen("author ")));
+	else if (g_str_has_prefix(line, "author-time "))
+		blame->commit->time = strtol(line + strlen("author-time "), NULL, 10);
+	else if (g_str_has_prefix(line, "filename "))
+	{
+		show_group(blame);
+		blame->commit = NULL;
+	}
+}
+
+
+static guint blame_spawn(Blame * blame, gchar ** argv);
+
+
+static void
+run_next_pass(Blame * blame)
+{
+	blame->source = 0;
+	while (blame->passes)
+	{
+		gchar **argv = blame->passes->data;
+
+		blame->passes = g_slist_delete_link(blame->passes, blame->passes);
+		blame->commit = NULL;
+		blame->source = blame_spawn(blame, argv);
+		g_strfreev(argv);
+		if (blame->source)
+			return;
+	}
+
+	if (g_hash_table_size(blame->commits) == 0)
+	{
+		ui_set_statusbar(FALSE, _("No history available"));
+		vc_blame_hide(blame->doc);
+	}
+}
+
+
+static gboolean
+on_blame_output(GIOChannel * channel, G_GNUC_UNUSED GIOCondition condition, gpointer data)
+{
+	Blame *blame = data;
+	GIOStatus status;
+	gchar *line;
+	gsize len, term;
+
+	while ((status = g_io_channel_read_line(channel, &line, &len, &term, NULL))
+	       == G_IO_STATUS_NORMAL)
+	{
+		line[term] = '\0';
+		parse_line(blame, line);
+		g_free(line);
+	}
+	if (status == G_IO_STATUS_AGAIN)
+		return TRUE;
+
+	/* end of output, the next command is run */
+	run_next_pass(blame);
+	return FALSE;
+}
+
+
+/* returns the id of the output watch, 0 on error */
+static guint
+blame_spawn(Blame * blame, gchar ** argv)
+{
+	GIOChannel *channel;
+	GError *error = NULL;
+	gint out;
+	guint source;
+
+	if (!g_spawn_async_with_pipes(blame->dir, argv, (gchar **) blame->env,
+				      G_SPAWN_SEARCH_PATH | G_SPAWN_STDERR_TO_DEV_NULL, NULL, NULL,
+				      NULL, NULL, &out, NULL, &error))
+	{
+		g_warning("geanyvc: g_spawn_async_with_pipes error: %s", error->message);
+		ui_set_statusbar(FALSE, _("geanyvc: g_spawn_async_with_pipes error: %s"),
+				 error->message);
+		g_error_free(error);
+		return 0;
+	}
+
+#ifdef G_OS_WIN32
+	channel = g_io_channel_win32_new_fd(out);
+#else
+	channel = g_io_channel_unix_new(out);
+#endif
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	g_io_channel_set_flags(channel, G_IO_FLAG_NONBLOCK, NULL);
+	/* the pipe is closed when the watch is removed */
+	g_io_channel_set_close_on_unref(channel, TRUE);
+	source = g_io_add_watch(channel, G_IO_IN | G_IO_HUP | G_IO_ERR, on_blame_output, blame);
+	g_io_channel_unref(channel);
+	return source;
+}
+
+
+/*
+ * Runs the blame commands one after another and shows their output in a text margin
+ * of doc while it is parsed. Lines which were blamed twice are overwritten.
+ *
+ * @dir - start directory of the commands
+ * @passes - argv of the "git blame --incremental" commands, owned by the blame afterwards
+ * @env - environment of the commands
+ */
+void
+vc_blame_start(GeanyDocument * doc, const gchar * dir, GSList * passes, const gchar ** env)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	Blame *blame;
+
+	vc_blame_hide(doc);
+
+	blame = g_new0(Blame, 1);
+	blame->doc = doc;
+	blame->dir = g_strdup(dir);
+	blame->env = env;
+	blame->passes = passes;
+	blame->commits = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, blame_commit_free);
+
+	if (blames == NULL)
+		blames = g_hash_table_new(g_direct_hash, g_direct_equal);
+	g_hash_table_insert(blames, doc, blame);
+
+	scintilla_send_message(sci, SCI_SETMARGINTYPEN, BLAME_MARGIN, SC_MARGIN_TEXT);
+	scintilla_send_message(sci, SCI_SETMARGINMASKN, BLAME_MARGIN, 0);
+
+	run_next_pass(blame);
+}
+
+
+gboolean
+vc_blame_shown(GeanyDocument * doc)
+{
+	return blames != NULL && g_hash_table_lookup(blames, doc) != NULL;
+}
+
+
+/* Stops the blame commands of doc, the margin text shown so far stays visible */
+void
+vc_blame_stop(GeanyDocument * doc)
+{
+	Blame *blame = blames ? g_hash_table_lookup(blames, doc) : NULL;
+
+	if (blame == NULL)
+		return;
+
+	if (blame->source)
+	{
+		g_source_remove(blame->source);
+		blame->source = 0;
+	}
+	free_passes(blame);
+}
+
+
+/* Removes the blame margin of doc */
+void
+vc_blame_hide(GeanyDocument * doc)
+{
+	Blame *blame = blames ? g_hash_table_lookup(blames, doc) : NULL;
+
+	if (blame == NULL)
+		return;
+
+	vc_blame_stop(doc);
+	g_hash_table_remove(blames, doc);
+	if (DOC_VALID(doc))
+	{
+		scintilla_send_message(doc->editor->sci, SCI_MARGINTEXTCLEARALL, 0, 0);
+		scintilla_send_message(doc->editor->sci, SCI_SETMARGINWIDTHN, BLAME_MARGIN, 0);
+	}
+	blame_free(blame);
+}
+
+
+/* Removes all blame margins */
+void
+vc_blame_hide_all(void)
+{
+	guint i;
+
+	if (blames == NULL)
+		return;
+
+	foreach_document(i)
+	{
+		vc_blame_hide(documents[i]);
+	}
+	g_hash_table_destroy(blames);
+	blames = NULL;
+}
@@ -0,0 +1,320 @@
+/*
+ *      changemarks.c - Plugin to geany light IDE to work with vc
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* Markers for the lines changed against the base revision, computed in-process */
+
+#include <string.h>
+
+#include <geanyplugin.h>
+#include "geanyvc.h"
+#include "utils.h"
+
+extern GeanyData *geany_data;
+extern GeanyFunctions *geany_functions;
+
+
+enum
+{
+	VC_MARKER_ADDED,
+	VC_MARKER_MODIFIED,
+	VC_MARKER_DELETED,
+	VC_MARKER_COUNT
+};
+
+/* The marker numbers are claimed per editor among the unused ones. Numbered bookmarks
+ * takes them from 24 downwards, debugger uses 12-17 and scope 17-19 by default,
+ * so the change markers are looked for from 2 upwards. */
+#define VC_MARKER_FIRST     2
+#define VC_MARKER_LAST      11
+#define VC_MARKERS_KEY      "geanyvc-change-markers"
+
+/* delay after the last modification before the markers are updated, in ms */
+#define CHANGE_MARKS_DELAY  500
+
+typedef struct
+{
+	gchar *file_name;
+	/* NULL if the file is not under version control */
+	gchar *base;
+	gsize base_len;
+} ChangeMarks;
+
+/* base revisions of the open documents */
+static GHashTable *marks = NULL;
+
+static GeanyDocument *pending_doc = NULL;
+static guint pending_source = 0;
+
+
+static void
+change_marks_free(gpointer data)
+{
+	ChangeMarks *cm = data;
+
+	g_free(cm->file_name);
+	g_free(cm->base);
+	g_free(cm);
+}
+
+
+/* Removes the change markers of sci, if it has any */
+static void
+clear_markers(ScintillaObject * sci)
+{
+	gint *markers = g_object_get_data(G_OBJECT(sci), VC_MARKERS_KEY);
+	gint i;
+
+	if (markers == NULL)
+		return;
+
+	for (i = 0; i < VC_MARKER_COUNT; i++)
+		scintilla_send_message(sci, SCI_MARKERDELETEALL, markers[i], 0);
+}
+
+
+static void
+define_marker(ScintillaObject * sci, gint marker, gint symbol, gint colour)
+{
+	scintilla_send_message(sci, SCI_MARKERDEFINE, marker, symbol);
+	scintilla_send_message(sci, SCI_MARKERSETFORE, marker, colour);
+	scintilla_send_message(sci, SCI_MARKERSETBACK, marker, colour);
+}
+
+
+/* Whether no one uses the marker, the same test as numbered bookmarks does */
+static gboolean
+marker_is_free(ScintillaObject * sci, gint marker)
+{
+	gint symbol = scintilla_send_message(sci, SCI_MARKERSYMBOLDEFINED, marker, 0);
+
+	return symbol == SC_MARK_CIRCLE || symbol == SC_MARK_AVAILABLE;
+}
+
+
+/* Returns the marker numbers of sci, claiming and defining them if needed,
+ * NULL if not enough of them are free */
+static gint *
+claim_markers(ScintillaObject * sci)
+{
+	gint *markers = g_object_get_data(G_OBJECT(sci), VC_MARKERS_KEY);
+	gint marker, i;
+
+	if (markers)
+		return markers;
+
+	markers = g_new(gint, VC_MARKER_COUNT);
+	for (marker = VC_MARKER_FIRST, i = 0; marker <= VC_MARKER_LAST && i < VC_MARKER_COUNT;
+	     marker++)
+	{
+		if (marker_is_free(sci, marker))
+			markers[i++] = marker;
+	}
+	if (i < VC_MARKER_COUNT)
+	{
+		g_free(markers);
+		return NULL;
+	}
+
+	define_marker(sci, markers[VC_MARKER_ADDED], SC_MARK_LEFTRECT, 0x00b000);
+	define_marker(sci, markers[VC_MARKER_MODIFIED], SC_MARK_LEFTRECT, 0x0090ff);
+	define_marker(sci, markers[VC_MARKER_DELETED], SC_MARK_ARROW, 0x0000e0);
+	g_object_set_data_full(G_OBJECT(sci), VC_MARKERS_KEY, markers, g_free);
+	return markers;
+}
+
+
+/* Removes the change markers of sci and gives their numbers back */
+static void
+release_markers(ScintillaObject * sci)
+{
+	gint *markers = g_object_get_data(G_OBJECT(sci), VC_MARKERS_KEY);
+	gint i;
+
+	if (markers == NULL)
+		return;
+
+	for (i = 0; i < VC_MARKER_COUNT; i++)
+	{
+		scintilla_send_message(sci, SCI_MARKERDELETEALL, markers[i], 0);
+		scintilla_send_message(sci, SCI_MARKERDEFINE, markers[i], SC_MARK_AVAILABLE);
+	}
+	g_object_set_data(G_OBJECT(sci), VC_MARKERS_KEY, NULL);
+}
+
+
+static void
+cancel_pending(void)
+{
+	if (pending_source)
+	{
+		g_source_remove(pending_source);
+		pending_source = 0;
+	}
+	pending_doc = NULL;
+}
+
+
+/* Diffs the buffer of doc against its base revision and replaces its markers */
+void
+vc_change_marks_update(GeanyDocument * doc)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	ChangeMarks *cm;
+	GArray *changes;
+	gint *markers;
+	const gchar *text;
+	gint line_count;
+	guint i;
+
+	if (doc == pending_doc)
+		cancel_pending();
+
+	cm = marks ? g_hash_table_lookup(marks, doc) : NULL;
+	if (cm == NULL || cm->base == NULL)
+		return;
+	markers = g_object_get_data(G_OBJECT(sci), VC_MARKERS_KEY);
+	if (markers == NULL)
+		return;
+
+	/* the buffer is diffed in place, without copying it */
+	text = (const gchar *) scintilla_send_message(sci, SCI_GETCHARACTERPOINTER, 0, 0);
+	changes = vc_diff_get_changes(cm->base, cm->base_len, text, sci_get_length(sci));
+	line_count = sci_get_line_count(sci);
+
+	clear_markers(sci);
+	for (i = 0; i < changes->len; i++)
+	{
+		VC_CHANGE *change = &g_array_index(changes, VC_CHANGE, i);
+		gint line;
+
+		switch (change->type)
+		{
+			case VC_CHANGE_DELETED:
+				line = MIN(change->line, line_count - 1);
+				scintilla_send_message(sci, SCI_MARKERADD, line, markers[VC_MARKER_DELETED]);
+				break;
+			default:
+				for (line = change->line; line < change->line + change->count; line++)
+					scintilla_send_message(sci, SCI_MARKERADD, line,
+							       markers[change->type == VC_CHANGE_ADDED ?
+								       VC_MARKER_ADDED : VC_MARKER_MODIFIED]);
+		}
+	}
+	g_array_free(changes, TRUE);
+}
+
+
+static gboolean
+on_update_timeout(G_GNUC_UNUSED gpointer data)
+{
+	GeanyDocument *doc = pending_doc;
+
+	pending_source = 0;
+	pending_doc = NULL;
+	if (DOC_VALID(doc))
+		vc_change_marks_update(doc);
+	return FALSE;
+}
+
+
+/* Updates the markers of doc once it was not modified for CHANGE_MARKS_DELAY */
+void
+vc_change_marks_schedule(GeanyDocument * doc)
+{
+	if (marks == NULL || g_hash_table_lookup(marks, doc) == NULL)
+		return;
+
+	if (pending_doc != doc)
+	{
+		if (DOC_VALID(pending_doc))
+			vc_change_marks_update(pending_doc);
+		pending_doc = doc;
+	}
+	if (pending_source)
+		g_source_remove(pending_source);
+	pending_source = g_timeout_add(CHANGE_MARKS_DELAY, on_update_timeout, NULL);
+}
+
+
+/* Whether the base revision of doc is known, it is not after doc was saved under another name */
+gboolean
+vc_change_marks_has_base(GeanyDocument * doc)
+{
+	ChangeMarks *cm = marks ? g_hash_table_lookup(marks, doc) : NULL;
+
+	return cm != NULL && utils_str_equal(cm->file_name, doc->file_name);
+}
+
+
+/*
+ * Sets the base revision doc is compared with and updates its markers.
+ *
+ * @base - the base revision, NULL if the file is not under version control,
+ *         it is owned by the change markers afterwards
+ */
+void
+vc_change_marks_set_base(GeanyDocument * doc, gchar * base)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	ChangeMarks *cm = g_new0(ChangeMarks, 1);
+
+	if (marks == NULL)
+		marks = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+					      change_marks_free);
+
+	cm->file_name = g_strdup(doc->file_name);
+	cm->base = base;
+	cm->base_len = base ? strlen(base) : 0;
+	g_hash_table_insert(marks, doc, cm);
+
+	if (base && claim_markers(sci))
+		vc_change_marks_update(doc);
+	else
+		release_markers(sci);
+}
+
+
+/* Forgets the base revision of doc and removes its markers */
+void
+vc_change_marks_remove(GeanyDocument * doc)
+{
+	if (doc == pending_doc)
+		cancel_pending();
+	if (marks && g_hash_table_remove(marks, doc) && DOC_VALID(doc))
+		release_markers(doc->editor->sci);
+}
+
+
+/* Forgets all base revisions, e.g. after they changed by a commit or an update */
+void
+vc_change_marks_remove_all(void)
+{
+	guint i;
+
+	cancel_pending();
+	if (marks == NULL)
+		return;
+
+	foreach_document(i)
+	{
+		if (g_hash_table_lookup(marks, documents[i]))
+			release_markers(documents[i]->editor->sci);
+	}
+	g_hash_table_destroy(marks);
+	marks = NULL;
+}
@@ -19,10 +19,17 @@
  */
 
 #include <string.h>
+#include <stdio.h>
 
 #include <geanyplugin.h>
+#include <glib/gstdio.h>
 #include "geanyvc.h"
 
+#ifdef G_OS_UNIX
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
 extern GeanyFunctions *geany_functions;
 
 
@@ -62,20 +69,191 @@ get_external_diff_viewer(void)
 }
 
 
-void
-vc_external_diff(const gchar * src, const gchar * dest)
+/* state of an asynchronous diff against the base revision */
+typedef struct
+{
+	gchar *base_file;	/* temporary file the base revision is written to */
+	gchar *local_file;
+	FILE *out;
+	gboolean read_done;
+	gboolean cat_done;
+	gboolean cat_failed;
+} ExternalDiff;
+
+
+static void
+external_diff_free(ExternalDiff * ed)
+{
+	if (ed->out)
+		fclose(ed->out);
+	g_unlink(ed->base_file);
+	g_free(ed->base_file);
+	g_free(ed->local_file);
+	g_free(ed);
+}
+
+
+static void
+on_viewer_exited(GPid pid, G_GNUC_UNUSED gint status, gpointer data)
+{
+	g_spawn_close_pid(pid);
+	external_diff_free(data);
+}
+
+
+/* called when both the output was read and the "cat base" command exited */
+static void
+external_diff_start_viewer(ExternalDiff * ed)
 {
 	gchar *argv[4] = { NULL, NULL, NULL, NULL };
+	GError *error = NULL;
+	GPid pid;
+
+	fclose(ed->out);
+	ed->out = NULL;
+
+	if (ed->cat_failed)
+	{
+		ui_set_statusbar(FALSE, _("geanyvc: could not get the base revision of %s"),
+				 ed->local_file);
+		external_diff_free(ed);
+		return;
+	}
+
+	argv[0] = (gchar *) get_external_diff_viewer();
+	argv[1] = ed->base_file;
+	argv[2] = ed->local_file;
+
+	if (!g_spawn_async(NULL, argv, NULL,
+			   G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD |
+			   G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL,
+			   NULL, NULL, &pid, &error))
+	{
+		g_warning("geanyvc: g_spawn_async error: %s", error->message);
+		ui_set_statusbar(FALSE, _("geanyvc: g_spawn_async error: %s"), error->message);
+		g_error_free(error);
+		external_diff_free(ed);
+		return;
+	}
+	/* the temporary file is removed when the viewer exits */
+	g_child_watch_add(pid, on_viewer_exited, ed);
+}
+
+
+static gboolean
+on_cat_output(GIOChannel * channel, GIOCondition condition, gpointer data)
+{
+	ExternalDiff *ed = data;
+	gchar buf[8192];
+	gsize len = 0;
+	GIOStatus status = G_IO_STATUS_NORMAL;
+
+	if (condition & G_IO_IN)
+	{
+		status = g_io_channel_read_chars(channel, buf, sizeof(buf), &len, NULL);
+		if (len > 0 && fwrite(buf, 1, len, ed->out) != len)
+			ed->cat_failed = TRUE;
+		if (status == G_IO_STATUS_NORMAL || status == G_IO_STATUS_AGAIN)
+			return TRUE;
+	}
+	if (status == G_IO_STATUS_ERROR)
+		ed->cat_failed = TRUE;
+
+	/* end of output */
+	g_io_channel_shutdown(channel, FALSE, NULL);
+	ed->read_done = TRUE;
+	if (ed->cat_done)
+		external_diff_start_viewer(ed);
+	return FALSE;
+}
+
+
+static void
+on_cat_exited(GPid pid, gint status, gpointer data)
+{
+	ExternalDiff *ed = data;
+
+	g_spawn_close_pid(pid);
+#ifdef G_OS_UNIX
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+#else
+	if (status != 0)
+#endif
+		ed->cat_failed = TRUE;
+
+	ed->cat_done = TRUE;
+	if (ed->read_done)
+		external_diff_start_viewer(ed);
+}
+
+
+/*
+ * Runs the "cat base" command asynchronously, writes its output to a temporary file
+ * and shows it against the local file in the external diff viewer, without blocking
+ * until the viewer is closed. The temporary file is removed when the viewer exits.
+ *
+ * @dir - start directory of the command
+ * @argv - the command, with the file names already substituted
+ * @env - environment of the command
+ * @localename - the local file, in locale encoding
+ */
+void
+vc_external_diff_base(const gchar * dir, gchar ** argv, const gchar ** env,
+		      const gchar * localename)
+{
+	ExternalDiff *ed;
+	GIOChannel *channel;
+	GError *error = NULL;
+	gchar *template, *basename;
+	gint fd, out;
+	GPid pid;
+
+	basename = g_path_get_basename(localename);
+	template = g_strconcat("geanyvc-XXXXXX-", basename, NULL);
+	g_free(basename);
+
+	ed = g_new0(ExternalDiff, 1);
+	fd = g_file_open_tmp(template, &ed->base_file, &error);
+	g_free(template);
+	if (fd == -1)
+	{
+		g_warning("geanyvc: unable to create a temporary file: %s", error->message);
+		g_error_free(error);
+		g_free(ed);
+		return;
+	}
 
-	const gchar *diff = get_external_diff_viewer();
-	if (!diff)
+	ed->local_file = g_strdup(localename);
+	ed->out = fdopen(fd, "wb");
+	if (!ed->out)
+	{
+		external_diff_free(ed);
 		return;
+	}
+
+	if (!g_spawn_async_with_pipes(dir, argv, (gchar **) env,
+				      G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD |
+				      G_SPAWN_STDERR_TO_DEV_NULL, NULL, NULL, &pid,
+				      NULL, &out, NULL, &error))
+	{
+		g_warning("geanyvc: g_spawn_async_with_pipes error: %s", error->message);
+		ui_set_statusbar(FALSE, _("geanyvc: g_spawn_async_with_pipes error: %s"),
+				 error->message);
+		g_error_free(error);
+		external_diff_free(ed);
+		return;
+	}
 
-	argv[0] = (gchar *) diff;
-	argv[1] = (gchar *) src;
-	argv[2] = (gchar *) dest;
+#ifdef G_OS_WIN32
+	channel = g_io_channel_win32_new_fd(out);
+#else
+	channel = g_io_channel_unix_new(out);
+#endif
+	g_io_channel_set_encoding(channel, NULL, NULL);
+	g_io_channel_set_buffered(channel, FALSE);
+	g_io_channel_set_close_on_unref(channel, TRUE);
+	g_io_add_watch(channel, G_IO_IN | G_IO_HUP | G_IO_ERR, on_cat_output, ed);
+	g_io_channel_unref(channel);
 
-	utils_spawn_sync(NULL, argv, NULL,
-			 G_SPAWN_SEARCH_PATH | G_SPAWN_STDOUT_TO_DEV_NULL |
-			 G_SPAWN_STDERR_TO_DEV_NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	g_child_watch_add(pid, on_cat_exited, ed);
 }
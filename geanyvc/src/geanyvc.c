@@ -62,6 +62,7 @@ static gboolean set_maximize_commit_dialog;
 static gboolean set_external_diff;
 static gboolean set_editor_menu_entries;
 static gboolean set_menubar_entry;
+static gboolean set_change_markers;
 
 static gchar *config_file;
 
@@ -521,23 +522,11 @@ execute_custom_command(const gchar * dir, const gchar ** argv, const gchar ** en
 	return exit_code;
 }
 
-static gint
-execute_command(const VC_RECORD * vc, gchar ** std_out, gchar ** std_err, const gchar * filename,
-		gint cmd, GSList * list, const gchar * message)
+/* start directory of command cmd for filename */
+static gchar *
+get_command_dir(const VC_RECORD * vc, gint cmd, const gchar * filename)
 {
 	gchar *dir = NULL;
-	gint ret;
-	const gint action_command_cell = 1;
-
-	if (std_out)
-		*std_out = NULL;
-	if (std_err)
-		*std_err = NULL;
-
-	if (vc->commands[cmd].function)
-	{
-		return vc->commands[cmd].function(std_out, std_err, filename, list, message);
-	}
 
 	if (vc->commands[cmd].startdir == VC_COMMAND_STARTDIR_FILE)
 	{
@@ -554,7 +543,28 @@ execute_command(const VC_RECORD * vc, gchar ** std_out, gchar ** std_err, const
 	{
 		g_warning("geanyvc: unknown startdir type: %d", vc->commands[cmd].startdir);
 	}
+	return dir;
+}
+
+static gint
+execute_command(const VC_RECORD * vc, gchar ** std_out, gchar ** std_err, const gchar * filename,
+		gint cmd, GSList * list, const gchar * message)
+{
+	gchar *dir;
+	gint ret;
+	const gint action_command_cell = 1;
+
+	if (std_out)
+		*std_out = NULL;
+	if (std_err)
+		*std_err = NULL;
+
+	if (vc->commands[cmd].function)
+	{
+		return vc->commands[cmd].function(std_out, std_err, filename, list, message);
+	}
 
+	dir = get_command_dir(vc, cmd, filename);
 	ret = execute_custom_command(dir, vc->commands[cmd].command, vc->commands[cmd].env, std_out,
 				     std_err, filename, list, message);
 
@@ -565,14 +575,61 @@ execute_command(const VC_RECORD * vc, gchar ** std_out, gchar ** std_err, const
 	return ret;
 }
 
+/*
+ * Returns the argv of command cmd for running it asynchronously, NULL if it has none.
+ * Only the last command is returned if cmd runs several ones.
+ *
+ * @dir - set to the start directory of the command
+ */
+gchar **
+vc_get_command_argv(const VC_RECORD * vc, gint cmd, const gchar * filename,
+		    const gchar * message, gchar ** dir)
+{
+	GSList *largv, *cur;
+	gchar **argv = NULL;
+
+	*dir = get_command_dir(vc, cmd, filename);
+	if (vc->commands[cmd].command == NULL)
+		return NULL;
+
+	largv = get_cmd(vc->commands[cmd].command, *dir, filename, NULL, message);
+	for (cur = largv; cur != NULL; cur = g_slist_next(cur))
+	{
+		if (g_slist_next(cur) == NULL)
+			argv = cur->data;
+		else
+			g_strfreev(cur->data);
+	}
+	g_slist_free(largv);
+	return argv;
+}
+
+/* Shows the differences of filename to its base revision in the external diff viewer,
+ * the base revision is fetched by VC_COMMAND_CAT_BASE into a temporary file */
+static void
+external_diff_file(const VC_RECORD * vc, const gchar * filename)
+{
+	gchar *dir;
+	gchar **argv = vc_get_command_argv(vc, VC_COMMAND_CAT_BASE, filename, NULL, &dir);
+
+	if (argv)
+	{
+		gchar *localename = utils_get_locale_from_utf8(filename);
+
+		vc_external_diff_base(dir, argv, vc->commands[VC_COMMAND_CAT_BASE].env, localename);
+		g_free(localename);
+	}
+
+	g_strfreev(argv);
+	g_free(dir);
+}
+
 /* Callback if menu item for a single file was activated */
 static void
 vcdiff_file_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer gdata)
 {
 	gchar *text = NULL;
-	gchar *new, *old;
 	gchar *name;
-	gchar *localename;
 	const VC_RECORD *vc;
 	GeanyDocument *doc;
 
@@ -593,48 +650,7 @@ vcdiff_file_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpoint
 		if (set_external_diff && get_external_diff_viewer())
 		{
 			g_free(text);
-
-			/*  1) rename file to file.geany.~NEW~
-			   2) revert file
-			   3) rename file to file.geanyvc.~BASE~
-			   4) rename file.geany.~NEW~ to origin file
-			   5) show diff
-			 */
-			localename = utils_get_locale_from_utf8(doc->file_name);
-
-			new = g_strconcat(doc->file_name, ".geanyvc.~NEW~", NULL);
-			setptr(new, utils_get_locale_from_utf8(new));
-
-			old = g_strconcat(doc->file_name, ".geanyvc.~BASE~", NULL);
-			setptr(old, utils_get_locale_from_utf8(old));
-
-			if (g_rename(localename, new) != 0)
-			{
-				g_warning(_
-					  ("geanyvc: vcdiff_file_activated: Unable to rename '%s' to '%s'"),
-					  localename, new);
-				goto end;
-			}
-
-			execute_command(vc, NULL, NULL, doc->file_name,
-					VC_COMMAND_REVERT_FILE, NULL, NULL);
-
-			if (g_rename(localename, old) != 0)
-			{
-				g_warning(_
-					  ("geanyvc: vcdiff_file_activated: Unable to rename '%s' to '%s'"),
-					  localename, old);
-				g_rename(new, localename);
-				goto end;
-			}
-			g_rename(new, localename);
-
-			vc_external_diff(old, localename);
-			g_unlink(old);
-		      end:
-			g_free(old);
-			g_free(new);
-			g_free(localename);
+			external_diff_file(vc, doc->file_name);
 			return;
 		}
 		else
@@ -703,6 +719,41 @@ vcdiff_dir_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, gpointer data)
 	g_free(dir);
 }
 
+/* Blames the visible lines of doc first, then the lines above and below them */
+static void
+blame_file(const VC_RECORD * vc, GeanyDocument * doc)
+{
+	ScintillaObject *sci = doc->editor->sci;
+	const VC_COMMAND *command = &vc->commands[VC_COMMAND_BLAME_INCREMENTAL];
+	gchar *dir = get_command_dir(vc, VC_COMMAND_BLAME_INCREMENTAL, doc->file_name);
+	gint lines = sci_get_line_count(sci);
+	gint first, last, i;
+	gchar *ranges[3];
+	GSList *passes = NULL;
+
+	/* the empty line after a final line break is not blamed */
+	if (lines > 1 && sci_get_line_length(sci, lines - 1) == 0)
+		lines--;
+	first = scintilla_send_message(sci, SCI_DOCLINEFROMVISIBLE,
+				       scintilla_send_message(sci, SCI_GETFIRSTVISIBLELINE, 0, 0), 0) + 1;
+	first = MIN(first, lines);
+	last = MIN(first + scintilla_send_message(sci, SCI_LINESONSCREEN, 0, 0), lines);
+
+	ranges[0] = g_strdup_printf("-L%d,%d", first, last);
+	ranges[1] = first > 1 ? g_strdup_printf("-L1,%d", first - 1) : NULL;
+	ranges[2] = last < lines ? g_strdup_printf("-L%d,%d", last + 1, lines) : NULL;
+	for (i = 0; i < 3; i++)
+	{
+		if (ranges[i])
+			passes = g_slist_concat(passes, get_cmd(command->command, dir, doc->file_name,
+								NULL, ranges[i]));
+		g_free(ranges[i]);
+	}
+
+	vc_blame_start(doc, dir, passes, command->env);
+	g_free(dir);
+}
+
 static void
 vcblame_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer gdata)
 {
@@ -713,9 +764,27 @@ vcblame_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer g
 	doc = document_get_current();
 	g_return_if_fail(doc != NULL && doc->file_name != NULL);
 
+	/* activating blame again hides it */
+	if (vc_blame_shown(doc))
+	{
+		vc_blame_hide(doc);
+		return;
+	}
+
 	vc = find_vc(doc->file_name);
 	g_return_if_fail(vc);
 
+	/* blame is shown in a margin of the document if it can be parsed while it runs */
+	if (vc->commands[VC_COMMAND_BLAME_INCREMENTAL].command)
+	{
+		if (doc->changed)
+		{
+			document_save_file(doc, FALSE);
+		}
+		blame_file(vc, doc);
+		return;
+	}
+
 	execute_command(vc, &text, NULL, doc->file_name, VC_COMMAND_BLAME, NULL, NULL);
 	if (text)
 	{
@@ -733,7 +802,6 @@ vcblame_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer g
 static void
 vclog_file_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer gdata)
 {
-	gchar *output = NULL;
 	const VC_RECORD *vc;
 	GeanyDocument *doc;
 
@@ -743,19 +811,13 @@ vclog_file_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointe
 	vc = find_vc(doc->file_name);
 	g_return_if_fail(vc);
 
-	execute_command(vc, &output, NULL, doc->file_name, VC_COMMAND_LOG_FILE, NULL, NULL);
-	if (output)
-	{
-		show_output(output, "*VC-LOG*", NULL, NULL, 0);
-		g_free(output);
-	}
+	vc_log_show(vc, VC_COMMAND_LOG_FILE, VC_COMMAND_LOG_FILE_SEARCH, doc->file_name);
 }
 
 static void
 vclog_dir_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer gdata)
 {
 	gchar *base_name = NULL;
-	gchar *text = NULL;
 	const VC_RECORD *vc;
 	GeanyDocument *doc;
 
@@ -765,14 +827,8 @@ vclog_dir_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer
 	base_name = g_path_get_dirname(doc->file_name);
 
 	vc = find_vc(base_name);
-	g_return_if_fail(vc);
-
-	execute_command(vc, &text, NULL, base_name, VC_COMMAND_LOG_DIR, NULL, NULL);
-	if (text)
-	{
-		show_output(text, "*VC-LOG*", NULL, NULL, 0);
-		g_free(text);
-	}
+	if (vc)
+		vc_log_show(vc, VC_COMMAND_LOG_DIR, VC_COMMAND_LOG_DIR_SEARCH, base_name);
 
 	g_free(base_name);
 }
@@ -780,7 +836,6 @@ vclog_dir_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer
 static void
 vclog_basedir_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer gdata)
 {
-	gchar *text = NULL;
 	const VC_RECORD *vc;
 	GeanyDocument *doc;
 	gchar *basedir;
@@ -794,12 +849,7 @@ vclog_basedir_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpoi
 	basedir = vc->get_base_dir(doc->file_name);
 	g_return_if_fail(basedir);
 
-	execute_command(vc, &text, NULL, basedir, VC_COMMAND_LOG_DIR, NULL, NULL);
-	if (text)
-	{
-		show_output(text, "*VC-LOG*", NULL, NULL, 0);
-		g_free(text);
-	}
+	vc_log_show(vc, VC_COMMAND_LOG_DIR, VC_COMMAND_LOG_DIR_SEARCH, basedir);
 	g_free(basedir);
 }
 
@@ -859,6 +909,195 @@ vcshow_file_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpoint
 	}
 }
 
+/* A running fetch of the base revision of a document */
+typedef struct
+{
+	GeanyDocument *doc;
+	gchar *file_name;
+	/* the VCs still to ask for the base revision */
+	GSList *vcs;
+	GString *output;
+	guint source;
+} BaseFetch;
+
+/* the running fetches by document */
+static GHashTable *base_fetches = NULL;
+
+
+static void
+base_fetch_free(gpointer data)
+{
+	BaseFetch *fetch = data;
+
+	if (fetch->source)
+		g_source_remove(fetch->source);
+	g_slist_free(fetch->vcs);
+	g_string_free(fetch->output, TRUE);
+	g_free(fetch->file_name);
+	g_free(fetch);
+}
+
+
+/* Hands the base revision over to the change markers, if doc was not renamed meanwhile */
+static void
+base_fetch_done(BaseFetch * fetch, gchar * base)
+{
+	GeanyDocument *doc = fetch->doc;
+
+	if (DOC_VALID(doc) && utils_str_equal(doc->file_name, fetch->file_name))
+		vc_change_marks_set_base(doc, base);
+	else
+		g_free(base);
+	g_hash_table_remove(base_fetches, doc);
+}
+
+
+static void base_fetch_next(BaseFetch * fetch);
+
+
+static gboolean
+on_base_fetch_output(GIOChannel * channel, G_GNUC_UNUSED GIOCondition condition, gpointer data)
+{
+	BaseFetch *fetch = data;
+	GIOStatus status;
+	gchar buf[4096];
+	gsize len;
+	GString *tmp;
+
+	while ((status = g_io_channel_read_chars(channel, buf, sizeof(buf), &len, NULL))
+	       == G_IO_STATUS_NORMAL)
+		g_string_append_len(fetch->output, buf, len);
+	if (status == G_IO_STATUS_AGAIN)
+		return TRUE;
+
+	fetch->source = 0;
+	/* no output if the file is not in the base revision of this VC */
+	if (fetch->output->len == 0)
+	{
+		base_fetch_next(fetch);
+		return FALSE;
+	}
+
+	/* like execute_custom_command(), the text is compared with the UTF-8 buffer */
+	tmp = fetch->output;
+	fetch->output = g_string_new(NULL);
+	utils_string_replace_all(tmp, "\r\n", "\n");
+	utils_string_replace_all(tmp, "\r", "\n");
+	if (!g_utf8_validate(tmp->str, tmp->len, NULL))
+	{
+		gchar *converted = encodings_convert_to_utf8(tmp->str, tmp->len, NULL);
+
+		g_string_assign(tmp, converted ? converted : "");
+		g_free(converted);
+	}
+	base_fetch_done(fetch, g_string_free(tmp, FALSE));
+	return FALSE;
+}
+
+
+/* Runs VC_COMMAND_CAT_BASE of the next VC fetch->file_name may be in */
+static void
+base_fetch_next(BaseFetch * fetch)
+{
+	while (fetch->vcs)
+	{
+		const VC_RECORD *vc = fetch->vcs->data;
+		GIOChannel *channel;
+		gchar *base_dir, *dir = NULL;
+		gchar **argv = NULL;
+		gint out;
+		gboolean spawned = FALSE;
+
+		fetch->vcs = g_slist_delete_link(fetch->vcs, fetch->vcs);
+
+		/* only looks for the repository directory, without running the VC */
+		base_dir = vc->get_base_dir(fetch->file_name);
+		if (base_dir)
+			argv = vc_get_command_argv(vc, VC_COMMAND_CAT_BASE, fetch->file_name, NULL,
+						   &dir);
+		if (argv)
+			spawned = g_spawn_async_with_pipes(dir, argv,
+							   (gchar **) vc->commands[VC_COMMAND_CAT_BASE].env,
+							   G_SPAWN_SEARCH_PATH | G_SPAWN_STDERR_TO_DEV_NULL,
+							   NULL, NULL, NULL, NULL, &out, NULL, NULL);
+		g_strfreev(argv);
+		g_free(dir);
+		g_free(base_dir);
+		if (!spawned)
+			continue;
+
+#ifdef G_OS_WIN32
+		channel = g_io_channel_win32_new_fd(out);
+#else
+		channel = g_io_channel_unix_new(out);
+#endif
+		g_io_channel_set_encoding(channel, NULL, NULL);
+		g_io_channel_set_flags(channel, G_IO_FLAG_NONBLOCK, NULL);
+		/* the pipe is closed when the watch is removed */
+		g_io_channel_set_close_on_unref(channel, TRUE);
+		fetch->source = g_io_add_watch(channel, G_IO_IN | G_IO_HUP | G_IO_ERR,
+					       on_base_fetch_output, fetch);
+		g_io_channel_unref(channel);
+		return;
+	}
+
+	/* not under version control */
+	base_fetch_done(fetch, NULL);
+}
+
+
+/* Fetches the base revision of doc in the background, once for each name of doc,
+ * to mark its changed lines */
+static void
+fetch_change_marks_base(GeanyDocument * doc)
+{
+	BaseFetch *fetch;
+
+	if (!set_change_markers || !DOC_VALID(doc) || doc->file_name == NULL
+	    || !g_path_is_absolute(doc->file_name) || vc_change_marks_has_base(doc))
+		return;
+
+	if (base_fetches == NULL)
+		base_fetches = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+						     base_fetch_free);
+
+	fetch = g_hash_table_lookup(base_fetches, doc);
+	if (fetch != NULL && utils_str_equal(fetch->file_name, doc->file_name))
+		return;
+
+	fetch = g_new0(BaseFetch, 1);
+	fetch->doc = doc;
+	fetch->file_name = g_strdup(doc->file_name);
+	fetch->vcs = g_slist_copy(VC);
+	fetch->output = g_string_new(NULL);
+	/* replaces a fetch for a former name of doc */
+	g_hash_table_insert(base_fetches, doc, fetch);
+	base_fetch_next(fetch);
+}
+
+
+/* Stops the fetch of the base revision of doc, or of all documents if doc is NULL */
+static void
+cancel_change_marks_base(GeanyDocument * doc)
+{
+	if (base_fetches == NULL)
+		return;
+
+	if (doc)
+		g_hash_table_remove(base_fetches, doc);
+	else
+		g_hash_table_remove_all(base_fetches);
+}
+
+/* Forgets the base revisions after a VC command which may have changed them */
+static void
+reset_change_marks(void)
+{
+	cancel_change_marks_base(NULL);
+	vc_change_marks_remove_all();
+	fetch_change_marks_base(document_get_current());
+}
+
 static gboolean
 command_with_question_activated(gchar ** text, gint cmd, const gchar * question, gint flags)
 {
@@ -909,6 +1148,7 @@ command_with_question_activated(gchar ** text, gint cmd, const gchar * question,
 			execute_command(vc, text, NULL, dir, cmd, NULL, NULL);
 		if (flags & FLAG_RELOAD)
 			document_reload_file(doc, NULL);
+		reset_change_marks();
 	}
 	g_free(dir);
 	return (result == GTK_RESPONSE_YES);
@@ -1635,6 +1875,7 @@ vccommit_activated(G_GNUC_UNUSED GtkMenuItem * menuitem, G_GNUC_UNUSED gpointer
 			execute_command(vc, NULL, NULL, dir, VC_COMMAND_COMMIT, selected_files,
 					message);
 			free_text_list(selected_files);
+			reset_change_marks();
 		}
 		g_free(message);
 	}
@@ -1776,6 +2017,7 @@ static struct
 	GtkWidget *cb_external_diff;
 	GtkWidget *cb_editor_menu_entries;
 	GtkWidget *cb_attach_to_menubar;
+	GtkWidget *cb_change_markers;
 	GtkWidget *cb_cvs;
 	GtkWidget *cb_git;
 	GtkWidget *cb_svn;
@@ -1812,6 +2054,8 @@ on_configure_response(G_GNUC_UNUSED GtkDialog * dialog, gint response,
 			gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets.cb_editor_menu_entries));
 		set_menubar_entry =
 			gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets.cb_attach_to_menubar));
+		set_change_markers =
+			gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets.cb_change_markers));
 
 		enable_cvs = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets.cb_cvs));
 		enable_git = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets.cb_git));
@@ -1834,6 +2078,7 @@ on_configure_response(G_GNUC_UNUSED GtkDialog * dialog, gint response,
 				       set_maximize_commit_dialog);
 		g_key_file_set_boolean(config, "VC", "set_editor_menu_entries", set_editor_menu_entries);
 		g_key_file_set_boolean(config, "VC", "attach_to_menubar", set_menubar_entry);
+		g_key_file_set_boolean(config, "VC", "set_change_markers", set_change_markers);
 
 		g_key_file_set_boolean(config, "VC", "enable_cvs", enable_cvs);
 		g_key_file_set_boolean(config, "VC", "enable_git", enable_git);
@@ -1871,6 +2116,7 @@ on_configure_response(G_GNUC_UNUSED GtkDialog * dialog, gint response,
 		g_key_file_free(config);
 
 		registrate();
+		reset_change_marks();
 	}
 }
 
@@ -1939,6 +2185,15 @@ plugin_configure(GtkDialog * dialog)
 		set_menubar_entry);
 	gtk_box_pack_start(GTK_BOX(vbox), widgets.cb_attach_to_menubar, TRUE, FALSE, 2);
 
+	widgets.cb_change_markers = gtk_check_button_new_with_label(_("Mark changed lines"));
+	ui_widget_set_tooltip_text(widgets.cb_change_markers,
+			     _("Mark added, modified and deleted lines in the markers margin. "
+			       "The base revision of a file is fetched once when it is opened."));
+	gtk_button_set_focus_on_click(GTK_BUTTON(widgets.cb_change_markers), FALSE);
+	gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets.cb_change_markers),
+		set_change_markers);
+	gtk_box_pack_start(GTK_BOX(vbox), widgets.cb_change_markers, TRUE, FALSE, 2);
+
 	widgets.cb_cvs = gtk_check_button_new_with_label(_("Enable CVS"));
 	gtk_button_set_focus_on_click(GTK_BUTTON(widgets.cb_cvs), FALSE);
 	gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets.cb_cvs), enable_cvs);
@@ -2021,6 +2276,8 @@ load_config(void)
 		TRUE);
 	set_menubar_entry = utils_get_setting_boolean(config, "VC", "attach_to_menubar",
 		FALSE);
+	set_change_markers = utils_get_setting_boolean(config, "VC", "set_change_markers",
+		FALSE);
 
 #ifdef USE_GTKSPELL
 	lang = g_key_file_get_string(config, "VC", "spellchecking_language", &error);
@@ -2288,6 +2545,47 @@ init_keybindings(void)
 			     _("Update file"), menu_vc_update);
 }
 
+static void
+on_document_activate(G_GNUC_UNUSED GObject * obj, GeanyDocument * doc,
+		     G_GNUC_UNUSED gpointer user_data)
+{
+	fetch_change_marks_base(doc);
+}
+
+static void
+on_document_close(G_GNUC_UNUSED GObject * obj, GeanyDocument * doc,
+		  G_GNUC_UNUSED gpointer user_data)
+{
+	cancel_change_marks_base(doc);
+	vc_change_marks_remove(doc);
+	vc_blame_hide(doc);
+}
+
+static gboolean
+on_editor_notify(G_GNUC_UNUSED GObject * obj, GeanyEditor * editor, SCNotification * nt,
+		 G_GNUC_UNUSED gpointer user_data)
+{
+	if (nt->nmhdr.code == SCN_MODIFIED
+	    && (nt->modificationType & (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT)))
+	{
+		vc_change_marks_schedule(editor->document);
+		/* the lines of a running blame would not match anymore */
+		if (nt->linesAdded != 0)
+			vc_blame_stop(editor->document);
+	}
+	return FALSE;
+}
+
+PluginCallback plugin_callbacks[] = {
+	{"document-open", (GCallback) & on_document_activate, TRUE, NULL},
+	{"document-activate", (GCallback) & on_document_activate, TRUE, NULL},
+	/* the document may have been saved under a new name */
+	{"document-save", (GCallback) & on_document_activate, TRUE, NULL},
+	{"document-close", (GCallback) & on_document_close, TRUE, NULL},
+	{"editor-notify", (GCallback) & on_editor_notify, FALSE, NULL},
+	{NULL, NULL, FALSE, NULL}
+};
+
 /* Called by Geany to initialize the plugin */
 void
 plugin_init(G_GNUC_UNUSED GeanyData * data)
@@ -2378,6 +2676,13 @@ plugin_init(G_GNUC_UNUSED GeanyData * data)
 void
 plugin_cleanup(void)
 {
+	cancel_change_marks_base(NULL);
+	if (base_fetches)
+		g_hash_table_destroy(base_fetches);
+	base_fetches = NULL;
+	vc_change_marks_remove_all();
+	vc_blame_hide_all();
+	vc_log_close();
 	remove_menuitems_from_editor_menu();
 	gtk_widget_destroy(menu_entry);
 	g_slist_free(VC);
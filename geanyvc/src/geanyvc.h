@@ -37,6 +37,10 @@ enum
 	VC_COMMAND_BLAME,
 	VC_COMMAND_SHOW,
 	VC_COMMAND_UPDATE,
+	VC_COMMAND_CAT_BASE,
+	VC_COMMAND_BLAME_INCREMENTAL,
+	VC_COMMAND_LOG_FILE_SEARCH,
+	VC_COMMAND_LOG_DIR_SEARCH,
 	VC_COMMAND_COUNT
 };
 
@@ -136,7 +140,29 @@ extern const gchar *NO_ENV[];
 
 /* External diff viewer */
 const gchar *get_external_diff_viewer(void);
-void vc_external_diff(const gchar * src, const gchar * dest);
+void vc_external_diff_base(const gchar * dir, gchar ** argv, const gchar ** env,
+			   const gchar * localename);
+
+/* Change markers */
+void vc_change_marks_set_base(GeanyDocument * doc, gchar * base);
+gboolean vc_change_marks_has_base(GeanyDocument * doc);
+void vc_change_marks_update(GeanyDocument * doc);
+void vc_change_marks_schedule(GeanyDocument * doc);
+void vc_change_marks_remove(GeanyDocument * doc);
+void vc_change_marks_remove_all(void);
+
+/* Blame margin */
+void vc_blame_start(GeanyDocument * doc, const gchar * dir, GSList * passes, const gchar ** env);
+gboolean vc_blame_shown(GeanyDocument * doc);
+void vc_blame_stop(GeanyDocument * doc);
+void vc_blame_hide(GeanyDocument * doc);
+void vc_blame_hide_all(void);
+
+/* Log window */
+gchar **vc_get_command_argv(const VC_RECORD * vc, gint cmd, const gchar * filename,
+			    const gchar * message, gchar ** dir);
+void vc_log_show(const VC_RECORD * vc, gint cmd, gint search_cmd, const gchar * filename);
+void vc_log_close(void);
 
 /* utils.c */
 gchar *normpath(const gchar * filename);
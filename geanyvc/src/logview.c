@@ -0,0 +1,401 @@
+/*
+ *      logview.c - Plugin to geany light IDE to work with vc
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License
+ *      along with this program; if not, write to the Free Software
+ *      Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Log window. The log command runs asynchronously and its output is read a page at a
+ * time: while no page is wanted the output is not read, so the command waits on the full
+ * pipe instead of producing the whole history. The next page is read when the view is
+ * scrolled near its end.
+ */
+
+#include <string.h>
+
+#include <geanyplugin.h>
+#include <gdk/gdkkeysyms.h>
+#include "geanyvc.h"
+
+extern GeanyData *geany_data;
+extern GeanyFunctions *geany_functions;
+
+
+/* lines read per page */
+#define LOG_PAGE_LINES 1000
+
+enum
+{
+	LOG_COLUMN_TEXT,
+	LOG_NUM_COLUMNS
+};
+
+typedef struct
+{
+	GtkWidget *window;
+	GtkWidget *entry;
+	GtkWidget *view;
+	GtkWidget *label;
+	GtkListStore *store;
+	GtkTreeViewColumn *column;
+
+	const VC_RECORD *vc;
+	gint cmd;
+	gint search_cmd;
+	gchar *filename;
+
+	GIOChannel *channel;
+	/* output watch while a page is read, 0 while the command waits */
+	guint source;
+	gint page_left;
+	gint lines;
+	gboolean done;
+	/* width of the widest line so far, in characters */
+	gint max_chars;
+	gint char_width;
+} LogView;
+
+static LogView *log_view = NULL;
+
+
+static void
+update_label(void)
+{
+	gchar *text;
+
+	if (log_view->done)
+		text = g_strdup_printf(_("%d lines"), log_view->lines);
+	else if (log_view->source)
+		text = g_strdup_printf(_("%d lines, reading..."), log_view->lines);
+	else
+		text = g_strdup_printf(_("%d lines, scroll down for more"), log_view->lines);
+	gtk_label_set_text(GTK_LABEL(log_view->label), text);
+	g_free(text);
+}
+
+
+/* closes the output of a running command, which makes it exit */
+static void
+stop_command(void)
+{
+	if (log_view->source)
+	{
+		g_source_remove(log_view->source);
+		log_view->source = 0;
+	}
+	if (log_view->channel)
+	{
+		g_io_channel_unref(log_view->channel);
+		log_view->channel = NULL;
+	}
+}
+
+
+static void
+append_line(gchar * line, gsize len)
+{
+	GtkTreeIter iter;
+	gchar *text = NULL;
+	gint chars;
+
+	if (!g_utf8_validate(line, len, NULL))
+		text = encodings_convert_to_utf8(line, len, NULL);
+	if (text == NULL && !g_utf8_validate(line, len, NULL))
+		text = g_strescape(line, NULL);
+
+	gtk_list_store_insert_with_values(log_view->store, &iter, -1,
+					  LOG_COLUMN_TEXT, text ? text : line, -1);
+	chars = g_utf8_strlen(text ? text : line, -1);
+	log_view->max_chars = MAX(log_view->max_chars, chars);
+	log_view->lines++;
+	g_free(text);
+}
+
+
+static void read_page(void);
+
+
+static gboolean
+on_log_output(GIOChannel * channel, G_GNUC_UNUSED GIOCondition condition,
+	      G_GNUC_UNUSED gpointer data)
+{
+	GIOStatus status = G_IO_STATUS_NORMAL;
+	gchar *line;
+	gsize len, term;
+
+	while (log_view->page_left > 0
+	       && (status = g_io_channel_read_line(channel, &line, &len, &term, NULL))
+	       == G_IO_STATUS_NORMAL)
+	{
+		line[term] = '\0';
+		append_line(line, term);
+		g_free(line);
+		log_view->page_left--;
+	}
+
+	if (status != G_IO_STATUS_NORMAL && status != G_IO_STATUS_AGAIN)
+	{
+		log_view->source = 0;
+		stop_command();
+		log_view->done = TRUE;
+	}
+	else if (log_view->page_left == 0)
+		/* the command waits until the next page is wanted */
+		log_view->source = 0;
+
+	gtk_tree_view_column_set_fixed_width(log_view->column,
+					     (log_view->max_chars + 2) * log_view->char_width);
+	update_label();
+	return log_view->source != 0;
+}
+
+
+static void
+read_page(void)
+{
+	if (log_view->done || log_view->source || log_view->channel == NULL)
+		return;
+
+	log_view->page_left = LOG_PAGE_LINES;
+	log_view->source = g_io_add_watch(log_view->channel, G_IO_IN | G_IO_HUP | G_IO_ERR,
+					  on_log_output, NULL);
+	update_label();
+}
+
+
+/* reads the next page when less than a screen of lines is left below the visible ones */
+static void
+on_scrolled(GtkAdjustment * adj, G_GNUC_UNUSED gpointer data)
+{
+	if (adj->value + 2 * adj->page_size >= adj->upper)
+		read_page();
+}
+
+
+/* runs cmd, with message as the text to search for */
+static void
+start_command(gint cmd, const gchar * message)
+{
+	gchar *dir;
+	gchar **argv;
+	GError *error = NULL;
+	gint out;
+
+	stop_command();
+	gtk_list_store_clear(log_view->store);
+	log_view->lines = 0;
+	log_view->max_chars = 0;
+	log_view->done = TRUE;
+
+	argv = vc_get_command_argv(log_view->vc, cmd, log_view->filename, message, &dir);
+	if (argv == NULL || !g_spawn_async_with_pipes(dir, argv,
+						      (gchar **) log_view->vc->commands[cmd].env,
+						      G_SPAWN_SEARCH_PATH | G_SPAWN_STDERR_TO_DEV_NULL,
+						      NULL, NULL, NULL, NULL, &out, NULL, &error))
+	{
+		if (error)
+		{
+			g_warning("geanyvc: g_spawn_async_with_pipes error: %s", error->message);
+			ui_set_statusbar(FALSE, _("geanyvc: g_spawn_async_with_pipes error: %s"),
+					 error->message);
+			g_error_free(error);
+		}
+		g_strfreev(argv);
+		g_free(dir);
+		update_label();
+		return;
+	}
+	g_strfreev(argv);
+	g_free(dir);
+
+#ifdef G_OS_WIN32
+	log_view->channel = g_io_channel_win32_new_fd(out);
+#else
+	log_view->channel = g_io_channel_unix_new(out);
+#endif
+	g_io_channel_set_encoding(log_view->channel, NULL, NULL);
+	g_io_channel_set_flags(log_view->channel, G_IO_FLAG_NONBLOCK, NULL);
+	g_io_channel_set_close_on_unref(log_view->channel, TRUE);
+	log_view->done = FALSE;
+	read_page();
+}
+
+
+static void
+on_search_activate(GtkEntry * entry, G_GNUC_UNUSED gpointer data)
+{
+	const gchar *text = gtk_entry_get_text(entry);
+
+	if (EMPTY(text))
+		start_command(log_view->cmd, NULL);
+	else
+		start_command(log_view->search_cmd, text);
+}
+
+
+static void
+copy_selected_line(GtkTreeModel * model, G_GNUC_UNUSED GtkTreePath * path, GtkTreeIter * iter,
+		   gpointer data)
+{
+	GString *str = data;
+	gchar *text;
+
+	gtk_tree_model_get(model, iter, LOG_COLUMN_TEXT, &text, -1);
+	g_string_append(str, text);
+	g_string_append_c(str, '\n');
+	g_free(text);
+}
+
+
+static gboolean
+on_view_key_press(GtkWidget * widget, GdkEventKey * event, G_GNUC_UNUSED gpointer data)
+{
+	if ((event->state & GDK_CONTROL_MASK) && (event->keyval == GDK_c || event->keyval == GDK_C))
+	{
+		GtkTreeSelection *selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(widget));
+		GString *str = g_string_new(NULL);
+
+		gtk_tree_selection_selected_foreach(selection, copy_selected_line, str);
+		gtk_clipboard_set_text(gtk_clipboard_get(GDK_SELECTION_CLIPBOARD), str->str, str->len);
+		g_string_free(str, TRUE);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+
+static void
+on_window_destroy(G_GNUC_UNUSED GtkWidget * widget, G_GNUC_UNUSED gpointer data)
+{
+	stop_command();
+	g_object_unref(log_view->store);
+	g_free(log_view->filename);
+	g_free(log_view);
+	log_view = NULL;
+}
+
+
+static void
+create_window(void)
+{
+	GtkWidget *vbox, *hbox, *swin;
+	GtkCellRenderer *renderer;
+	PangoLayout *layout;
+	PangoFontDescription *font;
+
+	log_view = g_new0(LogView, 1);
+	log_view->store = gtk_list_store_new(LOG_NUM_COLUMNS, G_TYPE_STRING);
+
+	log_view->window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+	gtk_window_set_transient_for(GTK_WINDOW(log_view->window),
+				     GTK_WINDOW(geany->main_widgets->window));
+	gtk_window_set_destroy_with_parent(GTK_WINDOW(log_view->window), TRUE);
+	gtk_window_set_default_size(GTK_WINDOW(log_view->window), 700, 500);
+	gtk_container_set_border_width(GTK_CONTAINER(log_view->window), 5);
+	g_signal_connect(log_view->window, "destroy", G_CALLBACK(on_window_destroy), NULL);
+
+	vbox = gtk_vbox_new(FALSE, 6);
+	gtk_container_add(GTK_CONTAINER(log_view->window), vbox);
+
+	hbox = gtk_hbox_new(FALSE, 6);
+	gtk_box_pack_start(GTK_BOX(hbox), gtk_label_new(_("Search:")), FALSE, FALSE, 0);
+	log_view->entry = gtk_entry_new();
+	ui_widget_set_tooltip_text(log_view->entry,
+				   _("Shows only the commits matching the text, searched by the "
+				     "version control system. An empty text shows the whole log."));
+	g_signal_connect(log_view->entry, "activate", G_CALLBACK(on_search_activate), NULL);
+	gtk_box_pack_start(GTK_BOX(hbox), log_view->entry, TRUE, TRUE, 0);
+	gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+	log_view->view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(log_view->store));
+	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(log_view->view), FALSE);
+	gtk_tree_selection_set_mode(gtk_tree_view_get_selection(GTK_TREE_VIEW(log_view->view)),
+				    GTK_SELECTION_MULTIPLE);
+	g_signal_connect(log_view->view, "key-press-event", G_CALLBACK(on_view_key_press), NULL);
+
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", NULL);
+	log_view->column = gtk_tree_view_column_new_with_attributes(NULL, renderer,
+								    "text", LOG_COLUMN_TEXT, NULL);
+	/* all rows have the same height, so only the visible ones are measured */
+	gtk_tree_view_column_set_sizing(log_view->column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(log_view->view), log_view->column);
+	gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(log_view->view), TRUE);
+
+	layout = gtk_widget_create_pango_layout(log_view->view, "0");
+	font = pango_font_description_from_string("Monospace");
+	pango_layout_set_font_description(layout, font);
+	pango_layout_get_pixel_size(layout, &log_view->char_width, NULL);
+	pango_font_description_free(font);
+	g_object_unref(layout);
+
+	swin = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(swin), GTK_POLICY_AUTOMATIC,
+				       GTK_POLICY_AUTOMATIC);
+	gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(swin), GTK_SHADOW_IN);
+	gtk_container_add(GTK_CONTAINER(swin), log_view->view);
+	gtk_box_pack_start(GTK_BOX(vbox), swin, TRUE, TRUE, 0);
+	g_signal_connect(gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(swin)),
+			 "value-changed", G_CALLBACK(on_scrolled), NULL);
+	g_signal_connect(gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(swin)),
+			 "changed", G_CALLBACK(on_scrolled), NULL);
+
+	log_view->label = gtk_label_new(NULL);
+	gtk_misc_set_alignment(GTK_MISC(log_view->label), 0, 0.5);
+	gtk_box_pack_start(GTK_BOX(vbox), log_view->label, FALSE, FALSE, 0);
+
+	gtk_widget_show_all(log_view->window);
+}
+
+
+/*
+ * Shows the log of filename in the log window, which is reused if it is open.
+ *
+ * @cmd - the log command
+ * @search_cmd - the log command searching for MESSAGE, the search entry is hidden if the
+ *               version control system has none
+ */
+void
+vc_log_show(const VC_RECORD * vc, gint cmd, gint search_cmd, const gchar * filename)
+{
+	gchar *title;
+
+	if (log_view == NULL)
+		create_window();
+
+	log_view->vc = vc;
+	log_view->cmd = cmd;
+	log_view->search_cmd = search_cmd;
+	setptr(log_view->filename, g_strdup(filename));
+
+	title = g_strdup_printf(_("Log of %s"), filename);
+	gtk_window_set_title(GTK_WINDOW(log_view->window), title);
+	g_free(title);
+
+	gtk_entry_set_text(GTK_ENTRY(log_view->entry), "");
+	gtk_widget_set_sensitive(log_view->entry, vc->commands[search_cmd].command != NULL);
+
+	start_command(cmd, NULL);
+	gtk_window_present(GTK_WINDOW(log_view->window));
+}
+
+
+/* Closes the log window */
+void
+vc_log_close(void)
+{
+	if (log_view)
+		gtk_widget_destroy(log_view->window);
+}
@@ -139,6 +139,283 @@ get_relative_path(const gchar * location, const gchar * path)
 }
 
 
+/* a line of text to diff, without its line ending */
+typedef struct
+{
+	guint hash;
+	gsize len;
+	const gchar *text;
+} DiffLine;
+
+/* an exact diff is given up after about twice this many inserted and deleted lines */
+#define DIFF_MAX_COST 4096
+
+
+static gboolean
+is_line_start(const gchar * text, gsize pos)
+{
+	return pos == 0 || text[pos - 1] == '\n';
+}
+
+
+static gint
+count_lines(const gchar * text, gsize len)
+{
+	const gchar *end = text + len;
+	gint lines = 0;
+
+	while ((text = memchr(text, '\n', end - text)) != NULL)
+	{
+		lines++;
+		text++;
+	}
+	return lines;
+}
+
+
+/* splits text into hashed lines, \n, \r\n and \r all end a line */
+static GArray *
+split_lines(const gchar * text, gsize len)
+{
+	GArray *lines = g_array_sized_new(FALSE, FALSE, sizeof(DiffLine),
+					  count_lines(text, len) + 1);
+	gsize pos = 0;
+
+	while (pos < len)
+	{
+		DiffLine line;
+
+		line.hash = 5381;
+		line.text = text + pos;
+		while (pos < len && text[pos] != '\n' && text[pos] != '\r')
+			line.hash = (line.hash << 5) + line.hash + (guchar) text[pos++];
+		line.len = text + pos - line.text;
+		g_array_append_val(lines, line);
+
+		if (pos < len && text[pos] == '\r')
+			pos++;
+		if (pos < len && text[pos] == '\n')
+			pos++;
+	}
+	return lines;
+}
+
+
+static gboolean
+lines_equal(const DiffLine * a, const DiffLine * b)
+{
+	return a->hash == b->hash && a->len == b->len && memcmp(a->text, b->text, a->len) == 0;
+}
+
+
+typedef struct
+{
+	const DiffLine *a;
+	const DiffLine *b;
+	gchar *a_changed;
+	gchar *b_changed;
+	/* furthest reaching forward and backward paths, indexed by diagonal */
+	gint *vf;
+	gint *vb;
+} DiffContext;
+
+
+/*
+ * Finds the middle snake of the shortest edit script of a and b as in Myers' linear space
+ * O(ND) diff. Returns the length of the script, or -1 if it is longer than 2 * DIFF_MAX_COST.
+ */
+static gint
+diff_middle_snake(DiffContext * ctx, const DiffLine * a, gint n, const DiffLine * b, gint m,
+		  gint * xs, gint * ys, gint * xe, gint * ye)
+{
+	gint *vf = ctx->vf;
+	gint *vb = ctx->vb;
+	gint delta = n - m;
+	gboolean odd = delta & 1;
+	gint max_d = MIN((n + m + 1) / 2, DIFF_MAX_COST);
+	gint d, k, x, y;
+
+	vf[1] = 0;
+	vb[1] = 0;
+	for (d = 0; d <= max_d; d++)
+	{
+		for (k = -d; k <= d; k += 2)
+		{
+			if (k == -d || (k != d && vf[k - 1] < vf[k + 1]))
+				x = vf[k + 1];
+			else
+				x = vf[k - 1] + 1;
+			y = x - k;
+			*xs = x;
+			*ys = y;
+			while (x < n && y < m && lines_equal(&a[x], &b[y]))
+			{
+				x++;
+				y++;
+			}
+			vf[k] = x;
+			if (odd && delta - k >= -(d - 1) && delta - k <= d - 1
+			    && x + vb[delta - k] >= n)
+			{
+				*xe = x;
+				*ye = y;
+				return 2 * d - 1;
+			}
+		}
+		/* the backward paths run on the reversed lines */
+		for (k = -d; k <= d; k += 2)
+		{
+			if (k == -d || (k != d && vb[k - 1] < vb[k + 1]))
+				x = vb[k + 1];
+			else
+				x = vb[k - 1] + 1;
+			y = x - k;
+			*xe = n - x;
+			*ye = m - y;
+			while (x < n && y < m && lines_equal(&a[n - x - 1], &b[m - y - 1]))
+			{
+				x++;
+				y++;
+			}
+			vb[k] = x;
+			if (!odd && delta - k >= -d && delta - k <= d && x + vf[delta - k] >= n)
+			{
+				*xs = n - x;
+				*ys = m - y;
+				return 2 * d;
+			}
+		}
+	}
+	return -1;
+}
+
+
+/* marks the deleted lines of a and the inserted lines of b in the given ranges */
+static void
+diff_lines(DiffContext * ctx, gint a0, gint n, gint b0, gint m)
+{
+	gint xs, ys, xe, ye;
+
+	while (n > 0 && m > 0 && lines_equal(&ctx->a[a0], &ctx->b[b0]))
+	{
+		a0++;
+		b0++;
+		n--;
+		m--;
+	}
+	while (n > 0 && m > 0 && lines_equal(&ctx->a[a0 + n - 1], &ctx->b[b0 + m - 1]))
+	{
+		n--;
+		m--;
+	}
+
+	if (n == 0 || m == 0)
+	{
+		memset(ctx->a_changed + a0, TRUE, n);
+		memset(ctx->b_changed + b0, TRUE, m);
+	}
+	/* without common first and last lines the script has at least two edits,
+	 * so both halves are smaller than the range */
+	else if (diff_middle_snake(ctx, ctx->a + a0, n, ctx->b + b0, m, &xs, &ys, &xe, &ye) > 0)
+	{
+		diff_lines(ctx, a0, xs, b0, ys);
+		diff_lines(ctx, a0 + xe, n - xe, b0 + ye, m - ye);
+	}
+	else
+	{
+		/* too many changes, report the whole range as changed */
+		memset(ctx->a_changed + a0, TRUE, n);
+		memset(ctx->b_changed + b0, TRUE, m);
+	}
+}
+
+
+/*
+ * Compares text against base line by line and returns the changed lines of text as an
+ * array of VC_CHANGE, sorted by line. Line endings are ignored.
+ */
+GArray *
+vc_diff_get_changes(const gchar * base, gsize base_len, const gchar * text, gsize text_len)
+{
+	GArray *changes = g_array_new(FALSE, FALSE, sizeof(VC_CHANGE));
+	GArray *a_lines, *b_lines;
+	gchar *a_changed, *b_changed;
+	DiffContext ctx;
+	gsize prefix = 0, suffix = 0, min_len = MIN(base_len, text_len);
+	gint first_line, n, m, i, j;
+
+	/* unchanged lines at the start and the end are skipped before splitting */
+	while (prefix < min_len && base[prefix] == text[prefix])
+		prefix++;
+	while (prefix > 0 && base[prefix - 1] != '\n')
+		prefix--;
+	while (suffix < min_len - prefix
+	       && base[base_len - suffix - 1] == text[text_len - suffix - 1])
+		suffix++;
+	if (!is_line_start(base, base_len - suffix) || !is_line_start(text, text_len - suffix))
+	{
+		const gchar *nl = memchr(text + text_len - suffix, '\n', suffix);
+
+		suffix = nl ? (gsize) (text + text_len - nl - 1) : 0;
+	}
+	first_line = count_lines(text, prefix);
+
+	a_lines = split_lines(base + prefix, base_len - prefix - suffix);
+	b_lines = split_lines(text + prefix, text_len - prefix - suffix);
+	n = a_lines->len;
+	m = b_lines->len;
+	a_changed = g_malloc0(n + 1);
+	b_changed = g_malloc0(m + 1);
+
+	ctx.a = (DiffLine *) a_lines->data;
+	ctx.b = (DiffLine *) b_lines->data;
+	ctx.a_changed = a_changed;
+	ctx.b_changed = b_changed;
+	ctx.vf = g_new(gint, 2 * DIFF_MAX_COST + 5) + DIFF_MAX_COST + 2;
+	ctx.vb = g_new(gint, 2 * DIFF_MAX_COST + 5) + DIFF_MAX_COST + 2;
+	diff_lines(&ctx, 0, n, 0, m);
+	g_free(ctx.vf - DIFF_MAX_COST - 2);
+	g_free(ctx.vb - DIFF_MAX_COST - 2);
+
+	i = j = 0;
+	while (i < n || j < m)
+	{
+		VC_CHANGE change;
+		gint deleted = i;
+
+		if (i < n && j < m && !a_changed[i] && !b_changed[j])
+		{
+			i++;
+			j++;
+			continue;
+		}
+		while (i < n && a_changed[i])
+			i++;
+		change.line = first_line + j;
+		while (j < m && b_changed[j])
+			j++;
+		change.count = first_line + j - change.line;
+		deleted = i - deleted;
+
+		if (change.count == 0 && deleted == 0)
+			break;
+		if (change.count == 0)
+			change.type = VC_CHANGE_DELETED;
+		else if (deleted == 0)
+			change.type = VC_CHANGE_ADDED;
+		else
+			change.type = VC_CHANGE_MODIFIED;
+		g_array_append_val(changes, change);
+	}
+
+	g_free(a_changed);
+	g_free(b_changed);
+	g_array_free(a_lines, TRUE);
+	g_array_free(b_lines, TRUE);
+	return changes;
+}
+
+
 #ifdef UNITTESTS
 #include <check.h>
 
@@ -156,12 +433,50 @@ START_TEST(test_get_relative_path)
 
 END_TEST;
 
+static void
+check_changes(const gchar * base, const gchar * text, const VC_CHANGE * expected, guint n)
+{
+	GArray *changes = vc_diff_get_changes(base, strlen(base), text, strlen(text));
+	guint i;
+
+	fail_unless(changes->len == n, "expected %u changes, get %u\n", n, changes->len);
+	for (i = 0; i < n; i++)
+	{
+		VC_CHANGE *change = &g_array_index(changes, VC_CHANGE, i);
+		fail_unless(change->type == expected[i].type && change->line == expected[i].line
+			    && change->count == expected[i].count,
+			    "change %u: expected (%d, %d, %d), get (%d, %d, %d)\n", i,
+			    expected[i].type, expected[i].line, expected[i].count,
+			    change->type, change->line, change->count);
+	}
+	g_array_free(changes, TRUE);
+}
+
+START_TEST(test_diff_get_changes)
+{
+	const VC_CHANGE added[] = { { VC_CHANGE_ADDED, 1, 2 } };
+	const VC_CHANGE modified[] = { { VC_CHANGE_MODIFIED, 2, 1 } };
+	const VC_CHANGE deleted[] = { { VC_CHANGE_DELETED, 1, 0 } };
+	const VC_CHANGE mixed[] = { { VC_CHANGE_DELETED, 0, 0 }, { VC_CHANGE_MODIFIED, 1, 1 },
+		{ VC_CHANGE_ADDED, 3, 1 } };
+
+	check_changes("a\nb\nc\n", "a\nb\nc\n", NULL, 0);
+	check_changes("a\nb\nc\n", "a\r\nb\r\nc", NULL, 0);
+	check_changes("a\nb\n", "a\nx\ny\nb\n", added, 1);
+	check_changes("a\nb\nc\nd\n", "a\nb\nx\nd\n", modified, 1);
+	check_changes("a\nb\nc\n", "a\nc\n", deleted, 1);
+	check_changes("a\nb\nc\nd\n", "b\nx\nd\ny\n", mixed, 3);
+}
+
+END_TEST;
+
 
 TCase *
 utils_test_case_create(void)
 {
 	TCase *tc_utils = tcase_create("utils");
 	tcase_add_test(tc_utils, test_get_relative_path);
+	tcase_add_test(tc_utils, test_diff_get_changes);
 	return tc_utils;
 }
 
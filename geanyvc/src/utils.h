@@ -24,4 +24,23 @@ gchar *normpath(const gchar * filename);
 gchar *get_full_path(const gchar * location, const gchar * path);
 gchar *get_relative_path(const gchar * location, const gchar * path);
 
+enum
+{
+	VC_CHANGE_ADDED,
+	VC_CHANGE_MODIFIED,
+	VC_CHANGE_DELETED
+};
+
+/* lines of a text changed against its base, deleted lines have count 0 and
+ * line is the line following them */
+typedef struct _VC_CHANGE
+{
+	gint type;
+	gint line;
+	gint count;
+} VC_CHANGE;
+
+GArray *vc_diff_get_changes(const gchar * base, gsize base_len, const gchar * text,
+			    gsize text_len);
+
 #endif
@@ -39,8 +39,9 @@ static const gchar *BZR_CMD_COMMIT[] = { "bzr", "commit", "-m", MESSAGE, FILE_LI
 static const gchar *BZR_CMD_BLAME[] = { "bzr", "blame", "--all", "--long", BASENAME, NULL };
 static const gchar *BZR_CMD_SHOW[] = { "bzr", "cat", BASENAME, NULL };
 static const gchar *BZR_CMD_UPDATE[] = { "bzr", "pull", NULL };
+static const gchar *BZR_CMD_CAT_BASE[] = { "bzr", "cat", BASENAME, NULL };
 
-static const VC_COMMAND commands[] = {
+static const VC_COMMAND commands[VC_COMMAND_COUNT] = {
 	{
 		VC_COMMAND_STARTDIR_FILE,
 		BZR_CMD_DIFF_FILE,
@@ -105,6 +106,11 @@ static const VC_COMMAND commands[] = {
 		VC_COMMAND_STARTDIR_BASE,
 		BZR_CMD_UPDATE,
 		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		BZR_CMD_CAT_BASE,
+		NULL,
 		NULL}
 };
 
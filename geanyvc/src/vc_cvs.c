@@ -38,8 +38,9 @@ static const gchar *CVS_CMD_COMMIT[] = { "cvs", "commit", "-m", MESSAGE, FILE_LI
 static const gchar *CVS_CMD_BLAME[] = { "cvs", "annotate", BASE_FILENAME, NULL };
 static const gchar *CVS_CMD_SHOW[] = { "cvs", NULL };
 static const gchar *CVS_CMD_UPDATE[] = { "cvs", "up", "-d", NULL };
+static const gchar *CVS_CMD_CAT_BASE[] = { "cvs", "-Q", "update", "-p", "-r", "BASE", BASENAME, NULL };
 
-static const VC_COMMAND commands[] = {
+static const VC_COMMAND commands[VC_COMMAND_COUNT] = {
 	{
 		VC_COMMAND_STARTDIR_FILE,
 		CVS_CMD_DIFF_FILE,
@@ -104,6 +105,11 @@ static const VC_COMMAND commands[] = {
 		VC_COMMAND_STARTDIR_BASE,
 		CVS_CMD_UPDATE,
 		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		CVS_CMD_CAT_BASE,
+		NULL,
 		NULL}
 };
 
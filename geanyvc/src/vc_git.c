@@ -97,6 +97,14 @@ static const gchar *GIT_CMD_LOG_FILE[] = { "git", "log", "--", BASENAME, NULL };
 static const gchar *GIT_CMD_LOG_DIR[] = { "git", "log", NULL };
 static const gchar *GIT_CMD_BLAME[] = { "git", "blame", "--", BASENAME, NULL };
 static const gchar *GIT_CMD_UPDATE[] = { "git", "pull", NULL };
+static const gchar *GIT_CMD_CAT_BASE[] = { "git", "show", "HEAD:./" P_BASENAME, NULL };
+/* MESSAGE is the -L option with the lines to blame */
+static const gchar *GIT_CMD_BLAME_INCREMENTAL[] =
+	{ "git", "blame", "--incremental", MESSAGE, "--", BASENAME, NULL };
+/* MESSAGE is the text to search for in the commit messages */
+static const gchar *GIT_CMD_LOG_FILE_SEARCH[] =
+	{ "git", "log", "-i", "--grep", MESSAGE, "--", BASENAME, NULL };
+static const gchar *GIT_CMD_LOG_DIR_SEARCH[] = { "git", "log", "-i", "--grep", MESSAGE, NULL };
 
 static const gchar *GIT_ENV_DIFF_FILE[] = { "PAGER=cat", NULL };
 static const gchar *GIT_ENV_DIFF_DIR[] = { "PAGER=cat", NULL };
@@ -175,6 +183,26 @@ static const VC_COMMAND commands[VC_COMMAND_COUNT] = {
 		VC_COMMAND_STARTDIR_BASE,
 		GIT_CMD_UPDATE,
 		GIT_ENV_UPDATE,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		GIT_CMD_CAT_BASE,
+		GIT_ENV_SHOW,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		GIT_CMD_BLAME_INCREMENTAL,
+		GIT_ENV_BLAME,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		GIT_CMD_LOG_FILE_SEARCH,
+		GIT_ENV_LOG_FILE,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		GIT_CMD_LOG_DIR_SEARCH,
+		GIT_ENV_LOG_DIR,
 		NULL}
 };
 
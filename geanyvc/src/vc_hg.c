@@ -39,8 +39,11 @@ static const gchar *HG_CMD_COMMIT[] = { "hg", "commit", "-m", MESSAGE, FILE_LIST
 static const gchar *HG_CMD_BLAME[] = { "hg", "annotate", BASENAME, NULL };
 static const gchar *HG_CMD_SHOW[] = { "hg", "cat", BASENAME, NULL };
 static const gchar *HG_CMD_UPDATE[] = { "hg", "pull", CMD_SEPARATOR, "hg", "update", NULL };
+static const gchar *HG_CMD_CAT_BASE[] = { "hg", "cat", BASENAME, NULL };
+static const gchar *HG_CMD_LOG_FILE_SEARCH[] = { "hg", "log", "-k", MESSAGE, BASENAME, NULL };
+static const gchar *HG_CMD_LOG_DIR_SEARCH[] = { "hg", "log", "-k", MESSAGE, ABS_DIRNAME, NULL };
 
-static const VC_COMMAND commands[] = {
+static const VC_COMMAND commands[VC_COMMAND_COUNT] = {
 	{
 		VC_COMMAND_STARTDIR_FILE,
 		HG_CMD_DIFF_FILE,
@@ -105,6 +108,26 @@ static const VC_COMMAND commands[] = {
 		VC_COMMAND_STARTDIR_BASE,
 		HG_CMD_UPDATE,
 		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		HG_CMD_CAT_BASE,
+		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		NULL,
+		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		HG_CMD_LOG_FILE_SEARCH,
+		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		HG_CMD_LOG_DIR_SEARCH,
+		NULL,
 		NULL}
 };
 
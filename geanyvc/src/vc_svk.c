@@ -39,8 +39,9 @@ static const gchar *SVK_CMD_COMMIT[] = { "svk", "commit", "-m", MESSAGE, FILE_LI
 static const gchar *SVK_CMD_BLAME[] = { "svk", "blame", BASENAME, NULL };
 static const gchar *SVK_CMD_SHOW[] = { "svk", "cat", BASENAME, NULL };
 static const gchar *SVK_CMD_UPDATE[] = { "svk", "up", NULL };
+static const gchar *SVK_CMD_CAT_BASE[] = { "svk", "cat", BASENAME, NULL };
 
-static const VC_COMMAND commands[] = {
+static const VC_COMMAND commands[VC_COMMAND_COUNT] = {
 	{
 		VC_COMMAND_STARTDIR_FILE,
 		SVK_CMD_DIFF_FILE,
@@ -105,6 +106,11 @@ static const VC_COMMAND commands[] = {
 		VC_COMMAND_STARTDIR_BASE,
 		SVK_CMD_UPDATE,
 		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		SVK_CMD_CAT_BASE,
+		NULL,
 		NULL}
 };
 
@@ -41,8 +41,9 @@ static const gchar *SVN_CMD_COMMIT[] =
 static const gchar *SVN_CMD_BLAME[] = { "svn", "blame", BASENAME, NULL };
 static const gchar *SVN_CMD_SHOW[] = { "svn", "cat", "-rBASE", BASENAME, NULL };
 static const gchar *SVN_CMD_UPDATE[] = { "svn", "up", NULL };
+static const gchar *SVN_CMD_CAT_BASE[] = { "svn", "cat", "-rBASE", BASENAME, NULL };
 
-static const VC_COMMAND commands[] = {
+static const VC_COMMAND commands[VC_COMMAND_COUNT] = {
 	{
 		VC_COMMAND_STARTDIR_BASE,
 		SVN_CMD_DIFF_FILE,
@@ -107,6 +108,11 @@ static const VC_COMMAND commands[] = {
 		VC_COMMAND_STARTDIR_BASE,
 		SVN_CMD_UPDATE,
 		NULL,
+		NULL},
+	{
+		VC_COMMAND_STARTDIR_FILE,
+		SVN_CMD_CAT_BASE,
+		NULL,
 		NULL}
 };
 
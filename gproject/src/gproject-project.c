@@ -55,6 +55,9 @@ typedef struct
 static GSList *file_tag_deferred_op_queue = NULL;
 static gboolean flush_queued = FALSE;
 
+/* numbers the rescans of all projects, 0 is none */
+static guint last_rescan_id = 0;
+
 
 static void deferred_op_free(DeferredTagOp* op, G_GNUC_UNUSED gpointer user_data)
 {
@@ -223,13 +226,16 @@ void gprj_project_rescan(void)
 	GSList *ignored_dirs_list = NULL;
 	GSList *lst;
 	GSList *elem;
+	GHashTable *old_table;
+	GHashTableIter iter;
+	gpointer key;
 
 	if (!g_prj)
 		return;
 
 	if (g_prj->generate_tags)
 		g_hash_table_foreach(g_prj->file_tag_table, (GHFunc)workspace_remove_tag, NULL);
-	g_hash_table_destroy(g_prj->file_tag_table);
+	old_table = g_prj->file_tag_table;
 	g_prj->file_tag_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 
 	deferred_op_queue_clean();
@@ -259,6 +265,25 @@ void gprj_project_rescan(void)
 	if (g_prj->generate_tags)
 		g_hash_table_foreach(g_prj->file_tag_table, (GHFunc)workspace_add_tag, NULL);
 
+	/* the sidebar only updates the rows of the files which changed */
+	g_ptr_array_set_size(g_prj->files_added, 0);
+	g_hash_table_iter_init(&iter, g_prj->file_tag_table);
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+	{
+		if (!g_hash_table_lookup(old_table, key))
+			g_ptr_array_add(g_prj->files_added, g_strdup(key));
+	}
+	g_ptr_array_set_size(g_prj->files_removed, 0);
+	g_hash_table_iter_init(&iter, old_table);
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+	{
+		if (!g_hash_table_lookup(g_prj->file_tag_table, key))
+			g_ptr_array_add(g_prj->files_removed, g_strdup(key));
+	}
+	g_hash_table_destroy(old_table);
+	g_prj->prev_rescan_id = g_prj->rescan_id;
+	g_prj->rescan_id = ++last_rescan_id;
+
 	g_slist_foreach(lst, (GFunc) g_free, NULL);
 	g_slist_free(lst);
 
@@ -325,6 +350,8 @@ void gprj_project_open(GKeyFile * key_file)
 	g_prj->generate_tags = FALSE;
 
 	g_prj->file_tag_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	g_prj->files_added = g_ptr_array_new_with_free_func(g_free);
+	g_prj->files_removed = g_ptr_array_new_with_free_func(g_free);
 
 	deferred_op_queue_clean();
 
@@ -478,6 +505,8 @@ void gprj_project_close(void)
 	g_strfreev(g_prj->ignored_dirs_patterns);
 
 	g_hash_table_destroy(g_prj->file_tag_table);
+	g_ptr_array_free(g_prj->files_added, TRUE);
+	g_ptr_array_free(g_prj->files_removed, TRUE);
 
 	g_free(g_prj);
 	g_prj = NULL;
@@ -34,6 +34,13 @@ typedef struct
 	gboolean generate_tags;
 
 	GHashTable *file_tag_table;
+
+	/* the files added to and removed from file_tag_table by the rescan
+	 * numbered rescan_id, the one before it was prev_rescan_id */
+	GPtrArray *files_added;
+	GPtrArray *files_removed;
+	guint rescan_id;
+	guint prev_rescan_id;
 } GPrj;
 
 extern GPrj *g_prj;
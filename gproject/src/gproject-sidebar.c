@@ -46,6 +46,50 @@ static GtkWidget *s_file_view = NULL;
 static GtkTreeStore *s_file_store = NULL;
 static gboolean s_follow_editor = FALSE;
 
+#define FIND_FILE_CHUNK_SIZE 10000
+
+typedef struct
+{
+	/* relative to the project base path */
+	gchar *path;
+	gchar *path_lower;
+	/* the file name part of path and path_lower */
+	const gchar *name;
+	const gchar *name_lower;
+	/* the iters of a tree store persist */
+	GtkTreeIter iter;
+	/* position in s_files */
+	guint pos;
+} FileEntry;
+
+/* relative path -> FileEntry of a file or GtkTreeIter of a directory */
+static GHashTable *s_file_rows = NULL;
+static GHashTable *s_dir_rows = NULL;
+/* all FileEntry, in the order of the rows when s_files_sorted is set */
+static GPtrArray *s_files = NULL;
+static gboolean s_files_sorted = TRUE;
+
+static struct
+{
+	guint source_id;
+	GPatternSpec *pattern;
+	/* only paths starting with prefix are matched, if set */
+	gchar *prefix;
+	gboolean case_sensitive;
+	gboolean full_path;
+	guint pos;
+} s_find = {0, NULL, NULL, FALSE, FALSE, 0};
+
+/* the settings the rows were created with */
+static struct
+{
+	gchar *base_path;
+	gchar **header_patterns;
+	gchar **source_patterns;
+	/* the rescan of the project files */
+	guint rescan_id;
+} s_loaded = {NULL, NULL, NULL, 0};
+
 static struct
 {
 	GtkWidget *expand;
@@ -164,7 +208,8 @@ static gint show_dialog_find_file(gchar *path, gchar **pattern, gboolean *case_s
 }
 
 
-static gchar *build_path(GtkTreeIter *iter)
+/* Returns the path of the row relative to the project base path */
+static gchar *build_relative_path(GtkTreeIter *iter)
 {
 	GtkTreeIter node;
 	GtkTreeIter parent;
@@ -172,9 +217,6 @@ static gchar *build_path(GtkTreeIter *iter)
 	GtkTreeModel *model;
 	gchar *name;
 
-	if (!iter)
-		return g_strdup(geany_data->app->project->base_path);
-
 	node = *iter;
 	model = GTK_TREE_MODEL(s_file_store);
 
@@ -194,6 +236,18 @@ static gchar *build_path(GtkTreeIter *iter)
 	setptr(path, g_build_filename(name, path, NULL));
 	g_free(name);
 
+	return path;
+}
+
+
+static gchar *build_path(GtkTreeIter *iter)
+{
+	gchar *path;
+
+	if (!iter)
+		return g_strdup(geany_data->app->project->base_path);
+
+	path = build_relative_path(iter);
 	setptr(path, g_build_filename(geany_data->app->project->base_path, path, NULL));
 
 	return path;
@@ -219,57 +273,108 @@ static void on_follow_active(GtkToggleToolButton *button, G_GNUC_UNUSED gpointer
 }
 
 
-static void find_file_recursive(GtkTreeIter *iter, gboolean case_sensitive, gboolean full_path, GPatternSpec *pattern)
+/* Orders relative paths like the rows of the tree: at each level the
+ * directories first, then the files, both by name */
+static gint tree_order_compare(const gchar *a, const gchar *b)
 {
-	GtkTreeModel *model = GTK_TREE_MODEL(s_file_store);
-	GtkTreeIter child;
-	gboolean iterate;
+	const gchar *comp_a = a, *comp_b = b;
+	gboolean a_is_dir, b_is_dir;
+	guchar ca, cb;
 
-	iterate = gtk_tree_model_iter_children(model, &child, iter);
-	if (iterate)
+	/* skip the common part, remembering where its last component started */
+	while (*a != '\0' && *a == *b)
 	{
-		while (iterate)
+		if (*a == G_DIR_SEPARATOR)
 		{
-			find_file_recursive(&child, case_sensitive, full_path, pattern);
-			iterate = gtk_tree_model_iter_next(model, &child);
+			comp_a = a + 1;
+			comp_b = b + 1;
 		}
+		a++;
+		b++;
 	}
-	else
-	{
-		gchar *name;
 
-		if (iter == NULL)
-			return;
+	a_is_dir = strchr(comp_a, G_DIR_SEPARATOR) != NULL;
+	b_is_dir = strchr(comp_b, G_DIR_SEPARATOR) != NULL;
+	if (a_is_dir != b_is_dir)
+		return a_is_dir ? -1 : 1;
 
-		gtk_tree_model_get(GTK_TREE_MODEL(model), iter, FILEVIEW_COLUMN_NAME, &name, -1);
+	/* a component which ends here is a prefix of the other one */
+	ca = *a == G_DIR_SEPARATOR ? '\0' : *a;
+	cb = *b == G_DIR_SEPARATOR ? '\0' : *b;
+	return ca - cb;
+}
 
-		if (full_path)
-		{
-			gchar *path;
 
-			path = build_path(iter);
-			name = get_file_relative_path(geany_data->app->project->base_path, path);
-			g_free(path);
-		}
-		else
-			name = g_strdup(name);
+static gint file_entry_compare(FileEntry **a, FileEntry **b)
+{
+	return tree_order_compare((*a)->path, (*b)->path);
+}
 
-		if (!case_sensitive)
-			setptr(name, g_utf8_strdown(name, -1));
 
-		if (g_pattern_match_string(pattern, name))
-		{
-			gchar *path, *rel_path;
+/* Sorts s_files in the order of the rows after files were added or removed */
+static void sort_files(void)
+{
+	guint i;
 
-			path = build_path(iter);
-			rel_path = get_file_relative_path(geany_data->app->project->base_path, path);
-			msgwin_msg_add(COLOR_BLACK, -1, NULL, "./%s", rel_path ? rel_path : path);
-			g_free(path);
-			g_free(rel_path);
-		}
+	if (s_files_sorted)
+		return;
 
-		g_free(name);
+	g_ptr_array_sort(s_files, (GCompareFunc) file_entry_compare);
+	for (i = 0; i < s_files->len; i++)
+		((FileEntry *) g_ptr_array_index(s_files, i))->pos = i;
+	s_files_sorted = TRUE;
+}
+
+
+static void find_file_cancel(void)
+{
+	if (s_find.source_id == 0)
+		return;
+
+	g_source_remove(s_find.source_id);
+	s_find.source_id = 0;
+	g_pattern_spec_free(s_find.pattern);
+	g_free(s_find.prefix);
+}
+
+
+/* Matches the next chunk of paths and adds the matches to the message window
+ * together, so that large projects do not block the user interface */
+static gboolean find_file_next_chunk(G_GNUC_UNUSED gpointer data)
+{
+	GPtrArray *matches = g_ptr_array_new();
+	guint end = MIN(s_find.pos + FIND_FILE_CHUNK_SIZE, s_files->len);
+	gsize prefix_len = s_find.prefix ? strlen(s_find.prefix) : 0;
+	guint i;
+
+	for (; s_find.pos < end; s_find.pos++)
+	{
+		FileEntry *entry = g_ptr_array_index(s_files, s_find.pos);
+		const gchar *str;
+
+		if (prefix_len > 0 && strncmp(entry->path, s_find.prefix, prefix_len) != 0)
+			continue;
+
+		if (s_find.full_path)
+			str = s_find.case_sensitive ? entry->path : entry->path_lower;
+		else
+			str = s_find.case_sensitive ? entry->name : entry->name_lower;
+
+		if (g_pattern_match_string(s_find.pattern, str))
+			g_ptr_array_add(matches, entry->path);
 	}
+
+	for (i = 0; i < matches->len; i++)
+		msgwin_msg_add(COLOR_BLACK, -1, NULL, "./%s", (gchar *) g_ptr_array_index(matches, i));
+	g_ptr_array_free(matches, TRUE);
+
+	if (s_find.pos < s_files->len)
+		return TRUE;
+
+	s_find.source_id = 0;
+	g_pattern_spec_free(s_find.pattern);
+	g_free(s_find.prefix);
+	return FALSE;
 }
 
 
@@ -283,17 +388,30 @@ static void find_file(GtkTreeIter *iter)
 
 	if (show_dialog_find_file(path, &pattern_str, &case_sensitive, &full_path) == GTK_RESPONSE_ACCEPT)
 	{
-		GPatternSpec *pattern;
+		find_file_cancel();
 
 		if (!case_sensitive)
 			setptr(pattern_str, g_utf8_strdown(pattern_str, -1));
 
-		pattern = g_pattern_spec_new(pattern_str);
+		s_find.pattern = g_pattern_spec_new(pattern_str);
+		s_find.case_sensitive = case_sensitive;
+		s_find.full_path = full_path;
+		s_find.pos = 0;
+		s_find.prefix = NULL;
+		if (iter)
+		{
+			s_find.prefix = build_relative_path(iter);
+			setptr(s_find.prefix, g_strconcat(s_find.prefix, G_DIR_SEPARATOR_S, NULL));
+		}
+
+		sort_files();
 
 		msgwin_clear_tab(MSG_MESSAGE);
 		msgwin_set_messages_dir(geany_data->app->project->base_path);
-		find_file_recursive(iter, case_sensitive, full_path, pattern);
 		msgwin_switch_tab(MSG_MESSAGE, TRUE);
+
+		if (find_file_next_chunk(NULL))
+			s_find.source_id = g_idle_add(find_file_next_chunk, NULL);
 	}
 
 	g_free(pattern_str);
@@ -436,15 +554,139 @@ static void on_find_in_files(G_GNUC_UNUSED GtkMenuItem *menuitem, G_GNUC_UNUSED
 }
 
 
-static void build_file_list(gpointer name, G_GNUC_UNUSED gpointer value, GSList **lst)
+static gchar *get_path_key(gchar **path_split, gint level)
+{
+	GString *key;
+	gint i;
+
+	key = g_string_new(path_split[0]);
+	for (i = 1; i <= level; i++)
+	{
+		g_string_append_c(key, G_DIR_SEPARATOR);
+		g_string_append(key, path_split[i]);
+	}
+	return g_string_free(key, FALSE);
+}
+
+
+static void index_row(GHashTable *rows, gchar **path_split, gint level, GtkTreeIter *iter)
+{
+	g_hash_table_insert(rows, get_path_key(path_split, level), gtk_tree_iter_copy(iter));
+}
+
+
+/* Orders the paths like the rows of the tree: component by component */
+static gint path_compare(gchar **a, gchar **b)
 {
-	gchar *item;
+	gint i;
+
+	for (i = 0; a[i] != NULL && b[i] != NULL; i++)
+	{
+		gint cmp = strcmp(a[i], b[i]);
+
+		if (cmp != 0)
+			return cmp;
+	}
+	return (a[i] != NULL) - (b[i] != NULL);
+}
 
-	item = get_file_relative_path(geany_data->app->project->base_path, name);
-	*lst = g_slist_prepend(*lst, item);
+
+static gboolean strv_equal(gchar **a, gchar **b)
+{
+	guint i;
+
+	if (!a || !b)
+		return a == b;
+
+	for (i = 0; a[i] != NULL && b[i] != NULL; i++)
+	{
+		if (strcmp(a[i], b[i]) != 0)
+			return FALSE;
+	}
+	return a[i] == b[i];
 }
 
 
+static void add_file_entry(gchar **path_split, gint level, GtkTreeIter *iter)
+{
+	FileEntry *entry = g_new(FileEntry, 1);
+
+	entry->path = get_path_key(path_split, level);
+	entry->path_lower = g_utf8_strdown(entry->path, -1);
+	entry->name = entry->path + strlen(entry->path) - strlen(path_split[level]);
+	entry->name_lower = strrchr(entry->path_lower, G_DIR_SEPARATOR);
+	entry->name_lower = entry->name_lower ? entry->name_lower + 1 : entry->path_lower;
+	entry->iter = *iter;
+	entry->pos = s_files->len;
+
+	g_ptr_array_add(s_files, entry);
+	g_hash_table_insert(s_file_rows, entry->path, entry);
+}
+
+
+static void file_entry_free(FileEntry *entry)
+{
+	g_free(entry->path);
+	g_free(entry->path_lower);
+	g_free(entry);
+}
+
+
+static void remove_file_entry(FileEntry *entry)
+{
+	g_ptr_array_remove_index_fast(s_files, entry->pos);
+	if (entry->pos < s_files->len)
+	{
+		((FileEntry *) g_ptr_array_index(s_files, entry->pos))->pos = entry->pos;
+		s_files_sorted = FALSE;
+	}
+	g_hash_table_remove(s_file_rows, entry->path);
+}
+
+
+static void set_dir_row(GtkTreeIter *iter, const gchar *name)
+{
+	GIcon *icon_dir = g_icon_new_for_string("gtk-directory", NULL);
+
+	gtk_tree_store_set(s_file_store, iter,
+		FILEVIEW_COLUMN_ICON, icon_dir,
+		FILEVIEW_COLUMN_NAME, name, -1);
+	g_object_unref(icon_dir);
+}
+
+
+static void set_file_row(GtkTreeIter *iter, const gchar *name,
+	GSList *header_patterns, GSList *source_patterns)
+{
+	GIcon *icon = NULL;
+	gchar *content_type = g_content_type_guess(name, NULL, 0, NULL);
+
+	if (content_type)
+	{
+		icon = g_content_type_get_icon(content_type);
+		g_free(content_type);
+	}
+
+	if (! icon)
+	{
+		if (patterns_match(header_patterns, name))
+			icon = g_icon_new_for_string("gproject-header", NULL);
+		else if (patterns_match(source_patterns, name))
+			icon = g_icon_new_for_string("gproject-source", NULL);
+		else
+			icon = g_icon_new_for_string("gproject-file", NULL);
+	}
+
+	gtk_tree_store_set(s_file_store, iter,
+		FILEVIEW_COLUMN_ICON, icon,
+		FILEVIEW_COLUMN_NAME, name, -1);
+
+	if (icon)
+		g_object_unref(icon);
+}
+
+
+/* leaf_list must be sorted by path_compare in descending order */
 static void create_branch(gint level, GSList *leaf_list, GtkTreeIter *parent,
 	GSList *header_patterns, GSList *source_patterns)
 {
@@ -468,7 +710,6 @@ static void create_branch(gint level, GSList *leaf_list, GtkTreeIter *parent,
 		GtkTreeIter iter;
 		gchar **path_arr = dir_list->data;
 		gchar *last_dir_name;
-		GIcon *icon_dir = g_icon_new_for_string("gtk-directory", NULL);
 
 		last_dir_name = path_arr[level];
 
@@ -482,9 +723,8 @@ static void create_branch(gint level, GSList *leaf_list, GtkTreeIter *parent,
 			if (dir_changed)
 			{
 				gtk_tree_store_append(s_file_store, &iter, parent);
-				gtk_tree_store_set(s_file_store, &iter,
-					FILEVIEW_COLUMN_ICON, icon_dir,
-					FILEVIEW_COLUMN_NAME, last_dir_name, -1);
+				set_dir_row(&iter, last_dir_name);
+				index_row(s_dir_rows, tmp_list->data, level, &iter);
 
 				create_branch(level+1, tmp_list, &iter, header_patterns, source_patterns);
 
@@ -497,96 +737,204 @@ static void create_branch(gint level, GSList *leaf_list, GtkTreeIter *parent,
 		}
 
 		gtk_tree_store_append(s_file_store, &iter, parent);
-		gtk_tree_store_set(s_file_store, &iter,
-			FILEVIEW_COLUMN_ICON, icon_dir,
-			FILEVIEW_COLUMN_NAME, last_dir_name, -1);
+		set_dir_row(&iter, last_dir_name);
+		index_row(s_dir_rows, tmp_list->data, level, &iter);
 
 		create_branch(level+1, tmp_list, &iter, header_patterns, source_patterns);
 
 		g_slist_free(tmp_list);
 		g_slist_free(dir_list);
-		g_object_unref(icon_dir);
 	}
 
 	for (elem = file_list; elem != NULL; elem = g_slist_next(elem))
 	{
 		GtkTreeIter iter;
 		gchar **path_arr = elem->data;
-		GIcon *icon = NULL;
-		gchar *content_type = g_content_type_guess(path_arr[level], NULL, 0, NULL);
 
-		if (content_type)
+		gtk_tree_store_append(s_file_store, &iter, parent);
+		set_file_row(&iter, path_arr[level], header_patterns, source_patterns);
+		add_file_entry(path_arr, level, &iter);
+	}
+
+	g_slist_free(file_list);
+}
+
+
+/* Inserts a row for name among the children of parent, directories first and
+ * both sorted by name like create_branch() does */
+static void insert_sorted(GtkTreeIter *parent, const gchar *name, gboolean is_dir, GtkTreeIter *iter)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL(s_file_store);
+	GtkTreeIter sibling;
+	gboolean valid;
+
+	valid = gtk_tree_model_iter_children(model, &sibling, parent);
+	while (valid)
+	{
+		gboolean sibling_is_dir = gtk_tree_model_iter_has_child(model, &sibling);
+
+		if (is_dir && !sibling_is_dir)
+			break;
+		if (is_dir == sibling_is_dir)
 		{
-			icon = g_content_type_get_icon(content_type);
-			g_free(content_type);
+			gchar *sibling_name;
+			gint cmp;
+
+			gtk_tree_model_get(model, &sibling, FILEVIEW_COLUMN_NAME, &sibling_name, -1);
+			cmp = g_strcmp0(name, sibling_name);
+			g_free(sibling_name);
+			if (cmp < 0)
+				break;
 		}
+		valid = gtk_tree_model_iter_next(model, &sibling);
+	}
 
-		gtk_tree_store_append(s_file_store, &iter, parent);
-		if (patterns_match(header_patterns, path_arr[level]))
-		{
-			if (! icon)
-				icon = g_icon_new_for_string("gproject-header", NULL);
+	gtk_tree_store_insert_before(s_file_store, iter, parent, valid ? &sibling : NULL);
+}
 
-			gtk_tree_store_set(s_file_store, &iter,
-				FILEVIEW_COLUMN_ICON, icon,
-				FILEVIEW_COLUMN_NAME, path_arr[level], -1);
-		}
-		else if (patterns_match(source_patterns, path_arr[level]))
-		{
-			if (! icon)
-				icon = g_icon_new_for_string("gproject-source", NULL);
 
-			gtk_tree_store_set(s_file_store, &iter,
-				FILEVIEW_COLUMN_ICON, icon,
-				FILEVIEW_COLUMN_NAME, path_arr[level], -1);
+static void add_file(gchar **path_split, GSList *header_patterns, GSList *source_patterns)
+{
+	GtkTreeIter parent, iter;
+	gboolean has_parent = FALSE;
+	gint level;
+
+	for (level = 0; path_split[level+1] != NULL; level++)
+	{
+		gchar *key = get_path_key(path_split, level);
+		GtkTreeIter *dir_iter = g_hash_table_lookup(s_dir_rows, key);
+
+		if (dir_iter)
+		{
+			parent = *dir_iter;
+			g_free(key);
 		}
 		else
 		{
-			if (! icon)
-				icon = g_icon_new_for_string("gproject-file", NULL);
-
-			gtk_tree_store_set(s_file_store, &iter,
-				FILEVIEW_COLUMN_ICON, icon,
-				FILEVIEW_COLUMN_NAME, path_arr[level], -1);
+			insert_sorted(has_parent ? &parent : NULL, path_split[level], TRUE, &iter);
+			set_dir_row(&iter, path_split[level]);
+			g_hash_table_insert(s_dir_rows, key, gtk_tree_iter_copy(&iter));
+			parent = iter;
 		}
-
-		if (icon)
-			g_object_unref(icon);
+		has_parent = TRUE;
 	}
 
-	g_slist_free(file_list);
+	insert_sorted(has_parent ? &parent : NULL, path_split[level], FALSE, &iter);
+	set_file_row(&iter, path_split[level], header_patterns, source_patterns);
+	add_file_entry(path_split, level, &iter);
+	s_files_sorted = FALSE;
 }
 
 
-static void load_project(void)
+/* Removes the row of the file and the directories left empty by it */
+static void remove_file(const gchar *key)
 {
-	GSList *lst = NULL;
-	GSList *path_list = NULL;
-	GSList *elem, *header_patterns, *source_patterns;
+	GtkTreeModel *model = GTK_TREE_MODEL(s_file_store);
+	GtkTreeIter row, parent;
+	gboolean has_parent;
+	FileEntry *entry;
+	gchar *dir_key;
+
+	entry = g_hash_table_lookup(s_file_rows, key);
+	row = entry->iter;
+	has_parent = gtk_tree_model_iter_parent(model, &parent, &row);
+	gtk_tree_store_remove(s_file_store, &row);
 
+	dir_key = g_strdup(key);
+	remove_file_entry(entry);
+
+	while (has_parent && !gtk_tree_model_iter_has_child(model, &parent))
+	{
+		*strrchr(dir_key, G_DIR_SEPARATOR) = '\0';
+
+		row = parent;
+		has_parent = gtk_tree_model_iter_parent(model, &parent, &row);
+		gtk_tree_store_remove(s_file_store, &row);
+		g_hash_table_remove(s_dir_rows, dir_key);
+	}
+
+	g_free(dir_key);
+}
+
+
+static void clear_rows(void)
+{
 	gtk_tree_store_clear(s_file_store);
+	g_ptr_array_set_size(s_files, 0);
+	g_hash_table_remove_all(s_file_rows);
+	g_hash_table_remove_all(s_dir_rows);
+	s_files_sorted = TRUE;
+}
 
-	if (!g_prj || !geany_data->app->project)
-		return;
 
-	header_patterns = get_precompiled_patterns(g_prj->header_patterns);
-	source_patterns = get_precompiled_patterns(g_prj->source_patterns);
+/* The relative path of the project file name, split into its components, NULL
+ * if it is not below the project base path. The file names are real paths,
+ * usually just below the real base path base. */
+static gchar **get_project_path_split(const gchar *name, const gchar *base)
+{
+	gsize base_len = base ? strlen(base) : 0;
+	gchar *rel_path;
+	gchar **path_split;
+
+	if (base_len > 0 && strncmp(name, base, base_len) == 0 &&
+		G_IS_DIR_SEPARATOR(name[base_len]))
+		rel_path = g_strdup(name + base_len + 1);
+	else
+		rel_path = get_file_relative_path(geany_data->app->project->base_path, name);
+	if (!rel_path)
+		return NULL;
+
+	path_split = g_strsplit_set(rel_path, "/\\", 0);
+	g_free(rel_path);
+	return path_split;
+}
+
+
+/* The relative paths of the project files, split into their components */
+static GHashTable *get_project_files(void)
+{
+	GHashTable *files;
+	GHashTableIter iter;
+	gpointer name;
+	gchar *base;
 
-	g_hash_table_foreach(g_prj->file_tag_table, (GHFunc)build_file_list, &lst);
-	lst = g_slist_sort(lst, (GCompareFunc) strcmp);
+	files = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+	base = tm_get_real_path(geany_data->app->project->base_path);
 
-	for (elem = lst; elem != NULL; elem = g_slist_next(elem))
+	g_hash_table_iter_init(&iter, g_prj->file_tag_table);
+	while (g_hash_table_iter_next(&iter, &name, NULL))
 	{
-		gchar **path_split;
+		gchar **path_split = get_project_path_split(name, base);
 
-		path_split = g_strsplit_set(elem->data, "/\\", 0);
-		path_list = g_slist_prepend(path_list, path_split);
+		if (path_split)
+			g_hash_table_insert(files, get_path_key(path_split, g_strv_length(path_split) - 1), path_split);
 	}
 
+	g_free(base);
+	return files;
+}
+
+
+static void prepend_path(G_GNUC_UNUSED gpointer key, gchar **path_split, GSList **lst)
+{
+	*lst = g_slist_prepend(*lst, path_split);
+}
+
+
+static void create_tree(GHashTable *files, GSList *header_patterns, GSList *source_patterns)
+{
+	GSList *path_list = NULL;
+
+	clear_rows();
+
+	g_hash_table_foreach(files, (GHFunc)prepend_path, &path_list);
+	path_list = g_slist_sort(path_list, (GCompareFunc) path_compare);
+	path_list = g_slist_reverse(path_list);
+
 	if (path_list != NULL)
 	{
 		create_branch(0, path_list, NULL, header_patterns, source_patterns);
-		
+
 		gtk_widget_set_sensitive(s_project_toolbar.expand, TRUE);
 		gtk_widget_set_sensitive(s_project_toolbar.collapse, TRUE);
 		gtk_widget_set_sensitive(s_project_toolbar.follow, TRUE);
@@ -604,57 +952,112 @@ static void load_project(void)
 		gtk_widget_set_sensitive(s_project_toolbar.follow, FALSE);
 	}
 
-	g_slist_foreach(header_patterns, (GFunc) g_pattern_spec_free, NULL);
-	g_slist_free(header_patterns);
-	g_slist_foreach(source_patterns, (GFunc) g_pattern_spec_free, NULL);
-	g_slist_free(source_patterns);
-
-	g_slist_foreach(lst, (GFunc) g_free, NULL);
-	g_slist_free(lst);
-	g_slist_foreach(path_list, (GFunc) g_strfreev, NULL);
 	g_slist_free(path_list);
 }
 
 
-static gboolean find_in_tree(GtkTreeIter *parent, gchar **path_split, gint level, GtkTreeIter *ret)
+/* Adds and removes only the rows of the files which the last rescan added to
+ * or removed from the project, the rows must show the files before it */
+static void update_tree(GSList *header_patterns, GSList *source_patterns)
 {
-	GtkTreeModel *model;
-	GtkTreeIter iter;
-	gboolean iterate;
+	gchar *base = tm_get_real_path(geany_data->app->project->base_path);
+	guint i;
 
-	model = GTK_TREE_MODEL(s_file_store);
+	for (i = 0; i < g_prj->files_removed->len; i++)
+	{
+		gchar **path_split = get_project_path_split(g_ptr_array_index(g_prj->files_removed, i), base);
+		gchar *key;
+
+		if (!path_split)
+			continue;
+		key = get_path_key(path_split, g_strv_length(path_split) - 1);
+		if (g_hash_table_lookup(s_file_rows, key))
+			remove_file(key);
+		g_free(key);
+		g_strfreev(path_split);
+	}
 
-	iterate = gtk_tree_model_iter_children(model, &iter, parent);
-	while (iterate)
+	for (i = 0; i < g_prj->files_added->len; i++)
 	{
-		gchar *name;
+		gchar **path_split = get_project_path_split(g_ptr_array_index(g_prj->files_added, i), base);
+		gchar *key;
+
+		if (!path_split)
+			continue;
+		key = get_path_key(path_split, g_strv_length(path_split) - 1);
+		if (!g_hash_table_lookup(s_file_rows, key))
+			add_file(path_split, header_patterns, source_patterns);
+		g_free(key);
+		g_strfreev(path_split);
+	}
 
-		gtk_tree_model_get(model, &iter, FILEVIEW_COLUMN_NAME, &name, -1);
+	g_free(base);
+}
 
-		if (g_strcmp0(name, path_split[level]) == 0)
-		{
-			GtkTreeIter foo;
-			if (path_split[level+1] == NULL && !gtk_tree_model_iter_children (model, &foo, &iter))
-			{
-				*ret = iter;
-				return TRUE;
-			}
-			else
-				return find_in_tree(&iter, path_split, level + 1, ret);
-		}
 
-		iterate = gtk_tree_model_iter_next(model, &iter);
+static void load_project(void)
+{
+	GSList *header_patterns, *source_patterns;
+	gboolean settings_changed;
+
+	if (!g_prj || !geany_data->app->project)
+	{
+		find_file_cancel();
+		clear_rows();
+		setptr(s_loaded.base_path, NULL);
+		s_loaded.rescan_id = 0;
+		return;
 	}
 
-	return FALSE;
+	/* the rows only need to be created again when they would look different */
+	settings_changed = g_hash_table_size(s_file_rows) == 0 ||
+		g_strcmp0(s_loaded.base_path, geany_data->app->project->base_path) != 0 ||
+		!strv_equal(s_loaded.header_patterns, g_prj->header_patterns) ||
+		!strv_equal(s_loaded.source_patterns, g_prj->source_patterns);
+
+	/* the files did not change since the rows were made */
+	if (!settings_changed && s_loaded.rescan_id == g_prj->rescan_id)
+		return;
+
+	/* the search goes through the rows which are about to change */
+	find_file_cancel();
+
+	header_patterns = get_precompiled_patterns(g_prj->header_patterns);
+	source_patterns = get_precompiled_patterns(g_prj->source_patterns);
+
+	/* the rows are updated by the changes of the last rescan if they show the
+	 * files before it, otherwise they are created from all files */
+	if (settings_changed || s_loaded.rescan_id != g_prj->prev_rescan_id ||
+		g_hash_table_size(g_prj->file_tag_table) == 0)
+	{
+		GHashTable *files = get_project_files();
+
+		create_tree(files, header_patterns, source_patterns);
+		g_hash_table_destroy(files);
+
+		setptr(s_loaded.base_path, g_strdup(geany_data->app->project->base_path));
+		g_strfreev(s_loaded.header_patterns);
+		s_loaded.header_patterns = g_strdupv(g_prj->header_patterns);
+		g_strfreev(s_loaded.source_patterns);
+		s_loaded.source_patterns = g_strdupv(g_prj->source_patterns);
+	}
+	else
+		update_tree(header_patterns, source_patterns);
+	s_loaded.rescan_id = g_prj->rescan_id;
+
+	g_slist_foreach(header_patterns, (GFunc) g_pattern_spec_free, NULL);
+	g_slist_free(header_patterns);
+	g_slist_foreach(source_patterns, (GFunc) g_pattern_spec_free, NULL);
+	g_slist_free(source_patterns);
 }
 
 
 static void follow_editor(void)
 {
-	GtkTreeIter found_iter;
+	FileEntry *entry;
 	gchar *path;
 	gchar **path_split;
+	gchar *key;
 	GeanyDocument *doc;
 
 	doc = document_get_current();
@@ -668,20 +1071,27 @@ static void follow_editor(void)
 		return;
 
 	path_split = g_strsplit_set(path, "/\\", 0);
+	key = get_path_key(path_split, g_strv_length(path_split) - 1);
 
-	if (find_in_tree(NULL, path_split, 0, &found_iter))
+	entry = g_hash_table_lookup(s_file_rows, key);
+	if (entry)
 	{
 		GtkTreePath *tree_path;
 		GtkTreeModel *model;
 
 		model = GTK_TREE_MODEL(s_file_store);
-		tree_path = gtk_tree_model_get_path (model, &found_iter);
+		tree_path = gtk_tree_model_get_path (model, &entry->iter);
 
 		gtk_tree_view_expand_to_path(GTK_TREE_VIEW(s_file_view), tree_path);
 		gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(s_file_view), tree_path,
 			NULL, FALSE, 0.0, 0.0);
 		gtk_tree_view_set_cursor(GTK_TREE_VIEW(s_file_view), tree_path, NULL, FALSE);
+		gtk_tree_path_free(tree_path);
 	}
+
+	g_free(key);
+	g_strfreev(path_split);
+	g_free(path);
 }
 
 
@@ -782,6 +1192,9 @@ void gprj_sidebar_init(void)
 	s_file_view = gtk_tree_view_new();
 
 	s_file_store = gtk_tree_store_new(FILEVIEW_N_COLUMNS, G_TYPE_ICON, G_TYPE_STRING);
+	s_file_rows = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, (GDestroyNotify) file_entry_free);
+	s_files = g_ptr_array_new();
+	s_dir_rows = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) gtk_tree_iter_free);
 	gtk_tree_view_set_model(GTK_TREE_VIEW(s_file_view), GTK_TREE_MODEL(s_file_store));
 
 	renderer = gtk_cell_renderer_pixbuf_new();
@@ -882,4 +1295,13 @@ void gprj_sidebar_activate(gboolean activate)
 void gprj_sidebar_cleanup(void)
 {
 	gtk_widget_destroy(s_file_view_vbox);
+
+	find_file_cancel();
+
+	g_ptr_array_free(s_files, TRUE);
+	g_hash_table_destroy(s_file_rows);
+	g_hash_table_destroy(s_dir_rows);
+	g_free(s_loaded.base_path);
+	g_strfreev(s_loaded.header_patterns);
+	g_strfreev(s_loaded.source_patterns);
 }
@@ -100,6 +100,7 @@ static const ParseRoute parse_routes[] =
 	{ "^done,frame={",                on_thread_frame,         '4',  '\0', 0 },
 	{ "^done,stack=[",                on_stack_frames,         '*',  '\0', 1 },
 	{ "^done,stack-args=[",           on_stack_arguments,      '*',  '\0', 1 },
+	{ "^done,depth=\"",               on_stack_depth,          '*',  '\0', 1 },
 	{ "^done,variables=[",            on_local_variables,      '*',  '\0', 1 },
 	{ "^done,line=\"",                on_debug_list_source,    '2',  '\0', 2 },
 	{ "^done,value=\"",               on_inspect_evaluate,     '2',  '\0', 1 },
@@ -657,6 +657,7 @@ void plugin_cleanup(void)
 	registers_finalize();
 	inspect_finalize();
 	thread_finalize();
+	stack_finalize();
 	break_finalize();
 	memory_finalize();
 	menu_finalize();
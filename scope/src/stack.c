@@ -36,6 +36,135 @@ enum
 static ScpTreeStore *store;
 static GtkTreeSelection *selection;
 
+/* frames are fetched in windows: 0 .. stack_loaded - 1 are in the store, and a
+   placeholder row (no id) stands for the rest until it's scrolled into view */
+#define STACK_WINDOW 0x100
+/* arguments are fetched only for the visible rows, in chunks of STACK_CHUNK */
+#define STACK_CHUNK 0x20
+
+static gint stack_loaded = 0;
+static gint stack_depth = 0;  /* 0 = not known yet */
+static gboolean stack_fetching = FALSE;
+static GArray *stack_chunks;  /* gboolean per chunk, TRUE if arguments requested */
+static char *stack_follow_id = NULL;
+
+static gboolean stack_find(GtkTreeIter *iter, const char *id)
+{
+	/* unsorted frames are in level order, so try the direct slot first */
+	if (scp_tree_store_iter_nth_child(store, iter, NULL, atoi(id)))
+	{
+		const char *level;
+
+		scp_tree_store_get(store, iter, STACK_ID, &level, -1);
+		if (!g_strcmp0(level, id))
+			return TRUE;
+	}
+
+	return store_find(store, iter, STACK_ID, id);
+}
+
+static void stack_reset(void)
+{
+	store_clear(store);
+	stack_loaded = 0;
+	stack_depth = 0;
+	stack_fetching = FALSE;
+	g_array_set_size(stack_chunks, 0);
+}
+
+static void stack_more_update(void)
+{
+	GtkTreeIter iter;
+	gboolean found = store_find(store, &iter, STACK_ID, NULL);
+
+	if (stack_loaded < stack_depth)
+	{
+		char *more = g_strdup_printf(_("(%d more frames)"), stack_depth - stack_loaded);
+
+		if (found)
+			scp_tree_store_set(store, &iter, STACK_FUNC, more, -1);
+		else
+		{
+			scp_tree_store_append_with_values(store, NULL, NULL, STACK_FUNC, more,
+				STACK_ENTRY, TRUE, -1);
+		}
+		g_free(more);
+	}
+	else if (found)
+		scp_tree_store_remove(store, &iter);
+}
+
+static void stack_fetch(char token, gint high)
+{
+	debug_send_format(T, "0%c%s-stack-list-frames %d %d", token, thread_id, stack_loaded,
+		high);
+	stack_fetching = TRUE;
+}
+
+static void stack_request_arguments(gint level)
+{
+	guint chunk = level / STACK_CHUNK;
+	gint low = chunk * STACK_CHUNK;
+	gint high = MIN(low + STACK_CHUNK, stack_loaded) - 1;
+	gboolean complete = high == low + STACK_CHUNK - 1 ||
+		(stack_depth && stack_loaded >= stack_depth);
+
+	if (chunk >= stack_chunks->len)
+		g_array_set_size(stack_chunks, chunk + 1);
+
+	/* the depth follows the first frames, wait for it before requesting the last
+	   chunk of a short stack; other partial chunks are requested again when the
+	   rest arrives */
+	if (!g_array_index(stack_chunks, gboolean, chunk) && (complete || stack_depth))
+	{
+		debug_send_format(T, "04%s-stack-list-arguments 1 %d %d", thread_id, low, high);
+		g_array_index(stack_chunks, gboolean, chunk) = complete;
+	}
+}
+
+static guint stack_visible_id = 0;
+
+static gboolean stack_visible_update(G_GNUC_UNUSED gpointer gdata)
+{
+	GtkTreeView *tree = gtk_tree_selection_get_tree_view(selection);
+	GtkTreePath *start, *end;
+
+	stack_visible_id = 0;
+
+	if (thread_state >= THREAD_STOPPED && gtk_tree_view_get_visible_range(tree, &start, &end))
+	{
+		GtkTreeIter iter;
+		gint index = gtk_tree_path_get_indices(start)[0];
+		gint last = gtk_tree_path_get_indices(end)[0];
+		gboolean valid = scp_tree_store_get_iter(store, &iter, start);
+
+		for (; valid && index <= last; index++)
+		{
+			const char *id;
+
+			scp_tree_store_get(store, &iter, STACK_ID, &id, -1);
+
+			if (id)
+				stack_request_arguments(atoi(id));
+			else if (!stack_fetching)
+				stack_fetch('4', stack_loaded + STACK_WINDOW - 1);
+
+			valid = scp_tree_store_iter_next(store, &iter);
+		}
+
+		gtk_tree_path_free(start);
+		gtk_tree_path_free(end);
+	}
+
+	return FALSE;
+}
+
+static void stack_visible_queue(void)
+{
+	if (!stack_visible_id)
+		stack_visible_id = plugin_idle_add(geany_plugin, stack_visible_update, NULL);
+}
+
 static void stack_node_location(const ParseNode *node, const char *fid)
 {
 	iff (node->type == PT_ARRAY, "stack: contains value")
@@ -48,6 +177,9 @@ static void stack_node_location(const ParseNode *node, const char *fid)
 			ParseLocation loc;
 			GtkTreeIter iter;
 
+			if (atoi(id) < stack_loaded)
+				return;  /* overlapping window */
+
 			parse_location(nodes, &loc);
 			scp_tree_store_append_with_values(store, &iter, NULL, STACK_ID, id,
 				STACK_FILE, loc.file, STACK_LINE, loc.line, STACK_BASE_NAME,
@@ -55,6 +187,7 @@ static void stack_node_location(const ParseNode *node, const char *fid)
 				loc.addr, STACK_ENTRY, !loc.func ||
 				parse_mode_get(loc.func, MODE_ENTRY), -1);
 			parse_location_free(&loc);
+			stack_loaded = atoi(id) + 1;
 
 			if (!g_strcmp0(id, fid))
 				gtk_tree_selection_select_iter(selection, &iter);
@@ -68,19 +201,46 @@ void on_stack_frames(GArray *nodes)
 {
 	if (!g_strcmp0(parse_grab_token(nodes), thread_id))
 	{
-		char *fid = g_strdup(frame_id);
-
-		stack_clear();
-		parse_foreach(parse_lead_array(nodes), (GFunc) stack_node_location, fid);
+		GArray *frames = parse_lead_array(nodes);
+		const ParseNode *first = frames->len ? (const ParseNode *) frames->data : NULL;
+		gboolean fresh = !first || first->type != PT_ARRAY ||
+			!utils_atoi0(parse_find_value((GArray *) first->value, "level"));
+		char *fid = g_strdup(fresh ? frame_id : stack_follow_id);
+		GtkTreeIter iter;
+
+		if (fresh)
+			stack_reset();
+		else if (store_find(store, &iter, STACK_ID, NULL))
+			scp_tree_store_remove(store, &iter);
+
+		parse_foreach(frames, (GFunc) stack_node_location, fid);
 		g_free(fid);
+		stack_fetching = FALSE;
+		stack_more_update();
 
-		if (!frame_id)
+		if (fresh)
 		{
-			GtkTreeIter iter;
-
-			if (store_find(store, &iter, STACK_ID, "0"))
+			if (!frame_id && stack_find(&iter, "0"))
 				utils_tree_set_cursor(selection, &iter, -1);
 		}
+		else if (stack_follow_id && stack_find(&iter, stack_follow_id))
+		{
+			utils_tree_set_cursor(selection, &iter, 0.5);
+			g_free(stack_follow_id);
+			stack_follow_id = NULL;
+		}
+
+		stack_visible_queue();
+	}
+}
+
+void on_stack_depth(GArray *nodes)
+{
+	if (!g_strcmp0(parse_grab_token(nodes), thread_id))
+	{
+		stack_depth = utils_atoi0(parse_lead_value(nodes));
+		stack_more_update();
+		stack_visible_queue();
 	}
 }
 
@@ -126,7 +286,7 @@ static void stack_node_arguments(const ParseNode *node, G_GNUC_UNUSED gpointer g
 		{
 			GtkTreeIter iter;
 
-			iff (store_find(store, &iter, STACK_ID, id), "%s: level not found", id)
+			iff (stack_find(&iter, id), "%s: level not found", id)
 			{
 				StackData sd;
 
@@ -156,8 +316,14 @@ void on_stack_follow(GArray *nodes)
 		{
 			GtkTreeIter iter;
 
-			iff (store_find(store, &iter, STACK_ID, id), "%s: level not found", id)
+			if (stack_find(&iter, id))
 				utils_tree_set_cursor(selection, &iter, 0.5);
+			else iff (atoi(id) >= stack_loaded, "%s: level not found", id)
+			{
+				g_free(stack_follow_id);
+				stack_follow_id = g_strdup(id);
+				stack_fetch('2', atoi(id) + STACK_WINDOW / 2);
+			}
 		}
 	}
 }
@@ -174,13 +340,16 @@ gboolean stack_entry(void)
 
 void stack_clear(void)
 {
-	store_clear(store);
+	stack_reset();
+	g_free(stack_follow_id);
+	stack_follow_id = NULL;
 }
 
 static void stack_send_update(char token)
 {
-	debug_send_format(T, "0%c%s-stack-list-frames", token, thread_id);
-	debug_send_format(T, "0%c%s-stack-list-arguments 1", token, thread_id);
+	debug_send_format(T, "0%c%s-stack-list-frames 0 %d", token, thread_id, STACK_WINDOW - 1);
+	debug_send_format(T, "0%c%s-stack-info-depth", token, thread_id);
+	stack_fetching = TRUE;
 }
 
 gboolean stack_update(void)
@@ -279,7 +448,10 @@ static void on_stack_show_entry(const MenuItem *menu_item)
 			frame_id);
 	}
 	else
-		debug_send_format(T, "04%s-stack-list-arguments 1", thread_id);
+	{
+		g_array_set_size(stack_chunks, 0);
+		stack_visible_queue();
+	}
 }
 
 #define DS_VIEWABLE (DS_ACTIVE | DS_EXTRA_2)
@@ -325,6 +497,24 @@ static void on_stack_menu_show(G_GNUC_UNUSED GtkWidget *widget, const MenuItem *
 	menu_item_set_active(menu_item + 1, stack_show_address);
 }
 
+static gboolean stack_select_func(G_GNUC_UNUSED GtkTreeSelection *selection,
+	G_GNUC_UNUSED GtkTreeModel *model, GtkTreePath *path,
+	G_GNUC_UNUSED gboolean path_currently_selected, G_GNUC_UNUSED gpointer gdata)
+{
+	GtkTreeIter iter;
+	const char *id;
+
+	scp_tree_store_get_iter(store, &iter, path);
+	scp_tree_store_get(store, &iter, STACK_ID, &id, -1);
+	return id != NULL;  /* not the placeholder */
+}
+
+static void on_stack_adjustment_changed(G_GNUC_UNUSED GtkAdjustment *adjustment,
+	G_GNUC_UNUSED gpointer gdata)
+{
+	stack_visible_queue();
+}
+
 static void on_stack_synchronize_button_release(GtkWidget *widget, GdkEventButton *event,
 	GtkWidget *menu)
 {
@@ -335,6 +525,8 @@ void stack_init(void)
 {
 	GtkTreeView *tree = view_create("stack_view", &store, &selection);
 	GtkWidget *menu = menu_select("stack_menu", &stack_menu_info, selection);
+	GtkAdjustment *vadjustment = gtk_scrolled_window_get_vadjustment(
+		GTK_SCROLLED_WINDOW(get_widget("stack_window")));
 
 	view_set_sort_func(store, STACK_ID, store_gint_compare);
 	view_set_sort_func(store, STACK_FILE, store_seek_compare);
@@ -348,9 +540,20 @@ void stack_init(void)
 	g_signal_connect(tree, "button-press-event", G_CALLBACK(on_view_button_1_press),
 		stack_seek_selected);
 	g_signal_connect(selection, "changed", G_CALLBACK(on_stack_selection_changed), NULL);
+	gtk_tree_selection_set_select_function(selection, stack_select_func, NULL, NULL);
+	g_signal_connect(vadjustment, "value-changed", G_CALLBACK(on_stack_adjustment_changed),
+		NULL);
+	g_signal_connect(vadjustment, "changed", G_CALLBACK(on_stack_adjustment_changed), NULL);
+	stack_chunks = g_array_new(FALSE, TRUE, sizeof(gboolean));
 
 	g_signal_connect(menu, "show", G_CALLBACK(on_stack_menu_show),
 		(gpointer) menu_item_find(stack_menu_items, "stack_show_entry"));
 	g_signal_connect(get_widget("stack_synchronize"), "button-release-event",
 		G_CALLBACK(on_stack_synchronize_button_release), menu);
 }
+
+void stack_finalize(void)
+{
+	g_array_free(stack_chunks, TRUE);
+	g_free(stack_follow_id);
+}
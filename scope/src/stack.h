@@ -22,6 +22,7 @@
 extern const char *frame_id;
 
 void on_stack_frames(GArray *nodes);
+void on_stack_depth(GArray *nodes);
 void on_stack_arguments(GArray *nodes);
 void on_stack_follow(GArray *nodes);
 
@@ -30,6 +31,7 @@ void stack_clear(void);
 gboolean stack_update(void);
 
 void stack_init(void);
+void stack_finalize(void);
 
 #define STACK_H 1
 #endif
@@ -149,15 +149,112 @@ static gint thread_ident_compare(ScpTreeStore *store, GtkTreeIter *a, GtkTreeIte
 static ScpTreeStore *store;
 static GtkTreeSelection *selection;
 
+/* tid -> row position + 1; the keys are the store THREAD_ID strings, so the index is
+   emptied whenever rows are removed from the middle or reordered, and rebuilt on demand */
+static GHashTable *thread_index;
+static gboolean thread_index_valid = FALSE;
+
+static void thread_index_reset(void)
+{
+	g_hash_table_remove_all(thread_index);
+	thread_index_valid = FALSE;
+}
+
+static void thread_index_rebuild(void)
+{
+	GtkTreeIter iter;
+	gboolean valid = scp_tree_store_get_iter_first(store, &iter);
+	gint position = 0;
+
+	while (valid)
+	{
+		const char *tid;
+
+		scp_tree_store_get(store, &iter, THREAD_ID, &tid, -1);
+		g_hash_table_insert(thread_index, (gpointer) tid, GINT_TO_POINTER(++position));
+		valid = scp_tree_store_iter_next(store, &iter);
+	}
+
+	thread_index_valid = TRUE;
+}
+
+static void thread_index_append(GtkTreeIter *iter)
+{
+	if (thread_index_valid)
+	{
+		gint position = scp_tree_store_iter_tell(store, iter);
+
+		if (position == scp_tree_store_iter_n_children(store, NULL) - 1)
+		{
+			const char *tid;
+
+			scp_tree_store_get(store, iter, THREAD_ID, &tid, -1);
+			g_hash_table_insert(thread_index, (gpointer) tid, GINT_TO_POINTER(position + 1));
+		}
+		else
+			thread_index_reset();
+	}
+}
+
+static void thread_index_remove(GtkTreeIter *iter, const char *tid)
+{
+	if (thread_index_valid)
+	{
+		if (scp_tree_store_iter_tell(store, iter) ==
+			scp_tree_store_iter_n_children(store, NULL) - 1)
+		{
+			g_hash_table_remove(thread_index, tid);
+		}
+		else
+			thread_index_reset();
+	}
+}
+
+static void on_thread_rows_reordered(G_GNUC_UNUSED GtkTreeModel *model,
+	G_GNUC_UNUSED GtkTreePath *path, G_GNUC_UNUSED GtkTreeIter *iter,
+	G_GNUC_UNUSED gpointer new_order, G_GNUC_UNUSED gpointer gdata)
+{
+	thread_index_reset();
+}
+
 static gboolean find_thread(const char *tid, GtkTreeIter *iter)
 {
-	if (G_LIKELY(store_find(store, iter, THREAD_ID, tid)))
+	gint position;
+
+	if (!thread_index_valid)
+		thread_index_rebuild();
+
+	position = GPOINTER_TO_INT(g_hash_table_lookup(thread_index, tid));
+
+	if (G_LIKELY(position && scp_tree_store_iter_nth_child(store, iter, NULL, position - 1)))
 		return TRUE;
 
 	dc_error("%s: tid not found", tid);
 	return FALSE;
 }
 
+/* apply func to many rows with sorting suspended, so the store is resorted once */
+static void thread_foreach_bulk(GFunc func, GArray *nodes, gpointer gdata)
+{
+	gint sort_column_id;
+	GtkSortType order;
+	gboolean sorted = scp_tree_store_get_sort_column_id(store, &sort_column_id, &order);
+
+	if (sorted)
+	{
+		scp_tree_store_set_sort_column_id(store, GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+			order);
+	}
+
+	if (nodes)
+		parse_foreach(nodes, func, gdata);
+	else
+		store_foreach(store, func, gdata);
+
+	if (sorted)
+		scp_tree_store_set_sort_column_id(store, sort_column_id, order);
+}
+
 static const gchar *RUNNING;
 static const gchar *STOPPED;
 
@@ -236,7 +333,7 @@ void on_thread_running(GArray *nodes)
 		gboolean was_stopped = thread_state >= THREAD_STOPPED;
 
 		if (!strcmp(tid, "all"))
-			store_foreach(store, (GFunc) thread_iter_running, NULL);
+			thread_foreach_bulk((GFunc) thread_iter_running, NULL, NULL);
 		else
 		{
 			GtkTreeIter iter;
@@ -295,6 +392,7 @@ typedef struct _StopData
 	const char *tid;
 	GtkTreeIter iter;
 	gboolean found;
+	const char *found_tid;  /* bulk updates may resort the store and invalidate iter */
 } StopData;
 
 static void thread_iter_stopped(GtkTreeIter *iter, StopData *sd)
@@ -306,8 +404,10 @@ static void thread_iter_stopped(GtkTreeIter *iter, StopData *sd)
 		tid ? -1 : THREAD_ID, &tid, -1);
 
 	if (strcmp(state, STOPPED))
+	{
 		thread_prompt++;
-	scp_tree_store_set(store, iter, THREAD_STATE, STOPPED, -1);
+		scp_tree_store_set(store, iter, THREAD_STATE, STOPPED, -1);
+	}
 
 	if (!g_strcmp0(tid, thread_id))
 	{
@@ -323,6 +423,7 @@ static void thread_iter_stopped(GtkTreeIter *iter, StopData *sd)
 	{
 		sd->iter = *iter;
 		sd->found = TRUE;
+		sd->found_tid = tid;
 	}
 }
 
@@ -349,6 +450,7 @@ void on_thread_stopped(GArray *nodes)
 	if (tid)
 	{
 		sd.found = find_thread(tid, &sd.iter);
+		sd.found_tid = tid;
 
 		if (sd.found)
 		{
@@ -375,7 +477,7 @@ void on_thread_stopped(GArray *nodes)
 			const char *tid = (const char *) stopped->value;
 
 			if (!strcmp(tid, "all"))
-				store_foreach(store, (GFunc) thread_iter_stopped, &sd);
+				thread_foreach_bulk((GFunc) thread_iter_stopped, NULL, &sd);
 			else
 			{
 				GtkTreeIter iter;
@@ -388,10 +490,14 @@ void on_thread_stopped(GArray *nodes)
 			}
 		}
 		else
-			parse_foreach((GArray *) stopped->value, (GFunc) thread_node_stopped, &sd);
+		{
+			thread_foreach_bulk((GFunc) thread_node_stopped, (GArray *) stopped->value,
+				&sd);
+		}
 	}
 
-	if (thread_select_on_stopped && thread_state <= THREAD_RUNNING && sd.found)
+	if (thread_select_on_stopped && thread_state <= THREAD_RUNNING && sd.found &&
+		find_thread(sd.found_tid, &sd.iter))
 	{
 		utils_tree_set_cursor(selection, &sd.iter, -1);
 		view_seek_selected(selection, FALSE, SK_EXECUTE);
@@ -450,6 +556,7 @@ void on_thread_created(GArray *nodes)
 
 		scp_tree_store_append_with_values(store, &iter, NULL, THREAD_ID, tid, THREAD_STATE,
 			"", THREAD_GROUP_ID, gid, THREAD_PID, pid, -1);
+		thread_index_append(&iter);
 		debug_send_format(N, "04-thread-info %s", tid);
 
 		if (thread_count == 1)
@@ -473,6 +580,7 @@ void on_thread_exited(GArray *nodes)
 			gboolean was_selected = !g_strcmp0(tid, thread_id);
 
 			thread_iter_unmark(&iter, GINT_TO_POINTER(TRUE));
+			thread_index_remove(&iter, tid);
 			scp_tree_store_remove(store, &iter);
 			if (was_selected && thread_select_on_exited)
 				auto_select_thread();
@@ -588,6 +696,7 @@ void threads_clear(void)
 {
 	store_foreach(store, (GFunc) thread_iter_unmark, GINT_TO_POINTER(TRUE));
 	store_clear(groups);
+	thread_index_reset();
 	store_clear(store);
 	set_gdb_thread(NULL, FALSE);
 	thread_count = 0;
@@ -896,6 +1005,8 @@ void thread_init(void)
 		thread_seek_selected);
 
 	g_signal_connect(selection, "changed", G_CALLBACK(on_thread_selection_changed), NULL);
+	thread_index = g_hash_table_new(g_str_hash, g_str_equal);
+	g_signal_connect(store, "rows-reordered", G_CALLBACK(on_thread_rows_reordered), NULL);
 	g_signal_connect(get_widget("thread_synchronize"), "button-release-event",
 		G_CALLBACK(on_thread_synchronize_button_release), menu);
 #ifndef G_OS_UNIX
@@ -907,4 +1018,5 @@ void thread_finalize(void)
 {
 	store_foreach(store, (GFunc) thread_iter_unmark, NULL);
 	set_gdb_thread(NULL, FALSE);
+	g_hash_table_destroy(thread_index);
 }
@@ -41,6 +41,17 @@ static GtkWidget 			*filter;
 static GtkWidget 			*addressbar;
 static gchar 				*addressbar_last_address 	= NULL;
 
+/* URI -> GQueue of the GtkTreeIter of its rows, the iters of a tree store persist */
+static GHashTable 			*uri_rows 					= NULL;
+
+#ifdef HAVE_GIO
+/* directory -> GFileMonitor of the directories shown, and the set of the directories which
+ * changed since they were last refreshed */
+static GHashTable 			*dir_monitors 				= NULL;
+static GHashTable 			*dirs_changed 				= NULL;
+static guint 				dirs_changed_source 		= 0;
+#endif
+
 static GtkTreeIter 			bookmarks_iter;
 static gboolean 			bookmarks_expanded = FALSE;
 
@@ -133,6 +144,9 @@ PLUGIN_SET_TRANSLATABLE_INFO(
 
 #define foreach_slist_free(node, list) for (node = list, list = NULL; g_slist_free_1(list), node != NULL; list = node, node = node->next)
 
+/* milliseconds to collect file monitor events before refreshing the directories */
+#define TREEBROWSER_MONITOR_DELAY 250
+
 static GList*
 _gtk_cell_layout_get_cells(GtkTreeViewColumn *column)
 {
@@ -152,6 +166,8 @@ static void 	project_change_cb(G_GNUC_UNUSED GObject *obj, G_GNUC_UNUSED GKeyFil
 static void 	treebrowser_browse(gchar *directory, gpointer parent);
 static void 	treebrowser_bookmarks_set_state(void);
 static void 	treebrowser_load_bookmarks(void);
+static void 	treebrowser_monitor_add(const gchar *directory);
+static void 	treebrowser_monitor_remove_all(void);
 static void 	gtk_tree_store_iter_clear_nodes(gpointer iter, gboolean delete_root);
 static void 	treebrowser_rename_current(void);
 static void 	on_menu_create_new_object(GtkMenuItem *menuitem, const gchar *type);
@@ -171,6 +187,90 @@ PluginCallback plugin_callbacks[] =
 };
 
 
+/* ------------------
+ * URI INDEX
+ * ------------------ */
+
+static void
+treebrowser_index_free_rows(GQueue *rows)
+{
+	g_queue_foreach(rows, (GFunc) gtk_tree_iter_free, NULL);
+	g_queue_free(rows);
+}
+
+static void
+treebrowser_index_add(GtkTreeIter *iter, const gchar *uri)
+{
+	GQueue *rows;
+
+	rows = g_hash_table_lookup(uri_rows, uri);
+	if (rows == NULL)
+	{
+		rows = g_queue_new();
+		g_hash_table_insert(uri_rows, g_strdup(uri), rows);
+	}
+	g_queue_push_tail(rows, gtk_tree_iter_copy(iter));
+}
+
+static void
+treebrowser_index_remove_row(GtkTreeIter *iter)
+{
+	GQueue 	*rows;
+	GList 	*node;
+	gchar 	*uri;
+
+	gtk_tree_model_get(GTK_TREE_MODEL(treestore), iter, TREEBROWSER_COLUMN_URI, &uri, -1);
+	if (uri == NULL)
+		return;
+
+	rows = g_hash_table_lookup(uri_rows, uri);
+	if (rows != NULL)
+	{
+		for (node = rows->head; node != NULL; node = node->next)
+		{
+			if (((GtkTreeIter *) node->data)->user_data == iter->user_data)
+			{
+				gtk_tree_iter_free(node->data);
+				g_queue_delete_link(rows, node);
+				break;
+			}
+		}
+		if (g_queue_is_empty(rows))
+			g_hash_table_remove(uri_rows, uri);
+	}
+	g_free(uri);
+}
+
+static void
+treebrowser_index_remove_children(GtkTreeIter *parent)
+{
+	GtkTreeIter iter;
+
+	if (gtk_tree_model_iter_children(GTK_TREE_MODEL(treestore), &iter, parent))
+	{
+		do
+		{
+			treebrowser_index_remove_children(&iter);
+			treebrowser_index_remove_row(&iter);
+		} while (gtk_tree_model_iter_next(GTK_TREE_MODEL(treestore), &iter));
+	}
+}
+
+/* Returns the first row showing uri which is still in the tree, if any */
+static gboolean
+treebrowser_index_lookup(const gchar *uri, GtkTreeIter *iter)
+{
+	GQueue *rows;
+
+	rows = g_hash_table_lookup(uri_rows, uri);
+	if (rows == NULL)
+		return FALSE;
+
+	*iter = *(GtkTreeIter *) g_queue_peek_head(rows);
+	return TRUE;
+}
+
+
 /* ------------------
  * TREEBROWSER CORE FUNCTIONS
  * ------------------ */
@@ -463,10 +563,13 @@ treebrowser_chroot(const gchar *dir)
 	treebrowser_bookmarks_set_state();
 
 	gtk_tree_store_clear(treestore);
+	g_hash_table_remove_all(uri_rows);
+	treebrowser_monitor_remove_all();
 	setptr(addressbar_last_address, directory);
 
 	treebrowser_browse(addressbar_last_address, NULL);
 	treebrowser_load_bookmarks();
+	treebrowser_monitor_add(addressbar_last_address);
 }
 
 static void
@@ -474,7 +577,7 @@ treebrowser_browse(gchar *directory, gpointer parent)
 {
 	GtkTreeIter 	iter, iter_empty, *last_dir_iter = NULL;
 	gboolean 		is_dir;
-	gboolean 		expanded = FALSE, has_parent;
+	gboolean 		expanded = FALSE, has_parent, empty = TRUE;
 	gchar 			*utf8_name;
 	GSList 			*list, *node;
 
@@ -525,12 +628,14 @@ treebrowser_browse(gchar *directory, gpointer parent)
 						gtk_tree_iter_free(last_dir_iter);
 					}
 					last_dir_iter = gtk_tree_iter_copy(&iter);
+					empty = FALSE;
 					icon = CONFIG_SHOW_ICONS ? utils_pixbuf_from_stock(GTK_STOCK_DIRECTORY) : NULL;
 					gtk_tree_store_set(treestore, &iter,
 										TREEBROWSER_COLUMN_ICON, 	icon,
 										TREEBROWSER_COLUMN_NAME, 	fname,
 										TREEBROWSER_COLUMN_URI, 	uri,
 										-1);
+					treebrowser_index_add(&iter, uri);
 					gtk_tree_store_prepend(treestore, &iter_empty, &iter);
 					gtk_tree_store_set(treestore, &iter_empty,
 									TREEBROWSER_COLUMN_ICON, 	NULL,
@@ -548,11 +653,13 @@ treebrowser_browse(gchar *directory, gpointer parent)
 										? utils_pixbuf_from_stock(GTK_STOCK_FILE)
 										: NULL;
 						gtk_tree_store_append(treestore, &iter, parent);
+						empty = FALSE;
 						gtk_tree_store_set(treestore, &iter,
 										TREEBROWSER_COLUMN_ICON, 	icon,
 										TREEBROWSER_COLUMN_NAME, 	fname,
 										TREEBROWSER_COLUMN_URI, 	uri,
 										-1);
+						treebrowser_index_add(&iter, uri);
 					}
 				}
 
@@ -564,7 +671,7 @@ treebrowser_browse(gchar *directory, gpointer parent)
 			g_free(fname);
 		}
 	}
-	else
+	if (empty)
 	{
 		gtk_tree_store_prepend(treestore, &iter_empty, parent);
 		gtk_tree_store_set(treestore, &iter_empty,
@@ -586,6 +693,397 @@ treebrowser_browse(gchar *directory, gpointer parent)
 
 }
 
+static void
+treebrowser_set_empty(GtkTreeIter *iter)
+{
+	gtk_tree_store_set(treestore, iter,
+					TREEBROWSER_COLUMN_ICON, 	NULL,
+					TREEBROWSER_COLUMN_NAME, 	_("(Empty)"),
+					TREEBROWSER_COLUMN_URI, 	NULL,
+					-1);
+}
+
+static void
+treebrowser_set_row(GtkTreeIter *iter, gchar *uri, gboolean is_dir)
+{
+	GtkTreeIter 	iter_empty;
+	GdkPixbuf 		*icon;
+	gchar 			*fname;
+
+	if (is_dir)
+		icon = CONFIG_SHOW_ICONS ? utils_pixbuf_from_stock(GTK_STOCK_DIRECTORY) : NULL;
+	else
+		icon = CONFIG_SHOW_ICONS == 2
+					? utils_pixbuf_from_path(uri)
+					: CONFIG_SHOW_ICONS
+						? utils_pixbuf_from_stock(GTK_STOCK_FILE)
+						: NULL;
+
+	fname = g_path_get_basename(uri);
+	gtk_tree_store_set(treestore, iter,
+					TREEBROWSER_COLUMN_ICON, 	icon,
+					TREEBROWSER_COLUMN_NAME, 	fname,
+					TREEBROWSER_COLUMN_URI, 	uri,
+					-1);
+	treebrowser_index_add(iter, uri);
+	g_free(fname);
+
+	if (is_dir)
+	{
+		gtk_tree_store_prepend(treestore, &iter_empty, iter);
+		treebrowser_set_empty(&iter_empty);
+	}
+
+	if (icon)
+		g_object_unref(icon);
+}
+
+/* Whether the row at iter is one treebrowser_refresh() still has to place or remove */
+static gboolean
+treebrowser_refresh_is_pending(GHashTable *rows, GtkTreeIter *iter)
+{
+	gchar 		*uri;
+	gint 		flag;
+	gboolean 	pending;
+
+	gtk_tree_model_get(GTK_TREE_MODEL(treestore), iter,
+						TREEBROWSER_COLUMN_URI, 	&uri,
+						TREEBROWSER_COLUMN_FLAG, 	&flag,
+						-1);
+	if (uri != NULL)
+		pending = g_hash_table_lookup(rows, uri) != NULL;
+	else
+		pending = flag != TREEBROWSER_FLAGS_SEPARATOR;
+	g_free(uri);
+
+	return pending;
+}
+
+/* Moves iter after prev, the first row of parent if NULL, unless only pending rows are in between */
+static void
+treebrowser_refresh_move(GHashTable *rows, GtkTreeIter *parent, GtkTreeIter *prev, GtkTreeIter *iter)
+{
+	GtkTreeIter 	next;
+	gboolean 		valid;
+
+	if (prev != NULL)
+	{
+		next = *prev;
+		valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(treestore), &next);
+	}
+	else
+		valid = gtk_tree_model_iter_children(GTK_TREE_MODEL(treestore), &next, parent);
+
+	while (valid && next.user_data != iter->user_data && treebrowser_refresh_is_pending(rows, &next))
+		valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(treestore), &next);
+
+	if (! valid || next.user_data != iter->user_data)
+		gtk_tree_store_move_after(treestore, iter, prev);
+}
+
+static void
+treebrowser_refresh_remove(gpointer key, gpointer value, gpointer user_data)
+{
+	gtk_tree_store_iter_clear_nodes(value, TRUE);
+}
+
+/* Brings the rows below parent, the root if NULL, in line with the contents of directory.
+ * Unlike treebrowser_browse() it only inserts, moves and removes the rows which changed, so
+ * the expanded rows and the selection are kept. */
+static void
+treebrowser_refresh(const gchar *directory, GtkTreeIter *parent, gboolean recursive)
+{
+	GtkTreeModel 	*model = GTK_TREE_MODEL(treestore);
+	GtkTreeIter 	iter, iter_prev, iter_empty;
+	gboolean 		has_prev = FALSE, has_empty = FALSE, shown = FALSE, is_dir;
+	GHashTable 		*rows;
+	GSList 			*list, *node, *dirs = NULL, *files = NULL;
+	gchar 			*path, *uri, *utf8_name;
+	gint 			i;
+
+	path = g_strconcat(directory, G_DIR_SEPARATOR_S, NULL);
+
+	/* the rows shown now by URI, the new rows go after the bookmarks */
+	rows = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) gtk_tree_iter_free);
+	if (gtk_tree_model_iter_children(model, &iter, parent))
+	{
+		do
+		{
+			gint flag;
+
+			gtk_tree_model_get(model, &iter,
+								TREEBROWSER_COLUMN_URI, 	&uri,
+								TREEBROWSER_COLUMN_FLAG, 	&flag,
+								-1);
+			if (uri != NULL)
+				g_hash_table_insert(rows, uri, gtk_tree_iter_copy(&iter));
+			else if (flag == TREEBROWSER_FLAGS_SEPARATOR)
+			{
+				iter_prev = iter;
+				has_prev = TRUE;
+			}
+			else if (parent != NULL || ! CONFIG_SHOW_BOOKMARKS || iter.user_data != bookmarks_iter.user_data)
+			{
+				iter_empty = iter;
+				has_empty = TRUE;
+			}
+		} while (gtk_tree_model_iter_next(model, &iter));
+	}
+
+	list = utils_get_file_list(path, NULL, NULL);
+	foreach_slist_free(node, list)
+	{
+		gchar *fname = node->data;
+
+		uri 		= g_strconcat(path, fname, NULL);
+		is_dir 		= g_file_test(uri, G_FILE_TEST_IS_DIR);
+		utf8_name 	= utils_get_utf8_from_locale(fname);
+
+		if (check_hidden(uri) || (! is_dir && ! check_filtered(utf8_name)))
+			g_free(uri);
+		else if (is_dir)
+			dirs = g_slist_prepend(dirs, uri);
+		else
+			files = g_slist_prepend(files, uri);
+
+		g_free(utf8_name);
+		g_free(fname);
+	}
+
+	/* directories first, both in the order of the listing */
+	for (i = 0; i < 2; i++)
+	{
+		GSList *wanted;
+
+		is_dir = (i == 0);
+		wanted = g_slist_reverse(is_dir ? dirs : files);
+		foreach_slist_free(node, wanted)
+		{
+			GtkTreeIter *row;
+
+			uri = node->data;
+			row = g_hash_table_lookup(rows, uri);
+			if (row != NULL && (gtk_tree_model_iter_has_child(model, row) ? TRUE : FALSE) == is_dir)
+			{
+				iter = *row;
+				g_hash_table_remove(rows, uri);
+				treebrowser_refresh_move(rows, parent, has_prev ? &iter_prev : NULL, &iter);
+				if (recursive && is_dir && tree_view_row_expanded_iter(GTK_TREE_VIEW(treeview), &iter))
+					treebrowser_refresh(uri, &iter, TRUE);
+			}
+			else
+			{
+				gtk_tree_store_insert_after(treestore, &iter, parent, has_prev ? &iter_prev : NULL);
+				treebrowser_set_row(&iter, uri, is_dir);
+			}
+			iter_prev = iter;
+			has_prev = shown = TRUE;
+			g_free(uri);
+		}
+	}
+
+	/* keep a row below parent until the end so that it is not collapsed */
+	if (! shown && ! has_empty)
+	{
+		gtk_tree_store_insert_after(treestore, &iter_empty, parent, has_prev ? &iter_prev : NULL);
+		treebrowser_set_empty(&iter_empty);
+	}
+	else if (shown && has_empty)
+		gtk_tree_store_remove(treestore, &iter_empty);
+	g_hash_table_foreach(rows, treebrowser_refresh_remove, NULL);
+
+	g_hash_table_destroy(rows);
+	g_free(path);
+}
+
+
+/* ------------------
+ * FILE MONITORING
+ * ------------------ */
+
+#ifdef HAVE_GIO
+/* Whether directory is the root or one of its rows is expanded */
+static gboolean
+treebrowser_dir_is_shown(const gchar *directory)
+{
+	GQueue 	*rows;
+	GList 	*node;
+
+	if (utils_str_equal(directory, addressbar_last_address))
+		return TRUE;
+
+	rows = g_hash_table_lookup(uri_rows, directory);
+	if (rows != NULL)
+	{
+		for (node = rows->head; node != NULL; node = node->next)
+		{
+			if (tree_view_row_expanded_iter(GTK_TREE_VIEW(treeview), node->data))
+				return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static void
+treebrowser_monitor_refresh(gpointer key, gpointer value, gpointer user_data)
+{
+	const gchar *directory = key;
+	GQueue 		*rows;
+	GList 		*node;
+
+	if (! treebrowser_dir_is_shown(directory))
+	{
+		g_hash_table_remove(dir_monitors, directory);
+		return;
+	}
+
+	if (utils_str_equal(directory, addressbar_last_address))
+		treebrowser_refresh(directory, NULL, FALSE);
+
+	rows = g_hash_table_lookup(uri_rows, directory);
+	if (rows != NULL)
+	{
+		for (node = rows->head; node != NULL; node = node->next)
+		{
+			if (tree_view_row_expanded_iter(GTK_TREE_VIEW(treeview), node->data))
+				treebrowser_refresh(directory, node->data, FALSE);
+		}
+	}
+}
+
+static gboolean
+on_monitor_timeout(gpointer user_data)
+{
+	g_hash_table_foreach(dirs_changed, treebrowser_monitor_refresh, NULL);
+	g_hash_table_remove_all(dirs_changed);
+	dirs_changed_source = 0;
+
+	return FALSE;
+}
+
+/* Renames the file rows of file to other_file, if it stays in directory */
+static void
+treebrowser_monitor_rename(const gchar *directory, GFile *file, GFile *other_file)
+{
+	GtkTreeIter 	iter;
+	GFile 			*dir, *other_dir;
+	gchar 			*name, *other_name, *uri, *uri_new;
+
+	dir = g_file_get_parent(file);
+	other_dir = g_file_get_parent(other_file);
+	if (dir != NULL && other_dir != NULL && g_file_equal(dir, other_dir))
+	{
+		name 		= g_file_get_basename(file);
+		other_name 	= g_file_get_basename(other_file);
+		uri 		= g_strconcat(directory, G_DIR_SEPARATOR_S, name, NULL);
+		uri_new 	= g_strconcat(directory, G_DIR_SEPARATOR_S, other_name, NULL);
+
+		/* directory rows are left to the refresh, their children would need new URIs */
+		while (treebrowser_index_lookup(uri, &iter) &&
+			! gtk_tree_model_iter_has_child(GTK_TREE_MODEL(treestore), &iter))
+		{
+			treebrowser_index_remove_row(&iter);
+			treebrowser_set_row(&iter, uri_new, FALSE);
+		}
+
+		g_free(name);
+		g_free(other_name);
+		g_free(uri);
+		g_free(uri_new);
+	}
+	if (dir != NULL)
+		g_object_unref(dir);
+	if (other_dir != NULL)
+		g_object_unref(other_dir);
+}
+
+static void
+on_monitor_changed(GFileMonitor *monitor, GFile *file, GFile *other_file, GFileMonitorEvent event_type,
+				   gpointer user_data)
+{
+	const gchar *directory = user_data;
+
+	switch (event_type)
+	{
+		case G_FILE_MONITOR_EVENT_MOVED:
+			if (other_file != NULL)
+				treebrowser_monitor_rename(directory, file, other_file);
+			break;
+		case G_FILE_MONITOR_EVENT_CREATED:
+		case G_FILE_MONITOR_EVENT_DELETED:
+			break;
+		default:
+			return;
+	}
+
+	/* the events of a batch are handled with one refresh of each directory */
+	if (g_hash_table_lookup(dirs_changed, directory) == NULL)
+		g_hash_table_insert(dirs_changed, g_strdup(directory), GINT_TO_POINTER(TRUE));
+	if (dirs_changed_source == 0)
+		dirs_changed_source = g_timeout_add(TREEBROWSER_MONITOR_DELAY, on_monitor_timeout, NULL);
+}
+
+static void
+treebrowser_monitor_free(GFileMonitor *monitor)
+{
+	/* a queued event must not arrive after the monitor left dir_monitors */
+	g_signal_handlers_disconnect_matched(monitor, G_SIGNAL_MATCH_FUNC, 0, 0, NULL,
+		on_monitor_changed, NULL);
+	g_file_monitor_cancel(monitor);
+	g_object_unref(monitor);
+}
+#endif
+
+static void
+treebrowser_monitor_add(const gchar *directory)
+{
+#ifdef HAVE_GIO
+	GFileMonitorFlags 	flags = G_FILE_MONITOR_NONE;
+	GFileMonitor 		*monitor;
+	GFile 				*file;
+
+	if (g_hash_table_lookup(dir_monitors, directory) != NULL)
+		return;
+
+#if GLIB_CHECK_VERSION(2, 24, 0)
+	flags |= G_FILE_MONITOR_SEND_MOVED;
+#endif
+	file = g_file_new_for_path(directory);
+	monitor = g_file_monitor_directory(file, flags, NULL, NULL);
+	g_object_unref(file);
+	if (monitor == NULL)
+		return;
+
+	/* the handler gets its own copy, the key is freed before the monitor */
+	g_signal_connect_data(monitor, "changed", G_CALLBACK(on_monitor_changed), g_strdup(directory),
+		(GClosureNotify)g_free, 0);
+	g_hash_table_insert(dir_monitors, g_strdup(directory), monitor);
+#endif
+}
+
+static void
+treebrowser_monitor_remove(const gchar *directory)
+{
+#ifdef HAVE_GIO
+	if (! treebrowser_dir_is_shown(directory))
+		g_hash_table_remove(dir_monitors, directory);
+#endif
+}
+
+static void
+treebrowser_monitor_remove_all(void)
+{
+#ifdef HAVE_GIO
+	if (dirs_changed_source != 0)
+	{
+		g_source_remove(dirs_changed_source);
+		dirs_changed_source = 0;
+	}
+	g_hash_table_remove_all(dirs_changed);
+	g_hash_table_remove_all(dir_monitors);
+#endif
+}
+
 static void
 treebrowser_bookmarks_set_state(void)
 {
@@ -661,6 +1159,7 @@ treebrowser_load_bookmarks(void)
 												TREEBROWSER_COLUMN_NAME, 	file_name,
 												TREEBROWSER_COLUMN_URI, 	path_full,
 												-1);
+					treebrowser_index_add(&iter, path_full);
 					g_free(file_name);
 					if (icon)
 						g_object_unref(icon);
@@ -689,39 +1188,21 @@ treebrowser_load_bookmarks(void)
 }
 
 static gboolean
-treebrowser_search(gchar *uri, gpointer parent)
+treebrowser_search(gchar *uri)
 {
 	GtkTreeIter 	iter;
 	GtkTreePath 	*path;
-	gchar 			*uri_current;
-
-	if (gtk_tree_model_iter_children(GTK_TREE_MODEL(treestore), &iter, parent))
-	{
-		do
-		{
-			if (gtk_tree_model_iter_has_child(GTK_TREE_MODEL(treestore), &iter))
-				if (treebrowser_search(uri, &iter))
-					return TRUE;
 
-			gtk_tree_model_get(GTK_TREE_MODEL(treestore), &iter, TREEBROWSER_COLUMN_URI, &uri_current, -1);
-
-			if (utils_str_equal(uri, uri_current) == TRUE)
-			{
-				path = gtk_tree_model_get_path(GTK_TREE_MODEL(treestore), &iter);
-				gtk_tree_view_expand_to_path(GTK_TREE_VIEW(treeview), path);
-				gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(treeview), path, TREEBROWSER_COLUMN_ICON, FALSE, 0, 0);
-				gtk_tree_view_set_cursor(GTK_TREE_VIEW(treeview), path, treeview_column_text, FALSE);
-				gtk_tree_path_free(path);
-				g_free(uri_current);
-				return TRUE;
-			}
-			else
-				g_free(uri_current);
+	if (! treebrowser_index_lookup(uri, &iter))
+		return FALSE;
 
-		} while (gtk_tree_model_iter_next(GTK_TREE_MODEL(treestore), &iter));
-	}
+	path = gtk_tree_model_get_path(GTK_TREE_MODEL(treestore), &iter);
+	gtk_tree_view_expand_to_path(GTK_TREE_VIEW(treeview), path);
+	gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(treeview), path, TREEBROWSER_COLUMN_ICON, FALSE, 0, 0);
+	gtk_tree_view_set_cursor(GTK_TREE_VIEW(treeview), path, treeview_column_text, FALSE);
+	gtk_tree_path_free(path);
 
-	return FALSE;
+	return TRUE;
 }
 
 static void
@@ -791,6 +1272,10 @@ gtk_tree_store_iter_clear_nodes(gpointer iter, gboolean delete_root)
 {
 	GtkTreeIter i;
 
+	treebrowser_index_remove_children(iter);
+	if (delete_root)
+		treebrowser_index_remove_row(iter);
+
 	if (gtk_tree_model_iter_children(GTK_TREE_MODEL(treestore), &i, iter))
 	{
 		while (gtk_tree_store_remove(GTK_TREE_STORE(treestore), &i))
@@ -821,7 +1306,7 @@ treebrowser_expand_to_path(gchar* root, gchar* find)
 
 		if (founded)
 		{
-			if (treebrowser_search(new, NULL))
+			if (treebrowser_search(new))
 				global_founded = TRUE;
 		}
 		else
@@ -852,7 +1337,7 @@ treebrowser_track_current(void)
 		/*
 		 * Checking if the document is in the expanded or collapsed files
 		 */
-		if (! treebrowser_search(path_current, NULL))
+		if (! treebrowser_search(path_current))
 		{
 			/*
 			 * Else we have to chroting to the document`s nearles path
@@ -1062,8 +1547,8 @@ on_menu_create_new_object(GtkMenuItem *menuitem, const gchar *type)
 
 			if (creation_success)
 			{
-				treebrowser_browse(uri, refresh_root ? NULL : &iter);
-				if (treebrowser_search(uri_new, NULL))
+				treebrowser_refresh(uri, refresh_root ? NULL : &iter, FALSE);
+				if (treebrowser_search(uri_new))
 					treebrowser_rename_current();
 				if (utils_str_equal(type, "file") && CONFIG_OPEN_NEW_FILES == TRUE)
 					document_open_file(uri_new,FALSE, NULL,NULL);
@@ -1102,9 +1587,9 @@ on_menu_delete(GtkMenuItem *menuitem, gpointer *user_data)
 		uri_parent = g_path_get_dirname(uri);
 		fs_remove(uri, TRUE);
 		if (gtk_tree_model_iter_parent(GTK_TREE_MODEL(treestore), &iter_parent, &iter))
-			treebrowser_browse(uri_parent, &iter_parent);
+			treebrowser_refresh(uri_parent, &iter_parent, FALSE);
 		else
-			treebrowser_browse(uri_parent, NULL);
+			treebrowser_refresh(uri_parent, NULL, FALSE);
 		g_free(uri_parent);
 	}
 	g_free(uri);
@@ -1122,11 +1607,14 @@ on_menu_refresh(GtkMenuItem *menuitem, gpointer *user_data)
 	{
 		gtk_tree_model_get(model, &iter, TREEBROWSER_COLUMN_URI, &uri, -1);
 		if (g_file_test(uri, G_FILE_TEST_IS_DIR))
-			treebrowser_browse(uri, &iter);
+			treebrowser_refresh(uri, &iter, TRUE);
 		g_free(uri);
 	}
 	else
-		treebrowser_browse(addressbar_last_address, NULL);
+	{
+		treebrowser_refresh(addressbar_last_address, NULL, TRUE);
+		treebrowser_load_bookmarks();
+	}
 }
 
 static void
@@ -1188,7 +1676,7 @@ on_menu_show_hidden_files(GtkMenuItem *menuitem, gpointer *user_data)
 {
 	CONFIG_SHOW_HIDDEN_FILES = gtk_check_menu_item_get_active(GTK_CHECK_MENU_ITEM(menuitem));
 	save_settings();
-	treebrowser_browse(addressbar_last_address, NULL);
+	treebrowser_refresh(addressbar_last_address, NULL, TRUE);
 }
 
 static void
@@ -1329,7 +1817,8 @@ on_button_go_up(void)
 static void
 on_button_refresh(void)
 {
-	treebrowser_chroot(addressbar_last_address);
+	treebrowser_refresh(addressbar_last_address, NULL, TRUE);
+	treebrowser_load_bookmarks();
 }
 
 static void
@@ -1539,7 +2028,7 @@ on_treeview_row_activated(GtkWidget *widget, GtkTreePath *path, GtkTreeViewColum
 			if (gtk_tree_view_row_expanded(GTK_TREE_VIEW(widget), path))
 				gtk_tree_view_collapse_row(GTK_TREE_VIEW(widget), path);
 			else {
-				treebrowser_browse(uri, &iter);
+				treebrowser_refresh(uri, &iter, FALSE);
 				gtk_tree_view_expand_row(GTK_TREE_VIEW(widget), path, FALSE);
 			}
 	else {
@@ -1563,10 +2052,11 @@ on_treeview_row_expanded(GtkWidget *widget, GtkTreeIter *iter, GtkTreePath *path
 	if (flag_on_expand_refresh == FALSE)
 	{
 		flag_on_expand_refresh = TRUE;
-		treebrowser_browse(uri, iter);
+		treebrowser_refresh(uri, iter, FALSE);
 		gtk_tree_view_expand_row(GTK_TREE_VIEW(treeview), path, FALSE);
 		flag_on_expand_refresh = FALSE;
 	}
+	treebrowser_monitor_add(uri);
 	if (CONFIG_SHOW_ICONS)
 	{
 		GdkPixbuf *icon = utils_pixbuf_from_stock(GTK_STOCK_OPEN);
@@ -1585,6 +2075,7 @@ on_treeview_row_collapsed(GtkWidget *widget, GtkTreeIter *iter, GtkTreePath *pat
 	gtk_tree_model_get(GTK_TREE_MODEL(treestore), iter, TREEBROWSER_COLUMN_URI, &uri, -1);
 	if (uri == NULL)
 		return;
+	treebrowser_monitor_remove(uri);
 	if (CONFIG_SHOW_ICONS)
 	{
 		GdkPixbuf *icon = utils_pixbuf_from_stock(GTK_STOCK_DIRECTORY);
@@ -1625,14 +2116,16 @@ on_treeview_renamed(GtkCellRenderer *renderer, const gchar *path_string, const g
 				if (g_rename(uri, uri_new) == 0)
 				{
 					dirname = g_path_get_dirname(uri_new);
+					treebrowser_index_remove_row(&iter);
 					gtk_tree_store_set(treestore, &iter,
 									TREEBROWSER_COLUMN_NAME, name_new,
 									TREEBROWSER_COLUMN_URI, uri_new,
 									-1);
+					treebrowser_index_add(&iter, uri_new);
 					if (gtk_tree_model_iter_parent(GTK_TREE_MODEL(treestore), &iter_parent, &iter))
-						treebrowser_browse(dirname, &iter_parent);
+						treebrowser_refresh(dirname, &iter_parent, FALSE);
 					else
-						treebrowser_browse(dirname, NULL);
+						treebrowser_refresh(dirname, NULL, FALSE);
 					g_free(dirname);
 
 					if (!g_file_test(uri, G_FILE_TEST_IS_DIR))
@@ -1707,6 +2200,11 @@ create_view_and_model(void)
 #endif
 
 	treestore = gtk_tree_store_new(TREEBROWSER_COLUMNC, GDK_TYPE_PIXBUF, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT);
+	uri_rows = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) treebrowser_index_free_rows);
+#ifdef HAVE_GIO
+	dir_monitors = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) treebrowser_monitor_free);
+	dirs_changed = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+#endif
 
 	gtk_tree_view_set_model(GTK_TREE_VIEW(view), GTK_TREE_MODEL(treestore));
 	g_signal_connect(G_OBJECT(render_text), "edited", G_CALLBACK(on_treeview_renamed), view);
@@ -2135,4 +2633,10 @@ plugin_cleanup(void)
 	g_free(CONFIG_FILE);
 	g_free(CONFIG_OPEN_EXTERNAL_CMD);
 	gtk_widget_destroy(sidebar_vbox);
+	treebrowser_monitor_remove_all();
+#ifdef HAVE_GIO
+	g_hash_table_destroy(dir_monitors);
+	g_hash_table_destroy(dirs_changed);
+#endif
+	g_hash_table_destroy(uri_rows);
 }